@@ -1,47 +1,122 @@
+#define _GNU_SOURCE     // MAP_ANONYMOUS, MAP_NORESERVE, MADV_HUGEPAGE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include "bg64.h"
+#include "bg64_board.h"
+#include "bg64_history.h"
+#include "bg64_input.h"
+#include "bg64_preview.h"
+#include "bg64_particles.h"
+#include "bg64_pieces.h"
+#include "bg64_telemetry.h"
 #include <time.h>
 #include <assert.h>
 #include <math.h>
 
 // GAME STATE: Memory Layout
-Arena GameArena_Allocation(usize size)
+Arena Arena_Reserve(usize size, u32 flags)
 {
-    // malloc 1MB aligned to 64 bytes
-    u8 *raw_memory = (u8 *)aligned_alloc(64, size);
+    // Huge pages want 2MB aligned chunks, regular pages commit in 64KB steps
+    usize granule = (flags & ARENA_HUGE_PAGES) ? ARENA_HUGE_GRANULE : ARENA_COMMIT_GRANULE;
+    size = (size + granule - 1) & ~(granule - 1);
+
+    // Reserve address space only: no physical pages, no swap accounting, no memset
+    u8 *raw_memory = mmap(NULL, size + granule, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
 
-    if (raw_memory == NULL)
+    if (raw_memory == MAP_FAILED)
     {
         printf("ALLOCATION FAILED\n");
         exit(1);
     }
 
-    // Zero the entire arena
-    if (raw_memory)memset(raw_memory, 0, size);
+    // Trim the reservation so the base sits on a granule boundary
+    u8 *base = (u8 *)(((uintptr_t)raw_memory + granule - 1) & ~(uintptr_t)(granule - 1));
+    if (base > raw_memory) munmap(raw_memory, (usize)(base - raw_memory));
+    usize tail = (usize)((raw_memory + size + granule) - (base + size));
+    if (tail) munmap(base + size, tail);
+
+    // Transparent huge pages, the kernel falls back to 4KB pages when none are free
+    if (flags & ARENA_HUGE_PAGES) madvise(base, size, MADV_HUGEPAGE);
 
     // Initialize the game arena with the mem block
-    Arena game_arena = {
-        .base = raw_memory,
+    Arena arena = {
+        .base = base,
         .size = size,
-        .offset = 0};
+        .offset = 0,
+        .committed = 0,
+        .granule = granule,
+        .flags = flags};
 
-    return game_arena;
+    return arena;
 }
 
-GameState *GameState_Allocation(Arena *arena)
+Arena GameArena_Allocation(usize size)
+{
+    return Arena_Reserve(size, 0);
+}
+
+void Arena_Release(Arena *arena)
+{
+    if (arena->base) munmap(arena->base, arena->size);
+    *arena = (Arena){0};
+}
+
+void *Arena_Push(Arena *arena, usize size, usize align)
 {
-    // Ensure struct alignment (safety buffer, not for bit mask modulus but rather memory alignment)
-    arena->offset = (arena->offset + 63) & ~63;
+    // align must be a power of two
+    usize start = (arena->offset + (align - 1)) & ~(align - 1);
+    usize end = start + size;
 
-    // slice game state from the memory address in the arena
-    GameState *state = (GameState *)(arena->base + arena->offset);
+    if (end > arena->size)
+    {
+        printf("ARENA EXHAUSTED: %zu of %zu bytes reserved\n", end, arena->size);
+        exit(1);
+    }
 
-    // Increment the offset, sealing that data in the bump
-    arena->offset += sizeof(GameState);
+    // Commit on demand, fresh pages come from the kernel already zeroed
+    if (end > arena->committed)
+    {
+        usize commit_to = (end + arena->granule - 1) & ~(arena->granule - 1);
+        if (commit_to > arena->size) commit_to = arena->size;
+
+        if (mprotect(arena->base + arena->committed, commit_to - arena->committed, PROT_READ | PROT_WRITE) != 0)
+        {
+            printf("ARENA COMMIT FAILED at %zu bytes\n", commit_to);
+            exit(1);
+        }
 
-    return state;
+        arena->committed = commit_to;
+    }
+
+    arena->offset = end;
+    return arena->base + start;
+}
+
+void *Arena_PushZero(Arena *arena, usize size, usize align)
+{
+    // Memory behind a restored mark is reused dirty, zero only what was asked for
+    void *memory = Arena_Push(arena, size, align);
+    memset(memory, 0, size);
+    return memory;
+}
+
+ArenaMark Arena_Save(Arena *arena)
+{
+    return (ArenaMark){ .arena = arena, .offset = arena->offset };
+}
+
+void Arena_Restore(ArenaMark mark)
+{
+    // O(1) free of everything pushed since the mark, pages stay committed for reuse
+    mark.arena->offset = mark.offset;
+}
+
+GameState *GameState_Allocation(Arena *arena)
+{
+    // slice game state from the arena on its own 4 cache lines
+    return (GameState *)Arena_Push(arena, sizeof(GameState), 64);
 }
 
 void GameState_Initialization(GameState *state)
@@ -49,49 +124,101 @@ void GameState_Initialization(GameState *state)
 
     usize items = load_state("save.bin", state);
 
+    if (items == 1 && state->utility.magic != GAMESTATE_MAGIC)
+    {
+        printf("Save file magic mismatch, discarding it.\n");
+        items = 0;
+    }
+
     if (items == 1)
     {
+        // Older saves packed the composite byte as 4 shape bits / 4 color bits
+        if (state->utility.version < GAMESTATE_VERSION) GameState_Migration(state);
+
         // Fill the queue; since queue may or may not need to be filled here
         fill_queue(state);
 
         printf("Loaded persistent game state.\n");
+        Telemetry_Session(state, true);
     }
 
     if (items == 0)
     {
         printf("Initializing game state for new user.\n");
 
-        // Wipe Memory
-        memset(state, 0, sizeof(GameState));
+        GameState_Reset(state, (u64)time(NULL));
 
-        // Set Metadata
-        state->utility.magic = 0x474C4B21; // "GLK!"
-        state->utility.version = 1;
-        state->utility.rng_seed = (u64)time(NULL);
-        if (state->utility.rng_seed == 0)
-            state->utility.rng_seed = 0xFEED;
+        printf("Loaded new game state.");
+        Telemetry_Session(state, false);
+        Telemetry_GameStart(state);
+    }
+}
 
-        // Setup Palette
-        state->utility.palette[0] = BLANK; // Empty
-        state->utility.palette[1] = RED;   //(Color){ 255, 80, 80, 255 }; // Red
-        state->utility.palette[2] = GREEN; //(Color){ 80, 255, 80, 255 }; // Green
-        state->utility.palette[3] = BLUE;  //(Color){ 80, 80, 255, 255 }; // Blue
+void GameState_Reset(GameState *state, u64 seed)
+{
+    GameState_ResetMode(state, seed, PIECE_MODE_CLASSIC);
+}
 
-        // Defaults for session
-        state->session.dragging_slot_index = 255;
-        state->utility.current_screen = 0; // default main screen
+void GameState_ResetMode(GameState *state, u64 seed, u8 piece_mode)
+{
+    GameState_ResetPieces(state, seed, piece_mode, NULL);
+}
 
-        // Fill the queue
-        fill_queue(state);
+void GameState_ResetPieces(GameState *state, u64 seed, u8 piece_mode, const u8 *piece_weights)
+{
+    // Wipe Memory, the weights may point into the state itself
+    u8 weights[sizeof(state->grid.piece_weights)] = { 0 };
+    if (piece_weights) memcpy(weights, piece_weights, sizeof(weights));
+    memset(state, 0, sizeof(GameState));
+    memcpy(state->grid.piece_weights, weights, sizeof(weights));
+
+    // Set Metadata
+    state->utility.magic = GAMESTATE_MAGIC;
+    state->utility.version = GAMESTATE_VERSION;
+    state->utility.rng_seed = seed;
+    if (state->utility.rng_seed == 0)
+        state->utility.rng_seed = 0xFEED;
+
+    // Setup Palette
+    state->utility.palette[0] = BLANK; // Empty
+    state->utility.palette[1] = RED;   //(Color){ 255, 80, 80, 255 }; // Red
+    state->utility.palette[2] = GREEN; //(Color){ 80, 255, 80, 255 }; // Green
+    state->utility.palette[3] = BLUE;  //(Color){ 80, 80, 255, 255 }; // Blue
+
+    // Defaults for session, the mode picks the distribution the queue is filled from
+    state->session.dragging_slot_index = 255;
+    state->session.piece_mode = piece_mode;
+    state->utility.current_screen = 0; // default main screen
+
+    // Fill the queue
+    fill_queue(state);
+
+    // Set the deck
+    u8 count = ring_buffer_consume_batch(state, state->session.deck_shape_color_bits, 3);
+    for (u8 i = 0; i < count; i++)
+    {
+        state->session.is_active[i] = false;
+    }
+}
 
-        // Set the deck
-        u8 count = ring_buffer_consume_batch(state, state->session.deck_shape_color_bits, 3);
-        for (u8 i = 0; i < count; i++)
+void GameState_Migration(GameState *state)
+{
+    // v1 -> v2: [shape 4 | color 4] becomes [shape 5 | color 3], the shape ids are unchanged
+    if (state->utility.version == 1)
+    {
+        for (u8 i = 0; i < 64; i++)
         {
-            state->session.is_active[i] = false;
+            u8 old = state->ring_buffer[i];
+            state->ring_buffer[i] = MAKE_COMPOSITE(old >> 4, old & 0x0F);
         }
 
-        printf("Loaded new game state.");
+        for (u8 i = 0; i < 3; i++)
+        {
+            u8 old = state->session.deck_shape_color_bits[i];
+            state->session.deck_shape_color_bits[i] = MAKE_COMPOSITE(old >> 4, old & 0x0F);
+        }
+
+        state->utility.version = 2;
     }
 }
 
@@ -191,22 +318,45 @@ u64 xorshift(u64 *seed)
     return *seed = x;
 }
 
+// Each xorshift step is a bijection, so the stream can be walked backwards.
+// x ^= x << s is undone by resubstituting until every bit has been corrected.
+static u64 unshift_left_xor(u64 y, u32 s)
+{
+    u64 x = y;
+    for (u32 k = s; k < 64; k += s) x = y ^ (x << s);
+    return x;
+}
+
+static u64 unshift_right_xor(u64 y, u32 s)
+{
+    u64 x = y;
+    for (u32 k = s; k < 64; k += s) x = y ^ (x >> s);
+    return x;
+}
+
+u64 xorshift_back(u64 *seed)
+{
+    // Inverse of xorshift, returns the seed one step earlier
+    u64 x = *seed;
+    x = unshift_left_xor(x, 17);
+    x = unshift_right_xor(x, 7);
+    x = unshift_left_xor(x, 13);
+
+    return *seed = x;
+}
+
 u8 generate_composite_byte(u64 *seed)
 {
     // Generate shape and color as per the arrays allocations
 
     u64 r = xorshift(seed);
 
-    u8 shape = (u8)(r % SHAPE_OPTIONS) + 1;         // 10 color opptions 1-10 index
-    u8 color = (u8)((r >> 32) % COLOR_OPTIONS) + 1; // 8 valid color options 1-8
-
-    // 0x0F cleans the bytes ensuring 4 bits only
-    // composite_byte: [1000 | 1000](example bits) or [high | low] or [shape | color]
-    u8 high = (shape & 0x0F) << 4; // left bit shift by 4 to ensure no overlaps in the byte
-    u8 low = color & 0x0F;
+    u8 shape = (u8)(r % SHAPE_OPTIONS) + 1;         // shape options 1-SHAPE_OPTIONS index
+    u8 color = (u8)((r >> 32) % COLOR_OPTIONS) + 1; // 7 valid color options 1-7
 
+    // composite_byte: [sssss | ccc] or [high | low] or [shape | color]
     // return merged byte storing both a random shape and color
-    return (high | low);
+    return MAKE_COMPOSITE(shape, color);
 }
 
 void fill_queue(GameState *state)
@@ -219,16 +369,17 @@ void fill_queue(GameState *state)
 
     u8 slots_to_fill = 64 - buffer_occupancy;
 
-    for (u8 i = 0; i < slots_to_fill; i++)
-    {
-        u8 composite_byte = generate_composite_byte(&state->utility.rng_seed);
+    // Whole refill in one pass from the game's distribution, generated straight into
+    // the ring: at most two runs, up to the end of the buffer and from its start
+    const PieceDistribution *distribution = Pieces_StateDistribution(state);
+    u8 write_index = state->utility.ring_buffer_write_index & 63;
+    u8 first_run = slots_to_fill < 64 - write_index ? slots_to_fill : 64 - write_index;
 
-        if (!ring_buffer_produce(state, composite_byte))
-        {
-            TraceLog(LOG_WARNING, "RingBuffer overflow at index %d", state->utility.ring_buffer_write_index);
-            break;
-        }
-    }
+    Pieces_Fill(distribution, &state->utility.rng_seed, &state->ring_buffer[write_index], first_run);
+    Pieces_Fill(distribution, &state->utility.rng_seed, state->ring_buffer, slots_to_fill - first_run);
+
+    state->utility.ring_buffer_write_index += slots_to_fill;
+    state->utility.ring_buffer_counter += slots_to_fill;
 }
 
 // Rendering
@@ -248,71 +399,137 @@ void UpdateMenus(GameState *state, Vector2 virtual_mouse)
     }
 }
 
-void UpdateGameLogic(GameState *state, Vector2 virtual_mouse, u32 offsetX, u32 offsetY, u32 cellSize)
+static void BeginDrag(GameState *state, Vector2 pointer, u32 cellSize)
 {
-    if (!state->session.is_dragging) {
-        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            for (u8 i = 0; i < 3; i++) {
-                if (state->session.is_active[i]) continue;
+    for (u8 i = 0; i < 3; i++) {
+        if (state->session.is_active[i]) continue;
 
 
-                Rectangle slot_hit = { DECK_SLOTS[i].x - 20, DECK_SLOTS[i].y - 20, 40, 40 };
-                if (CheckCollisionPointRec(virtual_mouse, slot_hit)) {
-                    state->session.is_dragging = true;
-                    state->session.dragging_slot_index = i;
+        // Hit box is the shape's bounding box, centered on the slot
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[i])];
+        Vector2 origin = DeckSlotOrigin(state, i, cellSize);
+        Rectangle slot_hit = {
+            origin.x - (cellSize / 2.0f),
+            origin.y - (cellSize / 2.0f),
+            (f32)(shape->width * cellSize),
+            (f32)(shape->height * cellSize)
+        };
 
-                    state->session.drag_offset.x = DECK_SLOTS[i].x - virtual_mouse.x;
-                    state->session.drag_offset.y = DECK_SLOTS[i].y - virtual_mouse.y;
+        if (CheckCollisionPointRec(pointer, slot_hit)) {
+            state->session.is_dragging = true;
+            state->session.dragging_slot_index = i;
 
-                    // ensures first render doesnt glitch
-                    state->session.drag_pos.x = virtual_mouse.x + state->session.drag_offset.x;
-                    state->session.drag_pos.y = virtual_mouse.y + state->session.drag_offset.y;
+            state->session.drag_offset.x = origin.x - pointer.x;
+            state->session.drag_offset.y = origin.y - pointer.y;
 
-                    return; 
-                }
-            }
+            // ensures first render doesnt glitch (and doesnt interpolate in from 0, 0)
+            state->session.drag_pos.x = pointer.x + state->session.drag_offset.x;
+            state->session.drag_pos.y = pointer.y + state->session.drag_offset.y;
+            state->session.prev_drag_pos = state->session.drag_pos;
+
+            return; 
         }
+    }
+}
 
-        return;
+// Grid cell the dragged piece's top left cell snaps to (may be off the board)
+void DragSnapCell(const GameState *state, u32 offsetX, u32 offsetY, u32 cellSize, int *out_gx, int *out_gy)
+{
+    *out_gx = (int)roundf((state->session.drag_pos.x - (cellSize / 2.0f) - offsetX) / (float)cellSize);
+    *out_gy = (int)roundf((state->session.drag_pos.y - (cellSize / 2.0f) - offsetY) / (float)cellSize);  
+}
+
+// Placement puff, a burst per cleared cell in its own color and a score pop for clears
+static void SpawnMoveEffects(const GameState *state, ParticlePool *fx, const MoveResult *result, const u8 *colors_before,
+                             u8 composite, u32 offsetX, u32 offsetY, u32 cellSize)
+{
+    Vector2 origin = { (f32)offsetX, (f32)offsetY };
+    Color piece = state->utility.palette[GET_COLOR(composite)];
+
+    Particles_BurstCells(fx, result->placed_mask & ~result->clear_mask, NULL, NULL, piece, 2, origin, cellSize, 60.0f);
+    Particles_BurstCells(fx, result->clear_mask & result->placed_mask, NULL, NULL, piece, 8, origin, cellSize, 260.0f);
+    Particles_BurstCells(fx, result->clear_mask & ~result->placed_mask, colors_before, state->utility.palette, piece,
+                         8, origin, cellSize, 260.0f);
+
+    if (result->lines) {
+        Vector2 score_pos = { (f32)offsetX + 4.0f * cellSize, 412.0f };
+        Particles_Burst(fx, score_pos, 12u * result->lines, 220.0f, 0.8f, GOLD);
     }
+}
 
-    // 2. Drag Update (Continuously update position while button is held)
-    state->session.drag_pos.x = virtual_mouse.x + state->session.drag_offset.x;
-    state->session.drag_pos.y = virtual_mouse.y + state->session.drag_offset.y;
-
-
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-        int gx = (int)roundf((state->session.drag_pos.x - (cellSize / 2.0f) - offsetX) / (float)cellSize);
-        int gy = (int)roundf((state->session.drag_pos.y - (cellSize / 2.0f) - offsetY) / (float)cellSize);  
-        //int gx = (int)floorf((state->session.drag_pos.x - offsetX) / (float)cellSize);
-        //int gy = (int)floorf((state->session.drag_pos.y - offsetY) / (float)cellSize);
-
-        if (gx >= 0 && gx < 8 && gy >= 0 && gy < 8) {
-            u64 mask = 0;
-            if (TryPlace(state, state->session.dragging_slot_index, gx, gy, &mask)) {
-                // Success: Apply to bitboard and colors
-                state->grid.game_grid |= mask;
-                BakeColorsIntoGrid(state, mask, state->session.dragging_slot_index);
-
-                ClearLinesAndColors(state);
-                
-                state->session.is_active[state->session.dragging_slot_index] = true;
-                //state->session.current_score += 10;
-
-                // Refill Deck Check
-                if (state->session.is_active[0] && state->session.is_active[1] && state->session.is_active[2]) {
-                    ring_buffer_consume_batch(state, state->session.deck_shape_color_bits, 3);
-                    state->session.is_active[0] = state->session.is_active[1] = state->session.is_active[2] = false;
+static void DropDrag(GameState *state, SnapshotRing *history, ParticlePool *fx, Vector2 pointer, u32 offsetX, u32 offsetY, u32 cellSize)
+{
+    state->session.drag_pos.x = pointer.x + state->session.drag_offset.x;
+    state->session.drag_pos.y = pointer.y + state->session.drag_offset.y;
+
+    int gx, gy;
+    DragSnapCell(state, offsetX, offsetY, cellSize, &gx, &gy);
+    u8 slot = state->session.dragging_slot_index;
+
+    // Reset dragging state regardless of success, before any snapshot is taken
+    state->session.is_dragging = false;
+    state->session.dragging_slot_index = 0; 
+    state->session.drag_offset = (Vector2){ 0, 0 };
+    state->session.drag_pos = (Vector2){ 0, 0 };
+    state->session.prev_drag_pos = (Vector2){ 0, 0 };
+
+    if (gx >= 0 && gx < 8 && gy >= 0 && gy < 8) {
+        // First move of the session: keep the state it started from so it can be undone
+        if (SnapshotRing_Empty(history)) SnapshotRing_Push(history, state);
+
+        // Cleared cells lose their colors inside ApplyMove, the effects want them
+        u8 colors_before[32];
+        memcpy(colors_before, state->grid.grid_color, sizeof(colors_before));
+        u8 composite = state->session.deck_shape_color_bits[slot];
+
+        MoveResult result;
+        if (ApplyMove(state, slot, gx, gy, &result)) {
+            SnapshotRing_Push(history, state);
+            if (fx) SpawnMoveEffects(state, fx, &result, colors_before, composite, offsetX, offsetY, cellSize);
+
+            Telemetry_Place(state, slot, composite, gx, gy, &result);
+            if (!GameState_HasMove(state)) Telemetry_GameEnd(state, false);
+        } else {
+            Telemetry_Reject(state, slot, composite, gx, gy);
+        }
+    }
+}
+
+// One fixed logic tick: consumes every queued event stamped up to tick_end, in order
+void UpdateGameLogic(GameState *state, SnapshotRing *history, InputQueue *input, ParticlePool *fx, f64 tick_end, u32 offsetX, u32 offsetY, u32 cellSize)
+{
+    // Rendering blends from here to wherever this tick leaves the drag
+    state->session.prev_drag_pos = state->session.drag_pos;
+
+    InputEvent event;
+    while (InputQueue_Pop(input, tick_end, &event)) {
+        switch (event.type) {
+            case INPUT_UNDO:
+                if (!state->session.is_dragging) SnapshotRing_Undo(history, state);
+                break;
+
+            case INPUT_REDO:
+                if (!state->session.is_dragging) SnapshotRing_Redo(history, state);
+                break;
+
+            case INPUT_POINTER_DOWN:
+                if (!state->session.is_dragging) BeginDrag(state, event.pos, cellSize);
+                break;
+
+            case INPUT_POINTER_MOVE:
+                if (state->session.is_dragging) {
+                    state->session.drag_pos.x = event.pos.x + state->session.drag_offset.x;
+                    state->session.drag_pos.y = event.pos.y + state->session.drag_offset.y;
                 }
-            }
-        
+                break;
+
+            case INPUT_POINTER_UP:
+                if (state->session.is_dragging) DropDrag(state, history, fx, event.pos, offsetX, offsetY, cellSize);
+                break;
+
+            default:
+                break;
         }
-        
-        // Reset dragging state regardless of success
-        state->session.is_dragging = false;
-        state->session.dragging_slot_index = 0; 
-        state->session.drag_offset = (Vector2){ 0, 0 };
-        state->session.drag_pos = (Vector2){ 0, 0 };
     }
 }
 
@@ -324,106 +541,102 @@ void BakeColorsIntoGrid(GameState *state, u64 mask, u8 slot_index)
 {
     u8 color = GET_COLOR(state->session.deck_shape_color_bits[slot_index]);
 
-    for (int i = 0; i < 64; i++) {
-        // We check if the bit is set using the "Big Endian" (63-i) style
-        if ((mask >> (63 - i)) & 1) {
-            u8 byte_idx = i / 2;
-            if (i % 2 == 0) {
-                state->grid.grid_color[byte_idx] = (state->grid.grid_color[byte_idx] & 0x0F) | (color << 4);
-            } else {
-                state->grid.grid_color[byte_idx] = (state->grid.grid_color[byte_idx] & 0xF0) | (color & 0x0F);
-            }
-        }
-    }
+    // Walk only the set bits of the mask, cell i is bit (63 - i)
+    board8_bake_colors(state->grid.grid_color, mask, color);
 }
 
-void ClearLinesAndColors(GameState *state) 
+u32 ClearLinesAndColors(GameState *state, u64 *out_clear_mask) 
 {
-    u64 rows_to_clear = 0;
-    u64 cols_to_clear = 0;
-    u32 lines_cleared_count = 0;
+    // Full rows and columns found in one SWAR pass, see bg64_board.h
+    u32 lines_cleared_count = board8_clear_lines(&state->grid.game_grid, state->grid.grid_color, out_clear_mask);
 
-    for (int i = 0; i < 8; i++) {
-        if ((state->grid.game_grid & ROW_MASKS[i]) == ROW_MASKS[i]) {
-            rows_to_clear |= ROW_MASKS[i];
-            lines_cleared_count++; // Found a row!
-        }
-        if ((state->grid.game_grid & COL_MASKS[i]) == COL_MASKS[i]) {
-            cols_to_clear |= COL_MASKS[i];
-            lines_cleared_count++; // Found a column!
-        }
-    }
+    // 10 points per line
+    state->session.current_score += (lines_cleared_count * 10);
 
-    u64 total_clear_mask = rows_to_clear | cols_to_clear;
+    return lines_cleared_count;
+}
 
-    if (total_clear_mask != 0) {
-        // THE ERASER: This clears the logical blocks from the bitboard
-        state->grid.game_grid &= ~total_clear_mask;
 
-        for (int i = 0; i < 64; i++) {
-            if ((total_clear_mask >> (63 - i)) & 1) {
-                u8 byte_idx = i >> 1;
-                if ((i & 1) == 0) state->grid.grid_color[byte_idx] &= 0x0F;
-                else state->grid.grid_color[byte_idx] &= 0xF0;
-            }
-        }
 
-        // 4. Update Score: 10 points per line
-        state->session.current_score += (lines_cleared_count * 10);
 
-        // Now clear the colors for those specific bits
-        // for (int i = 0; i < 64; i++) {
-        //     if ((total_clear_mask >> (63 - i)) & 1) {
-        //         u8 byte_idx = i / 2;
-        //         if (i % 2 == 0) state->grid.grid_color[byte_idx] &= 0x0F; // Clear high nibble
-        //         else state->grid.grid_color[byte_idx] &= 0xF0;           // Clear low nibble
-        //     }
-        // }
 
-        // state->session.current_score += 10;
-    }
-}
 
+bool ApplyMove(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result)
+{
+    if (slot_idx > 2 || state->session.is_active[slot_idx]) return false;
 
+    u64 mask = 0;
+    if (!TryPlace(state, slot_idx, gx, gy, &mask)) return false;
 
+    u64 score_before = state->session.current_score;
 
+    // Success: Apply to bitboard and colors
+    state->grid.game_grid |= mask;
+    BakeColorsIntoGrid(state, mask, slot_idx);
 
+    u64 clear_mask = 0;
+    u32 lines = ClearLinesAndColors(state, &clear_mask);
 
-bool TryPlace(GameState *state, u8 slot_idx, int gx, int gy, u64 *out_mask) 
+    state->session.is_active[slot_idx] = true;
+
+    // Refill Deck Check, then top the queue back up so it never runs dry mid game
+    bool refilled = false;
+    if (state->session.is_active[0] && state->session.is_active[1] && state->session.is_active[2]) {
+        ring_buffer_consume_batch(state, state->session.deck_shape_color_bits, 3);
+        state->session.is_active[0] = state->session.is_active[1] = state->session.is_active[2] = false;
+        fill_queue(state);
+        refilled = true;
+    }
+
+    if (out_result) {
+        out_result->placed_mask = mask;
+        out_result->clear_mask = clear_mask;
+        out_result->score_delta = (u32)(state->session.current_score - score_before);
+        out_result->lines = (u8)lines;
+        out_result->slot = slot_idx;
+        out_result->deck_refilled = refilled;
+    }
+
+    return true;
+}
+
+bool GameState_HasMove(const GameState *state)
 {
-    // 1. HARD BOUNDARY: If the anchor itself is totally off-screen
-    if (gx < 0 || gy < 0 || gx >= 8 || gy >= 8) return false;
+    u64 grid = state->grid.game_grid;
 
-    u8 composite = state->session.deck_shape_color_bits[slot_idx];
-    u64 shape_mask = SHAPE_LIBRARY[GET_SHAPE(composite)];
-
-    // 2. SPILLOVER CHECK: Detect if bits wrap from right-edge to left-edge
-    for (int i = 0; i < 4; i++) {
-        // Extract 8 bits for the current row of the 4x4 shape
-        u8 row = (u8)((shape_mask >> (56 - (i * 8))) & 0xFF);
-        if (row > 0) {
-            // Find how many bits wide this specific row is
-            // __builtin_clz works on 32-bit ints, so we adjust for our 8-bit row
-            int row_width = 8 - __builtin_ctz(row); 
-            
-            // If anchor gx + the width of this row > 8, it's a spillover
-            if (gx + row_width > 8) return false;
-            // If the row exists but the anchor gy pushes it off the bottom
-            if (gy + i > 7) return false;
+    for (u8 i = 0; i < 3; i++) {
+        if (state->session.is_active[i]) continue;
+
+        // Walk the shape's legal anchors, the first collision free one ends the search
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[i])];
+        u64 anchors = shape->anchors;
+        while (anchors) {
+            u32 bit = 63 - (u32)__builtin_ctzll(anchors);
+            anchors &= anchors - 1;
+            if (!(grid & (shape->mask >> bit))) return true;
         }
     }
 
-    // 3. BITWISE SHIFT: Move shape to the grid coordinates
-    // gy * 8 moves it down rows, gx moves it across columns
-    u64 shifted = shape_mask >> (gy * 8 + gx);
+    return false;
+}
 
-    // 4. COLLISION CHECK: Is any bit already occupied?
-    if (state->grid.game_grid & shifted) return false;
+Vector2 DeckSlotOrigin(const GameState *state, u8 slot_idx, u32 cellSize)
+{
+    // Center of the shape's top left cell when its bounding box is centered on the slot
+    const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[slot_idx])];
 
-    // Success! Pass the mask back to be 'baked' into the grid
-    *out_mask = shifted;
+    return (Vector2){
+        DECK_SLOTS[slot_idx].x + shape->render_dx * cellSize,
+        DECK_SLOTS[slot_idx].y + shape->render_dy * cellSize
+    };
+}
 
-    return true;
+bool TryPlace(GameState *state, u8 slot_idx, int gx, int gy, u64 *out_mask) 
+{
+    u8 composite = state->session.deck_shape_color_bits[slot_idx];
+
+    // Boundary and spillover are one lookup in the shape's legal anchor set, then collision
+    return board8_try_place_anchor(state->grid.game_grid, &SHAPE_INFO[GET_SHAPE(composite)], gx, gy, out_mask);
 }
 
 
@@ -444,7 +657,7 @@ void RenderMainScreen(GameState *state, u32 virtual_width, Vector2 virtualMouse)
 }
 
 
-void RenderGameScreen(GameState *state, u32 offsetX, u32 offsetY, u32 cellSize, i32 virtual_width)
+void RenderGameScreen(GameState *state, const PlacementPreview *preview, u32 offsetX, u32 offsetY, u32 cellSize, i32 virtual_width, f32 alpha)
 {
     for (int y = 0; y < 8; y++) {
         for (int x = 0; x < 8; x++) {
@@ -470,6 +683,28 @@ void RenderGameScreen(GameState *state, u32 offsetX, u32 offsetY, u32 cellSize,
         }
     }
 
+    // Ghost of a legal drop and the lines it would clear, straight from the preview cache
+    if (preview && preview->active && preview->legal) {
+        Color ghost = Fade(state->utility.palette[GET_COLOR(preview->composite)], 0.35f);
+        u64 cells = preview->placed_mask | preview->clear_mask;
+
+        while (cells) {
+            u32 cell_idx = 63 - (u32)__builtin_ctzll(cells);
+            u64 bit = cells & -cells;
+            cells &= cells - 1;
+
+            Rectangle cell = {
+                (float)offsetX + ((cell_idx & 7) * cellSize),
+                (float)offsetY + ((cell_idx >> 3) * cellSize),
+                (float)cellSize,
+                (float)cellSize
+            };
+
+            if (preview->placed_mask & bit) DrawRectangleRec(cell, ghost);
+            if (preview->clear_mask & bit) DrawRectangleRec(cell, Fade(RAYWHITE, 0.3f));
+        }
+    }
+
     RenderCenteredText(TextFormat("Score: %i", state->session.current_score), 400, 25, RAYWHITE, virtual_width);
 
 
@@ -480,20 +715,24 @@ void RenderGameScreen(GameState *state, u32 offsetX, u32 offsetY, u32 cellSize,
         u64 shape_mask = SHAPE_LIBRARY[GET_SHAPE(composite)];
         Color c = state->utility.palette[GET_COLOR(composite)];
 
-        Vector2 draw_pos = (state->session.is_dragging && state->session.dragging_slot_index == i) 
-                            ? state->session.drag_pos 
-                            : DECK_SLOTS[i];
+        // The dragged piece is drawn between the last two logic ticks, alpha of the way along
+        Vector2 draw_pos = DeckSlotOrigin(state, i, cellSize);
+        if (state->session.is_dragging && state->session.dragging_slot_index == i) {
+            Vector2 from = state->session.prev_drag_pos;
+            Vector2 to = state->session.drag_pos;
+            draw_pos = (Vector2){ from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha };
+        }
 
-        for (int y = 0; y < 4; y++) {
-            for (int x = 0; x < 4; x++) {
-                if ((shape_mask >> (63 - (y * 8 + x))) & 1) {
-                    float bx = draw_pos.x + (x * cellSize) - (cellSize / 2.0f);
-                    float by = draw_pos.y + (y * cellSize) - (cellSize / 2.0f);
+        // Visit only the filled cells, cell i is bit (63 - i)
+        while (shape_mask) {
+            u32 cell_idx = 63 - (u32)__builtin_ctzll(shape_mask);
+            shape_mask &= shape_mask - 1;
 
-                    DrawRectangle(bx, by, cellSize, cellSize, c);
-                    DrawRectangleLinesEx((Rectangle){bx, by, (float)cellSize, (float)cellSize}, 2.0f, ColorAlpha(BLACK, 0.3f));
-                }
-            }
+            float bx = draw_pos.x + ((cell_idx & 7) * cellSize) - (cellSize / 2.0f);
+            float by = draw_pos.y + ((cell_idx >> 3) * cellSize) - (cellSize / 2.0f);
+
+            DrawRectangle(bx, by, cellSize, cellSize, c);
+            DrawRectangleLinesEx((Rectangle){bx, by, (float)cellSize, (float)cellSize}, 2.0f, ColorAlpha(BLACK, 0.3f));
         }
     }
 
@@ -14,6 +14,7 @@ typedef uint8_t u8;      // 1 byte
 typedef uint16_t u16;    // 2 bytes 
 typedef uint32_t u32;    // 4 bytes 
 typedef uint64_t u64;    // 8 bytes 
+typedef unsigned __int128 u128; // 16 bytes
 typedef size_t usize;    // 4 or 8 bytes 
 
 
@@ -40,14 +41,41 @@ static const Rectangle PLAY_BUTTON = { (360 / 2.0f) - 80, 400, 160, 50 };
 
 typedef struct 
 {
-    u8 *base;      // Pointer to the BLOCK-O-MEM
-    usize size;    // Total capacity
-    usize offset;  // Current offset bump increment
+    u8 *base;         // Pointer to the BLOCK-O-MEM (reserved address space)
+    usize size;       // Total reserved capacity
+    usize offset;     // Current offset bump increment
+    usize committed;  // Bytes backed by read/write pages, grows with offset
+    usize granule;    // Commit step, 64KB or 2MB with huge pages
+    u32 flags;        // ARENA_* flags
 } Arena;
 
+// Scratch marker: everything pushed after Arena_Save is freed by Arena_Restore
+typedef struct
+{
+    Arena *arena;
+    usize offset;
+} ArenaMark;
+
+// Undo/redo and make/unmake snapshots, see bg64_history.h
+typedef struct SnapshotRing SnapshotRing;
+typedef struct InputQueue InputQueue;
+typedef struct PlacementPreview PlacementPreview;
+typedef struct ParticlePool ParticlePool;
+
+// Transparent huge pages for big tables probed at random (solver, MCTS, adversary tools)
+#define ARENA_HUGE_PAGES (1u << 0)
+#define ARENA_COMMIT_GRANULE ((usize)64 * 1024)
+#define ARENA_HUGE_GRANULE ((usize)2 * 1024 * 1024)
+
+// Scoped scratch: ARENA_SCOPE(&arena) { ... } rewinds the arena when the block ends.
+// Leaving the block with break/return skips the rewind, save and restore by hand there.
+#define ARENA_SCOPE(arena_ptr) \
+    for (ArenaMark arena_scope_mark_ = Arena_Save(arena_ptr); arena_scope_mark_.arena; \
+         Arena_Restore(arena_scope_mark_), arena_scope_mark_.arena = NULL)
+
 
 // CACHE LINE 0
-// 24 spare bytes
+// 8 spare bytes
 typedef struct 
 {
     // Determines the occupancy of each spot on the game grid
@@ -56,7 +84,10 @@ typedef struct
     // each u8 stores the color of two 4 bit blocks colors, 64 colors total
     u8 grid_color[32];  // 32 bytes
 
-    u8 _padding[24];    // 24 bytes 
+    // PIECE_MODE_CUSTOM weights, 4 bits each (bg64_pieces), older saves hold 0: uniform
+    u8 piece_weights[16]; // 16 bytes
+
+    u8 _padding[8];     // 8 bytes 
     
 } game_grid; // 64 bytes, 1 cache line
 
@@ -74,10 +105,14 @@ typedef struct
     bool is_dragging;         // 1 byte ; 34
 
     // DECK BLOCKS
-    u8 deck_shape_color_bits[3]; // 3 bytes: 37 ; 4 bits for shape, 4 for color
+    u8 deck_shape_color_bits[3]; // 3 bytes: 37 ; 5 bits for shape, 3 for color (MAKE_COMPOSITE)
     bool is_active[3];           // 3 byte: 40 ; determines if the block is in the grid or in the deck (active is in the grids
 
-    u8 _padding [24];     // 24 bytes 
+    Vector2 prev_drag_pos;    // 8 bytes ; 48 ; drag_pos as of the previous logic tick, rendering interpolates from it
+
+    u8 piece_mode;            // 1 byte ; 49 ; PieceMode (bg64_pieces), older saves hold 0 here: classic
+
+    u8 _padding [15];     // 15 bytes 
 } player_session; // 64 bytes, 1 Cache line
 
 
@@ -125,6 +160,18 @@ typedef struct
 
 
 
+// Outcome of one committed placement, filled by ApplyMove
+typedef struct
+{
+    u64 placed_mask;    // cells the shape covered
+    u64 clear_mask;     // cells removed by full rows and columns
+    u32 score_delta;
+    u8 lines;           // rows + columns cleared
+    u8 slot;
+    bool deck_refilled;
+} MoveResult;
+
+
 static const Vector2 DECK_SLOTS[3] = {
     { 60.0f,  650.0f },
     { 170.0f, 650.0f },
@@ -132,48 +179,22 @@ static const Vector2 DECK_SLOTS[3] = {
 };
 
 
-static const u64 SHAPE_LIBRARY[16] = { // 10
-    [0]  = 0, // Void
-
-    // [X]
-    [1]  = 0x8000000000000000,                // 1x1 Dot
-
-    // [X][X]
-    [2]  = 0xC000000000000000,                // 2x1 Horizontal
-
-    // [X][X][X]
-    [3]  = 0xE000000000000000,                // 3x1 Horizontal
-
-    // [ ][X][ ]
-    // [X][X][X]
-    [4]  = 0x40E0000000000000,                // T-Shape (3x2)
-
-    // [X][ ]
-    // [X][X][X]
-    [5]  = 0x80E0000000000000,                // L-Shape (Small)
-
-    // [X][X]
-    // [X][X]
-    [6]  = 0xC0C0000000000000,                // 2x2 Square
-
-    // [X][ ][ ]
-    // [X][ ][ ]
-    // [X][X][X]
-    [7]  = 0x8080E00000000000,                // L-Shape (3x3)
-
-    // [X][X][X]
-    // [X][X][X]
-    // [X][X][X]
-    [8]  = 0xE0E0E00000000000,                // 3x3 Big Square
+// Per shape metadata, derived once by tools/shapegen from shapes.txt
+typedef struct
+{
+    u64 mask;          // 8x8 mask anchored top left (bit 63), same as SHAPE_LIBRARY
+    u64 anchors;       // legal anchors on an empty 8x8 board, bit (63 - (gy * 8 + gx))
+    u64 transposed;    // mask mirrored over the main diagonal, for boards kept transposed
+    u8 width;          // bounding box in cells
+    u8 height;
+    u8 cells;          // popcount of the mask
+    u8 row_extent[8];  // cells from column 0 to the last filled cell of each row
+    f32 render_dx;     // offset in cells from a deck slot center to the top left cell center
+    f32 render_dy;
+    const char *name;
+} ShapeInfo;
 
-    // [X][X][X][X]
-    [9]  = 0xF000000000000000,                // 4x1 Horizontal
-
-    // [X][X]
-    // [X][X]
-    // [X][X]
-    [10] = 0xC0C0C00000000000,               // 2x3 Vertical
-};
+#include "bg64_shapes.h" // SHAPE_LIBRARY, SHAPE_INFO, SHAPE_COUNT, SHAPE_OPTIONS
 
 
 static const u64 ROW_MASKS[8] = {
@@ -188,18 +209,36 @@ static const u64 COL_MASKS[8] = {
 
 
 // GAME STATE
-static const usize ARENA_SIZE = 1024 * 1024;
+// Reserved address space only, pages are committed as the arena grows
+static const usize ARENA_SIZE = (usize)4 * 1024 * 1024 * 1024;
+
+#define GAMESTATE_MAGIC 0x474C4B21 // "GLK!"
+#define GAMESTATE_VERSION 2        // 2: composite byte split 5 shape bits / 3 color bits
 
-#define SHAPE_OPTIONS 10
 #define COLOR_OPTIONS 3
 
-#define GET_SHAPE(composite_byte) ((composite_byte >> 4) & 0x0F)
-#define GET_COLOR(composite_byte) (composite_byte & 0x0F)
+// composite_byte: [sssss | ccc] 5 bits for the shape (up to 31), 3 for the color (up to 7)
+#define SHAPE_BITS 5
+#define COLOR_BITS 3
+#define MAKE_COMPOSITE(shape, color) ((u8)(((shape) << COLOR_BITS) | ((color) & 0x07)))
+#define GET_SHAPE(composite_byte) (((composite_byte) >> COLOR_BITS) & 0x1F)
+#define GET_COLOR(composite_byte) ((composite_byte) & 0x07)
 
 // Allocations & Inits
+Arena Arena_Reserve(usize size, u32 flags);
 Arena GameArena_Allocation(usize size);
+void Arena_Release(Arena *arena);
+void *Arena_Push(Arena *arena, usize size, usize align);
+void *Arena_PushZero(Arena *arena, usize size, usize align);
+ArenaMark Arena_Save(Arena *arena);
+void Arena_Restore(ArenaMark mark);
 GameState* GameState_Allocation(Arena *arena);
 void GameState_Initialization(GameState *state);
+void GameState_Migration(GameState *state);
+void GameState_Reset(GameState *state, u64 seed);
+void GameState_ResetMode(GameState *state, u64 seed, u8 piece_mode);
+void GameState_ResetPieces(GameState *state, u64 seed, u8 piece_mode, const u8 *piece_weights); // NULL: all zero
+bool GameState_HasMove(const GameState *state);
 
 // File I/O
 usize save_state(const char* file, GameState* state);
@@ -211,6 +250,7 @@ u8 ring_buffer_consume(GameState *state);
 u8 ring_buffer_consume_batch(GameState *state, u8 *batch, u8 max_batch_size); // pass in a [u8; 256] 
 u8 ring_buffer_data_available(GameState *state);
 u64 xorshift(u64 *seed);
+u64 xorshift_back(u64 *seed);
 u8 generate_composite_byte(u64 *seed);
 void fill_queue(GameState *state);
 
@@ -218,15 +258,18 @@ void fill_queue(GameState *state);
 
 // GameState
 bool TryPlace(GameState *state, u8 slot_idx, int gx, int gy, u64 *out_mask);
+bool ApplyMove(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result);
+Vector2 DeckSlotOrigin(const GameState *state, u8 slot_idx, u32 cellSize);
+void DragSnapCell(const GameState *state, u32 offsetX, u32 offsetY, u32 cellSize, int *out_gx, int *out_gy);
 void UpdateMenus(GameState *state, Vector2 virtual_mouse);\
-void UpdateGameLogic(GameState *state, Vector2 virtual_mouse, u32 offsetX, u32 offsetY, u32 cellSize);
+void UpdateGameLogic(GameState *state, SnapshotRing *history, InputQueue *input, ParticlePool *fx, f64 tick_end, u32 offsetX, u32 offsetY, u32 cellSize);
 void BakeColorsIntoGrid(GameState *state, u64 mask, u8 slot_index);
 
 // Rendering
 void RenderCenteredText(const char* text, u32 y, u32 font_size, Color color, u32 virtual_width);
-void ClearLinesAndColors(GameState *state);
+u32 ClearLinesAndColors(GameState *state, u64 *out_clear_mask);
 void RenderMainScreen(GameState *state, u32 virtual_width, Vector2 virtualMouse);
-void RenderGameScreen(GameState *state, u32 offsetX, u32 offsetY, u32 cellSize, i32 virtual_width);
+void RenderGameScreen(GameState *state, const PlacementPreview *preview, u32 offsetX, u32 offsetY, u32 cellSize, i32 virtual_width, f32 alpha);
 
 
 #endif /* RING_BUFFER_H_ */
\ No newline at end of file
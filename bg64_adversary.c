@@ -0,0 +1,363 @@
+#include <string.h>
+#include "bg64_adversary.h"
+#include "bg64_board.h"
+#include "bg64_eval.h"
+#include "bg64_movegen.h"
+#include "bg64_symmetry.h"
+
+// Entry info: bit 31 set for player nodes, which also store the shapes still to place
+#define INFO_PLAYER (1u << 31)
+
+typedef struct
+{
+    u64 grid;
+    f32 key;
+    u8 slot;
+    u8 cell;
+} AdversaryChild;
+
+
+// Slides a transformed shape back against row 0 and column 0
+static u64 shape_normalize(u64 mask)
+{
+    while (!(mask & ROW_MASKS[0])) mask <<= 8;
+    while (!(mask & COL_MASKS[0])) mask <<= 1;
+    return mask;
+}
+
+// Every image of every shape is a shape too: boards in one symmetry orbit are then worth
+// the same to both sides
+static bool library_closed(void)
+{
+    for (u32 s = 1; s <= SHAPE_OPTIONS; s++) {
+        for (u32 sym = SYM_IDENTITY + 1; sym < SYM_COUNT; sym++) {
+            u64 image = shape_normalize(grid_symmetry(SHAPE_INFO[s].mask, (Symmetry)sym));
+            bool found = false;
+            for (u32 t = 1; t <= SHAPE_OPTIONS && !found; t++) found = SHAPE_INFO[t].mask == image;
+            if (!found) return false;
+        }
+    }
+    return true;
+}
+
+Adversary Adversary_Allocation(Arena *arena, u32 table_bits)
+{
+    u64 entries = 1ULL << table_bits;
+    Adversary adversary = {
+        .table = (AdversaryEntry *)Arena_PushZero(arena, entries * sizeof(AdversaryEntry), 64),
+        .table_mask = entries - 1,
+        .canonical = library_closed()};
+    return adversary;
+}
+
+static inline u64 adversary_hash(u64 grid, u32 info)
+{
+    u64 h = (grid ^ (u64)info * 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 31);
+}
+
+static inline AdversaryEntry *adversary_probe(Adversary *adversary, u64 grid, u32 info)
+{
+    AdversaryEntry *e = &adversary->table[adversary_hash(grid, info) & adversary->table_mask];
+    if (e->generation != adversary->generation || e->grid != grid || e->info != info) return NULL;
+    return e;
+}
+
+// Fail soft: a result at or below alpha is an upper bound, at or above beta a lower bound
+static inline void adversary_store(Adversary *adversary, u64 grid, u32 info, i32 value, i32 alpha, i32 beta, u32 depth)
+{
+    AdversaryEntry *e = &adversary->table[adversary_hash(grid, info) & adversary->table_mask];
+    i8 lower = value <= alpha ? 0 : (i8)value;
+    i8 upper = value >= beta ? (i8)depth : (i8)value;
+    *e = (AdversaryEntry){ grid, info, lower, upper, adversary->generation, 0 };
+}
+
+// Table cut, or false with the window to search
+static inline bool adversary_lookup(Adversary *adversary, u64 grid, u32 info, i32 alpha, i32 beta, i32 *out_value)
+{
+    AdversaryEntry *e = adversary_probe(adversary, grid, info);
+    if (!e) return false;
+
+    adversary->table_hits++;
+    if (e->lower == e->upper || e->lower >= beta) *out_value = e->lower;
+    else if (e->upper <= alpha) *out_value = e->upper;
+    else return false;
+    return true;
+}
+
+static inline bool adversary_out_of_budget(Adversary *adversary)
+{
+    adversary->nodes++;
+    if (adversary->node_budget && adversary->nodes > adversary->node_budget) adversary->aborted = true;
+    return adversary->aborted;
+}
+
+// Every deck as sorted shape triples, built from the shapes with the fewest legal spots on
+// grid first. A shape with no spot at all comes first, three of it end the game at once.
+static u32 adversary_decks(u64 grid, u8 (*out_decks)[3])
+{
+    u8 shapes[SHAPE_OPTIONS];
+    u32 spots[SHAPE_COUNT];
+    for (u32 s = 1; s <= SHAPE_OPTIONS; s++) {
+        spots[s] = u64_popcount(MoveGen_LegalAnchors(grid, &SHAPE_INFO[s]));
+
+        u32 i = s - 1;
+        while (i > 0 && spots[shapes[i - 1]] > spots[s]) {
+            shapes[i] = shapes[i - 1];
+            i--;
+        }
+        shapes[i] = (u8)s;
+    }
+
+    u32 count = 0;
+    for (u32 i = 0; i < SHAPE_OPTIONS; i++) {
+        for (u32 j = i; j < SHAPE_OPTIONS; j++) {
+            for (u32 k = j; k < SHAPE_OPTIONS; k++) {
+                u8 a = shapes[i], b = shapes[j], c = shapes[k], t;
+                if (a > b) t = a, a = b, b = t;
+                if (b > c) t = b, b = c, c = t;
+                if (a > b) t = a, a = b, b = t;
+                out_decks[count][0] = a;
+                out_decks[count][1] = b;
+                out_decks[count][2] = c;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// Placements of the shapes left in rem (sorted), a repeated shape only once, with their
+// ordering keys. Most player nodes cut on their first child or two, so the children are
+// not sorted: next_child picks the best remaining one.
+static u32 player_children(u64 grid, const u8 *rem, u32 n, bool evaluate, AdversaryChild *out)
+{
+    u8 deck[3] = { 0 };
+    u8 active = 0;
+    for (u32 k = 0; k < 3; k++) {
+        if (k < n) deck[k] = MAKE_COMPOSITE(rem[k], 1);
+        if (k >= n || (k > 0 && rem[k] == rem[k - 1])) active |= (u8)(1u << k);
+    }
+
+    Successor successors[MOVEGEN_MAX_SUCCESSORS];
+    u64 grids[MOVEGEN_MAX_SUCCESSORS];
+    f32 scores[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = MoveGen_Board(grid, deck, active, successors);
+    if (count == 0) return 0;
+
+    for (u32 i = 0; i < count; i++) grids[i] = successors[i].grid;
+    // On the last deck the pieces only have to fit: emptiest board first orders about as
+    // well as the evaluation, at a fraction of the cost
+    if (evaluate) {
+        Eval_ScoreBatch(&EVAL_DEFAULT_WEIGHTS, grids, count, scores);
+    } else {
+        for (u32 i = 0; i < count; i++) scores[i] = -(f32)u64_popcount(grids[i]);
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        out[i] = (AdversaryChild){ successors[i].grid, scores[i] + 4.0f * successors[i].lines, successors[i].slot,
+                                   successors[i].cell };
+    }
+    return count;
+}
+
+// Moves the best of children[i..count) to i
+static inline const AdversaryChild *next_child(AdversaryChild *children, u32 i, u32 count)
+{
+    u32 best = i;
+    for (u32 j = i + 1; j < count; j++) {
+        if (children[j].key > children[best].key) best = j;
+    }
+    AdversaryChild c = children[best];
+    children[best] = children[i];
+    children[i] = c;
+    return &children[i];
+}
+
+static i32 adversary_node(Adversary *adversary, u64 grid, u32 depth, i32 alpha, i32 beta);
+
+// rem without its slot-th shape
+static inline u32 remove_shape(const u8 *rem, u32 n, u32 slot, u8 *out_rem)
+{
+    u32 m = 0;
+    for (u32 k = 0; k < n; k++) {
+        if (k != slot) out_rem[m++] = rem[k];
+    }
+    return m;
+}
+
+// Value of playing child (the placement of rem[slot]) for the player
+static i32 player_child(Adversary *adversary, const AdversaryChild *child, const u8 *rem, u32 n, u32 depth, i32 alpha,
+                        i32 beta);
+
+// Player to place the n shapes in rem: the most decks they can still complete
+static i32 player_node(Adversary *adversary, u64 grid, const u8 *rem, u32 n, u32 depth, i32 alpha, i32 beta)
+{
+    if (adversary_out_of_budget(adversary)) return 0;
+
+    // Last piece of the horizon: it only has to fit
+    if (n == 1 && depth == 1) return MoveGen_LegalAnchors(grid, &SHAPE_INFO[rem[0]]) != 0;
+
+    u32 info = INFO_PLAYER | depth << 16 | (u32)rem[0] | (n > 1 ? (u32)rem[1] << 5 : 0) | (n > 2 ? (u32)rem[2] << 10 : 0);
+    i32 value;
+    if (adversary_lookup(adversary, grid, info, alpha, beta, &value)) return value;
+
+    AdversaryChild children[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = player_children(grid, rem, n, depth > 1, children);
+
+    // Stuck, or nothing beats completing every deck of the horizon
+    i32 best = 0;
+    i32 a = alpha;
+    for (u32 i = 0; i < count; i++) {
+        i32 v = player_child(adversary, next_child(children, i, count), rem, n, depth, a, beta);
+        if (adversary->aborted) return 0;
+        if (v > best) best = v;
+        if (best >= beta || best == (i32)depth) {
+            adversary->cutoffs++;
+            break;
+        }
+        if (best > a) a = best;
+    }
+
+    adversary_store(adversary, grid, info, best, alpha, beta, depth);
+    return best;
+}
+
+static i32 player_child(Adversary *adversary, const AdversaryChild *child, const u8 *rem, u32 n, u32 depth, i32 alpha,
+                        i32 beta)
+{
+    if (n == 1) {
+        // Deck done: one more deck survived, the adversary picks the next
+        if (depth == 1) return 1;
+        return 1 + adversary_node(adversary, child->grid, depth - 1, alpha - 1, beta - 1);
+    }
+
+    u8 next[3];
+    u32 m = remove_shape(rem, n, child->slot, next);
+    return player_node(adversary, child->grid, next, m, depth, alpha, beta);
+}
+
+// Adversary to pick a deck: the fewest decks the player can then complete
+static i32 adversary_node(Adversary *adversary, u64 grid, u32 depth, i32 alpha, i32 beta)
+{
+    if (adversary_out_of_budget(adversary)) return 0;
+
+    u64 key = adversary->canonical ? grid_canonical(grid, NULL) : grid;
+    i32 value;
+    if (adversary_lookup(adversary, key, depth, alpha, beta, &value)) return value;
+
+    u8 decks[ADVERSARY_DECKS][3];
+    u32 count = adversary_decks(grid, decks);
+
+    i32 best = (i32)depth;
+    i32 b = beta;
+    for (u32 d = 0; d < count; d++) {
+        i32 v = player_node(adversary, grid, decks[d], 3, depth, alpha, b);
+        if (adversary->aborted) return 0;
+        if (v < best) best = v;
+        if (best <= alpha || best == 0) {
+            adversary->cutoffs++;
+            break;
+        }
+        if (best < b) b = best;
+    }
+
+    adversary_store(adversary, key, depth, best, alpha, beta, depth);
+    return best;
+}
+
+// Exact value through a window of one around the expected value
+static inline bool player_child_is(Adversary *adversary, const AdversaryChild *child, const u8 *rem, u32 n, u32 depth,
+                                   i32 value)
+{
+    return player_child(adversary, child, rem, n, depth, value - 1, value + 1) == value;
+}
+
+// Plays the forcing line out: the adversary's first deck that holds the player to value,
+// the player's placements that keep it, until the player is stuck
+static void adversary_line(Adversary *adversary, u64 grid, u32 depth, i32 value, AdversaryResult *out_result)
+{
+    out_result->line_decks = 0;
+    while (out_result->line_decks < ADVERSARY_MAX_DECKS && !adversary->aborted) {
+        AdversaryStep *step = &out_result->line[out_result->line_decks++];
+        *step = (AdversaryStep){ .grid_after = grid };
+
+        u8 decks[ADVERSARY_DECKS][3];
+        u32 count = adversary_decks(grid, decks);
+        u32 pick = 0;
+        for (u32 d = 0; d < count; d++) {
+            if (player_node(adversary, grid, decks[d], 3, depth, value - 1, value + 1) == value) {
+                pick = d;
+                break;
+            }
+        }
+        memcpy(step->shapes, decks[pick], 3);
+
+        u8 rem[3];
+        memcpy(rem, decks[pick], 3);
+        u32 n = 3;
+        while (n > 0) {
+            AdversaryChild children[MOVEGEN_MAX_SUCCESSORS];
+            u32 children_count = player_children(grid, rem, n, depth > 1, children);
+
+            const AdversaryChild *keep = NULL;
+            for (u32 i = 0; i < children_count && !keep; i++) {
+                const AdversaryChild *child = next_child(children, i, children_count);
+                if (player_child_is(adversary, child, rem, n, depth, value)) keep = child;
+            }
+            if (!keep) break; // stuck
+
+            step->order[step->placed] = rem[keep->slot];
+            step->cells[step->placed] = keep->cell;
+            step->placed++;
+            grid = keep->grid;
+            n = remove_shape(rem, n, keep->slot, rem);
+        }
+        step->grid_after = grid;
+
+        if (step->placed < 3 || depth == 1) break;
+        depth--;
+        value--;
+    }
+}
+
+void Adversary_Search(Adversary *adversary, u64 grid, u32 max_decks, u64 node_budget, bool count_forcing,
+                      AdversaryResult *out_result)
+{
+    if (max_decks < 1) max_decks = 1;
+    if (max_decks > ADVERSARY_MAX_DECKS) max_decks = ADVERSARY_MAX_DECKS;
+
+    // Entries from earlier searches are misses, a wrap clears the table for real
+    if (++adversary->generation == 0) {
+        memset(adversary->table, 0, (adversary->table_mask + 1) * sizeof(AdversaryEntry));
+        adversary->generation = 1;
+    }
+    adversary->node_budget = node_budget;
+    adversary->aborted = false;
+    adversary->nodes = adversary->table_hits = adversary->cutoffs = 0;
+
+    *out_result = (AdversaryResult){ 0 };
+    for (u32 depth = 1; depth <= max_decks; depth++) {
+        i32 value = adversary_node(adversary, grid, depth, -1, (i32)depth + 1);
+        if (adversary->aborted) break;
+
+        out_result->horizon = depth;
+        out_result->value = (u32)value;
+        if (value < (i32)depth) {
+            out_result->forced = true;
+            adversary_line(adversary, grid, depth, value, out_result);
+            break;
+        }
+    }
+
+    if (count_forcing && !adversary->aborted) {
+        u8 decks[ADVERSARY_DECKS][3];
+        u32 count = adversary_decks(grid, decks);
+        for (u32 d = 0; d < count; d++) out_result->forcing_decks += player_node(adversary, grid, decks[d], 3, 1, 0, 1) == 0;
+    }
+
+    out_result->complete = !adversary->aborted;
+    out_result->nodes = adversary->nodes;
+    out_result->table_hits = adversary->table_hits;
+    out_result->cutoffs = adversary->cutoffs;
+}
@@ -0,0 +1,80 @@
+#ifndef BG64_ADVERSARY_H_
+#define BG64_ADVERSARY_H_
+
+
+#include "bg64.h"
+
+
+// ADVERSARIAL PIECE SEARCH
+// How fast can a perfect player be forced into game over when the piece generator plays
+// against them? The adversary picks each deck, any 3 library shapes, and the player then
+// places all three in the order and spots of their choice. The value of a board is the
+// number of decks the player still gets fully onto it, capped at the horizon, so a value
+// below the horizon is a forced game over within value + 1 decks.
+//
+// Minimax with alpha-beta on the bitboard. Decks are tried hardest first (the shapes with
+// the fewest legal spots), player moves best evaluation first. A transposition table holds
+// bounds for both sides; adversary nodes only depend on the grid, so they are keyed by its
+// canonical symmetry image when the shape library is closed under rotation and reflection.
+#define ADVERSARY_MAX_DECKS 8
+#define ADVERSARY_DECKS (SHAPE_OPTIONS * (SHAPE_OPTIONS + 1) * (SHAPE_OPTIONS + 2) / 6) // multisets of 3
+
+typedef struct
+{
+    u8 shapes[3];    // the deck, SHAPE_INFO indices
+    u8 placed;       // pieces the player got onto the board before getting stuck, 3 if all
+    u8 order[3];     // shape placed at each step
+    u8 cells[3];     // anchor cell of each step, gy * 8 + gx
+    u64 grid_after;  // board when the deck is done or the player is stuck
+} AdversaryStep;
+
+typedef struct
+{
+    u32 horizon;     // decks searched
+    u32 value;       // decks survived under adversarial play, horizon if never forced
+    bool forced;     // value < horizon: game over is forced within value + 1 decks
+    bool complete;   // false when the node budget ran out
+    AdversaryStep line[ADVERSARY_MAX_DECKS]; // forcing line, value + 1 decks when forced
+    u32 line_decks;
+    u32 forcing_decks; // decks that force game over at once (value 0), counted when asked
+    u64 nodes;
+    u64 table_hits;
+    u64 cutoffs;
+} AdversaryResult;
+
+// 16 bytes, 4 per cache line
+typedef struct
+{
+    u64 grid;
+    u32 info;        // side, remaining deck and depth
+    i8 lower;
+    i8 upper;
+    u8 generation;
+    u8 _pad;
+} AdversaryEntry;
+
+typedef struct
+{
+    AdversaryEntry *table;
+    u64 table_mask;
+    u8 generation;
+    bool canonical;     // library is closed under the 8 symmetries
+
+    u64 node_budget;
+    bool aborted;
+    u64 nodes;
+    u64 table_hits;
+    u64 cutoffs;
+} Adversary;
+
+// table_bits: log2 of the transposition table entries. One per thread, it is not shared.
+Adversary Adversary_Allocation(Arena *arena, u32 table_bits);
+
+// Deepens one deck at a time up to max_decks and stops at the first horizon that forces a
+// game over, so a forced result is the shortest. node_budget 0 is unlimited.
+// count_forcing also counts the decks that end the game at once.
+void Adversary_Search(Adversary *adversary, u64 grid, u32 max_decks, u64 node_budget, bool count_forcing,
+                      AdversaryResult *out_result);
+
+
+#endif /* BG64_ADVERSARY_H_ */
@@ -0,0 +1,328 @@
+#include <string.h>
+#include "bg64_batch.h"
+#include "bg64_board.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// SHAPE_INFO is gathered with a 64 bit stride
+_Static_assert(sizeof(ShapeInfo) % 8 == 0, "ShapeInfo stride must be a multiple of 8 bytes");
+#define SHAPE_INFO_STRIDE ((int)(sizeof(ShapeInfo) / 8))
+
+
+BatchGames Batch_Allocation(Arena *arena, u32 capacity, bool track_colors)
+{
+    // Round to a multiple of 8 so the vector loops never need a masked tail on the arrays,
+    // decks and active get a few bytes of slack for the 32 bit gathers
+    u32 cap = (capacity + 7) & ~7u;
+
+    BatchGames games = {
+        .grids = (u64 *)Arena_PushZero(arena, (usize)cap * sizeof(u64), 64),
+        .scores = (u64 *)Arena_PushZero(arena, (usize)cap * sizeof(u64), 64),
+        .seeds = (u64 *)Arena_PushZero(arena, (usize)cap * sizeof(u64), 64),
+        .decks = (u8 (*)[3])Arena_PushZero(arena, (usize)cap * 3 + 4, 64),
+        .active = (u8 *)Arena_PushZero(arena, (usize)cap + 4, 64),
+        .sources = (u8 *)Arena_PushZero(arena, (usize)cap, 64),
+        .colors = track_colors ? (u8 (*)[32])Arena_PushZero(arena, (usize)cap * 32, 64) : NULL,
+        .piece_sources = (BatchPieceSource *)Arena_PushZero(arena, BATCH_MAX_PIECE_SOURCES * sizeof(BatchPieceSource), 64),
+        .source_count = 1,
+        .count = capacity,
+        .capacity = cap};
+    games.piece_sources[0].distribution = *Pieces_Distribution(PIECE_MODE_CLASSIC);
+
+    return games;
+}
+
+static inline void batch_refill_deck(BatchGames *games, u32 i)
+{
+    Pieces_Fill(&games->piece_sources[games->sources[i]].distribution, &games->seeds[i], games->decks[i], 3);
+    games->active[i] = 0;
+}
+
+// Table entry dealing like state, added when no game of the batch deals like it yet
+static i32 batch_piece_source(BatchGames *games, const GameState *state)
+{
+    u8 mode = state->session.piece_mode < PIECE_MODE_COUNT ? state->session.piece_mode : PIECE_MODE_CLASSIC;
+    u8 weights[16] = { 0 };
+    if (mode == PIECE_MODE_CUSTOM) memcpy(weights, state->grid.piece_weights, sizeof(weights));
+
+    for (u32 k = 0; k < games->source_count; k++) {
+        const BatchPieceSource *source = &games->piece_sources[k];
+        if (source->piece_mode == mode && memcmp(source->piece_weights, weights, sizeof(weights)) == 0) return (i32)k;
+    }
+    if (games->source_count == BATCH_MAX_PIECE_SOURCES) return -1;
+
+    BatchPieceSource *source = &games->piece_sources[games->source_count];
+    source->piece_mode = mode;
+    memcpy(source->piece_weights, weights, sizeof(weights));
+    if (mode == PIECE_MODE_CUSTOM) Pieces_BuildCustom(weights, &source->distribution);
+    else source->distribution = *Pieces_Distribution(mode);
+    return (i32)games->source_count++;
+}
+
+void Batch_Reset(BatchGames *games, u32 index, u64 seed)
+{
+    // Same stream as GameState_Reset: the first three pieces become the deck
+    games->grids[index] = 0;
+    games->scores[index] = 0;
+    games->seeds[index] = seed ? seed : 0xFEED;
+    games->sources[index] = 0;
+    if (games->colors) memset(games->colors[index], 0, 32);
+
+    batch_refill_deck(games, index);
+}
+
+bool Batch_Load(BatchGames *games, u32 index, const GameState *state)
+{
+    i32 source = batch_piece_source(games, state);
+    if (source < 0) return false;
+    games->sources[index] = (u8)source;
+
+    games->grids[index] = state->grid.game_grid;
+    games->scores[index] = state->session.current_score;
+    memcpy(games->decks[index], state->session.deck_shape_color_bits, 3);
+    if (games->colors) memcpy(games->colors[index], state->grid.grid_color, 32);
+
+    u8 active = 0;
+    for (u8 k = 0; k < 3; k++) active |= (u8)(state->session.is_active[k] << k);
+    games->active[index] = active;
+
+    // Rewind the seed past the pieces still waiting in the queue, so the next refill
+    // generates exactly what the ring buffer would have handed out
+    u64 seed = state->utility.rng_seed;
+    for (u8 k = 0; k < state->utility.ring_buffer_counter; k++) xorshift_back(&seed);
+    games->seeds[index] = seed;
+    return true;
+}
+
+void Batch_Store(const BatchGames *games, u32 index, GameState *state)
+{
+    // state must already be initialized (magic, palette), only the game fields are written
+    state->grid.game_grid = games->grids[index];
+    state->session.current_score = games->scores[index];
+    memcpy(state->session.deck_shape_color_bits, games->decks[index], 3);
+    if (games->colors) memcpy(state->grid.grid_color, games->colors[index], 32);
+
+    for (u8 k = 0; k < 3; k++) state->session.is_active[k] = (games->active[index] >> k) & 1;
+
+    // The queue refills from the distribution the game was dealt from
+    const BatchPieceSource *source = &games->piece_sources[games->sources[index]];
+    state->session.piece_mode = source->piece_mode;
+    if (source->piece_mode == PIECE_MODE_CUSTOM) {
+        memcpy(state->grid.piece_weights, source->piece_weights, sizeof(source->piece_weights));
+    }
+
+    state->utility.rng_seed = games->seeds[index];
+    state->utility.ring_buffer_counter = 0;
+    state->utility.ring_buffer_read_index = 0;
+    state->utility.ring_buffer_write_index = 0;
+    fill_queue(state);
+}
+
+// Bookkeeping after the bitboard work: score, active slots, refills and colors
+static inline void batch_finish_lane(BatchGames *games, u32 i, u8 slot, u64 placed, u64 clear, u32 lines)
+{
+    games->scores[i] += lines * 10;
+
+    if (games->colors) {
+        board8_bake_colors(games->colors[i], placed, GET_COLOR(games->decks[i][slot]));
+        if (clear) board8_bake_colors(games->colors[i], clear, 0);
+    }
+
+    games->active[i] |= (u8)(1u << slot);
+    if (games->active[i] == 0x07) batch_refill_deck(games, i);
+}
+
+// Scalar lane, used for tails and builds without AVX2
+static inline u8 batch_step_one(BatchGames *games, u32 i, BatchMove move)
+{
+    if (move.slot > 2 || ((games->active[i] >> move.slot) & 1)) return BATCH_MOVE_ILLEGAL;
+
+    const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(games->decks[i][move.slot])];
+
+    u64 placed;
+    if (!board8_try_place_anchor(games->grids[i], shape, move.gx, move.gy, &placed)) return BATCH_MOVE_ILLEGAL;
+
+    u64 grid = games->grids[i] | placed;
+    u32 lines = 0;
+    u64 clear = board8_full_lines(grid, &lines);
+    games->grids[i] = grid & ~clear;
+
+    batch_finish_lane(games, i, move.slot, placed, clear, lines);
+    return (u8)lines;
+}
+
+#if defined(__AVX2__)
+// Per lane legality from the packed moves, 32 bit lanes: -1 when slot, anchor range and
+// free slot all check out. Also hands back the shape index and anchor bit index.
+static inline __m128i batch_gather_moves(const BatchGames *games, u32 base, __m128i packed,
+                                         __m128i *out_shape, __m128i *out_bit)
+{
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    __m128i slot = _mm_and_si128(packed, byte);
+    __m128i gx = _mm_and_si128(_mm_srli_epi32(packed, 8), byte);
+    __m128i gy = _mm_and_si128(_mm_srli_epi32(packed, 16), byte);
+
+    // Unsigned compares through min: slot <= 2, gx <= 7, gy <= 7 (negative i8 wraps high)
+    __m128i ok = _mm_cmpeq_epi32(_mm_min_epu32(slot, _mm_set1_epi32(2)), slot);
+    ok = _mm_and_si128(ok, _mm_cmpeq_epi32(_mm_min_epu32(gx, _mm_set1_epi32(7)), gx));
+    ok = _mm_and_si128(ok, _mm_cmpeq_epi32(_mm_min_epu32(gy, _mm_set1_epi32(7)), gy));
+    slot = _mm_min_epu32(slot, _mm_set1_epi32(2));
+
+    // Composite byte and active bits, gathered at byte granularity
+    __m128i game = _mm_add_epi32(_mm_set1_epi32((int)base), _mm_setr_epi32(0, 1, 2, 3));
+    __m128i deck_idx = _mm_add_epi32(_mm_add_epi32(game, _mm_add_epi32(game, game)), slot);
+    __m128i composite = _mm_and_si128(_mm_i32gather_epi32((const int *)games->decks, deck_idx, 1), byte);
+    __m128i active = _mm_and_si128(_mm_i32gather_epi32((const int *)games->active, game, 1), byte);
+
+    __m128i slot_taken = _mm_and_si128(_mm_srlv_epi32(active, slot), _mm_set1_epi32(1));
+    ok = _mm_andnot_si128(_mm_cmpeq_epi32(slot_taken, _mm_set1_epi32(1)), ok);
+
+    *out_shape = _mm_and_si128(_mm_srli_epi32(composite, COLOR_BITS), _mm_set1_epi32(0x1F));
+    *out_bit = _mm_and_si128(_mm_add_epi32(_mm_slli_epi32(gy, 3), gx), _mm_set1_epi32(63));
+    return ok;
+}
+
+// Four games: placement, collision and line clears are all 256 bit ops
+static inline u32 batch_step4_avx2(BatchGames *games, const BatchMove *moves, u32 base, u8 *out_lines)
+{
+    __m128i packed = _mm_loadu_si128((const __m128i *)&moves[base]);
+    __m128i shape, bit;
+    __m128i ok32 = batch_gather_moves(games, base, packed, &shape, &bit);
+
+    __m256i bit64 = _mm256_cvtepu32_epi64(bit);
+    __m256i mask = _mm256_i32gather_epi64((const long long *)SHAPE_LIBRARY, shape, 8);
+    __m256i anchors = _mm256_i32gather_epi64((const long long *)&SHAPE_INFO[0].anchors,
+                                             _mm_mullo_epi32(shape, _mm_set1_epi32(SHAPE_INFO_STRIDE)), 8);
+
+    // Anchor legal: bit (63 - bit) of the anchor set, moved to the sign bit
+    __m256i anchor_ok = _mm256_cmpgt_epi64(_mm256_setzero_si256(), _mm256_sllv_epi64(anchors, bit64));
+
+    __m256i grid = _mm256_load_si256((const __m256i *)&games->grids[base]);
+    __m256i shifted = _mm256_srlv_epi64(mask, bit64);
+    __m256i vacant = _mm256_cmpeq_epi64(_mm256_and_si256(grid, shifted), _mm256_setzero_si256());
+
+    __m256i ok = _mm256_and_si256(_mm256_and_si256(anchor_ok, vacant), _mm256_cvtepi32_epi64(ok32));
+    __m256i placed = _mm256_and_si256(shifted, ok);
+    grid = _mm256_or_si256(grid, placed);
+
+    // Full rows are bytes equal to 0xFF
+    __m256i rows = _mm256_cmpeq_epi8(grid, _mm256_set1_epi8(-1));
+
+    // Full columns: AND the 8 bytes of each lane, broadcast the result byte back out
+    __m256i c = _mm256_and_si256(grid, _mm256_srli_epi64(grid, 32));
+    c = _mm256_and_si256(c, _mm256_srli_epi64(c, 16));
+    c = _mm256_and_si256(c, _mm256_srli_epi64(c, 8));
+    __m256i cols = _mm256_shuffle_epi8(c, _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8,
+                                                           0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8));
+    __m256i clear = _mm256_and_si256(_mm256_or_si256(rows, cols), ok);
+    _mm256_store_si256((__m256i *)&games->grids[base], _mm256_andnot_si256(clear, grid));
+
+    u32 row_bits = (u32)_mm256_movemask_epi8(_mm256_and_si256(rows, ok));
+    u32 ok_bits = (u32)_mm256_movemask_pd(_mm256_castsi256_pd(ok));
+    if (!ok_bits) {
+        if (out_lines) memset(&out_lines[base], BATCH_MOVE_ILLEGAL, 4);
+        return 0;
+    }
+
+    alignas(32) u64 placed_lanes[4], clear_lanes[4], col_lanes[4];
+    _mm256_store_si256((__m256i *)placed_lanes, placed);
+    _mm256_store_si256((__m256i *)clear_lanes, clear);
+    _mm256_store_si256((__m256i *)col_lanes, c);
+
+    for (u32 k = 0; k < 4; k++) {
+        if (!((ok_bits >> k) & 1)) {
+            if (out_lines) out_lines[base + k] = BATCH_MOVE_ILLEGAL;
+            continue;
+        }
+
+        u32 lines = (u32)__builtin_popcount((row_bits >> (k * 8)) & 0xFF) + (u32)__builtin_popcount((u32)(col_lanes[k] & 0xFF));
+        batch_finish_lane(games, base + k, moves[base + k].slot, placed_lanes[k], clear_lanes[k], lines);
+        if (out_lines) out_lines[base + k] = (u8)lines;
+    }
+
+    return (u32)__builtin_popcount(ok_bits);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+// Eight games per instruction, mask registers replace the compare vectors
+static inline u32 batch_step8_avx512(BatchGames *games, const BatchMove *moves, u32 base, u8 *out_lines)
+{
+    __m128i shape_lo, bit_lo, shape_hi, bit_hi;
+    __m128i ok_lo = batch_gather_moves(games, base, _mm_loadu_si128((const __m128i *)&moves[base]), &shape_lo, &bit_lo);
+    __m128i ok_hi = batch_gather_moves(games, base + 4, _mm_loadu_si128((const __m128i *)&moves[base + 4]), &shape_hi, &bit_hi);
+
+    __m256i shape = _mm256_set_m128i(shape_hi, shape_lo);
+    __m512i bit64 = _mm512_cvtepu32_epi64(_mm256_set_m128i(bit_hi, bit_lo));
+    __mmask8 ok = (__mmask8)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_set_m128i(ok_hi, ok_lo)));
+
+    __m512i mask = _mm512_i32gather_epi64(shape, (const void *)SHAPE_LIBRARY, 8);
+    __m512i anchors = _mm512_i32gather_epi64(_mm256_mullo_epi32(shape, _mm256_set1_epi32(SHAPE_INFO_STRIDE)),
+                                             (const void *)&SHAPE_INFO[0].anchors, 8);
+
+    ok &= _mm512_cmplt_epi64_mask(_mm512_sllv_epi64(anchors, bit64), _mm512_setzero_si512());
+
+    __m512i grid = _mm512_load_si512((const void *)&games->grids[base]);
+    __m512i shifted = _mm512_srlv_epi64(mask, bit64);
+    ok &= _mm512_testn_epi64_mask(grid, shifted);
+
+    __m512i placed = _mm512_maskz_mov_epi64(ok, shifted);
+    grid = _mm512_or_si512(grid, placed);
+
+    __mmask64 rows = _mm512_cmpeq_epi8_mask(grid, _mm512_set1_epi8(-1));
+
+    __m512i c = _mm512_and_si512(grid, _mm512_srli_epi64(grid, 32));
+    c = _mm512_and_si512(c, _mm512_srli_epi64(c, 16));
+    c = _mm512_and_si512(c, _mm512_srli_epi64(c, 8));
+    __m512i cols = _mm512_shuffle_epi8(c, _mm512_set_epi64(0x0808080808080808ll, 0, 0x0808080808080808ll, 0,
+                                                           0x0808080808080808ll, 0, 0x0808080808080808ll, 0));
+    __m512i clear = _mm512_maskz_mov_epi64(ok, _mm512_or_si512(_mm512_movm_epi8(rows), cols));
+    _mm512_store_si512((void *)&games->grids[base], _mm512_andnot_si512(clear, grid));
+
+    if (!ok) {
+        if (out_lines) memset(&out_lines[base], BATCH_MOVE_ILLEGAL, 8);
+        return 0;
+    }
+
+    alignas(64) u64 placed_lanes[8], clear_lanes[8], col_lanes[8];
+    _mm512_store_si512((void *)placed_lanes, placed);
+    _mm512_store_si512((void *)clear_lanes, clear);
+    _mm512_store_si512((void *)col_lanes, c);
+
+    for (u32 k = 0; k < 8; k++) {
+        if (!((ok >> k) & 1)) {
+            if (out_lines) out_lines[base + k] = BATCH_MOVE_ILLEGAL;
+            continue;
+        }
+
+        u32 lines = (u32)__builtin_popcountll((rows >> (k * 8)) & 0xFF) + (u32)__builtin_popcount((u32)(col_lanes[k] & 0xFF));
+        batch_finish_lane(games, base + k, moves[base + k].slot, placed_lanes[k], clear_lanes[k], lines);
+        if (out_lines) out_lines[base + k] = (u8)lines;
+    }
+
+    return (u32)__builtin_popcount(ok);
+}
+#endif
+
+u32 Batch_Step(BatchGames *games, const BatchMove *moves, u8 *out_lines)
+{
+    u32 accepted = 0;
+    u32 i = 0;
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    for (; i + 8 <= games->count; i += 8) accepted += batch_step8_avx512(games, moves, i, out_lines);
+#endif
+#if defined(__AVX2__)
+    for (; i + 4 <= games->count; i += 4) accepted += batch_step4_avx2(games, moves, i, out_lines);
+#endif
+
+    for (; i < games->count; i++) {
+        u8 lines = batch_step_one(games, i, moves[i]);
+        if (out_lines) out_lines[i] = lines;
+        accepted += (lines != BATCH_MOVE_ILLEGAL);
+    }
+
+    return accepted;
+}
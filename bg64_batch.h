@@ -0,0 +1,65 @@
+#ifndef BG64_BATCH_H_
+#define BG64_BATCH_H_
+
+
+#include "bg64.h"
+#include "bg64_pieces.h"
+
+
+// STRUCT OF ARRAYS BATCH ENGINE
+// Thousands of independent 8x8 games stepped in lockstep, one move per game per step.
+// Every field is its own array so placement, collision and line clears run 4 games per
+// AVX2 instruction (8 with AVX-512); refills and colors fall back to scalar per lane.
+//
+// The deck refills straight from each game's xorshift stream instead of a ring buffer,
+// seeds[i] always points at the next piece, which keeps the piece order identical to
+// a GameState fed through its queue (see Batch_Load / Batch_Store). Every game deals
+// from its own piece mode and custom weights: games share one entry of a small table per
+// distinct distribution, entry 0 being classic.
+#define BATCH_MAX_PIECE_SOURCES 16
+
+typedef struct
+{
+    u8 piece_mode;
+    u8 piece_weights[16];         // as game_grid.piece_weights
+    PieceDistribution distribution;
+} BatchPieceSource;
+
+typedef struct
+{
+    u64 *grids;       // occupancy bitboard per game
+    u64 *scores;
+    u64 *seeds;       // xorshift state that generates the next deck piece
+    u8 (*decks)[3];   // composite bytes per deck slot
+    u8 *active;       // bit i set: deck slot i already placed
+    u8 *sources;      // piece_sources entry the game deals from
+    u8 (*colors)[32]; // nibble colors like game_grid.grid_color, NULL when not tracked
+    BatchPieceSource *piece_sources;
+    u32 source_count;
+    u32 count;        // games in use
+    u32 capacity;
+} BatchGames;
+
+// One move per game, packed in a u32 so a vector register loads 4 or 8 of them
+typedef struct
+{
+    u8 slot;   // deck slot 0..2, anything else is a pass
+    i8 gx;
+    i8 gy;
+    u8 _pad;
+} BatchMove;
+
+#define BATCH_MOVE_ILLEGAL 0xFF // out_lines value for a rejected move
+
+BatchGames Batch_Allocation(Arena *arena, u32 capacity, bool track_colors);
+void Batch_Reset(BatchGames *games, u32 index, u64 seed); // a classic game
+// false: the batch already deals from BATCH_MAX_PIECE_SOURCES other distributions
+bool Batch_Load(BatchGames *games, u32 index, const GameState *state);
+void Batch_Store(const BatchGames *games, u32 index, GameState *state); // mode and weights included
+
+// Applies moves[i] to game i for every game. out_lines (optional) receives the number
+// of rows + columns cleared, or BATCH_MOVE_ILLEGAL. Returns the count of accepted moves.
+u32 Batch_Step(BatchGames *games, const BatchMove *moves, u8 *out_lines);
+
+
+#endif /* BG64_BATCH_H_ */
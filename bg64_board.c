@@ -0,0 +1,164 @@
+#include "bg64_board.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+// 16x16 BOARD
+// Rows are u16 lanes, so a full row is a lane compare against all ones and a full
+// column is the AND of all 16 lanes. With AVX2 the whole board is one register.
+
+// Portable versions, always built so the AVX2 paths have something to be checked against
+
+bool board16_try_place_scalar(const Board16 *board, const ShapeInfo *shape, int gx, int gy, Board16 *out_mask)
+{
+    if (gx < 0 || gy < 0 || shape->cells == 0) return false;
+
+    u8 h = shape->height;
+    if (gx + shape->width > 16 || gy + h > 16) return false;
+
+    // Drop the shape rows into their lanes, the column shift is per lane
+    Board16 shifted = {0};
+    for (int i = 0; i < h; i++) {
+        u16 row = (u16)((shape->mask >> (56 - i * 8)) & 0xFF) << 8;
+        shifted.row[gy + i] = row >> gx;
+        if (board->row[gy + i] & shifted.row[gy + i]) return false;
+    }
+
+    *out_mask = shifted;
+    return true;
+}
+
+void board16_place_scalar(Board16 *board, const Board16 *mask)
+{
+    for (int i = 0; i < 16; i++) board->row[i] |= mask->row[i];
+}
+
+u32 board16_full_lines_scalar(const Board16 *board, Board16 *out_clear_mask)
+{
+    u16 col_flags = 0xFFFF;
+    u32 row_count = 0;
+    for (int i = 0; i < 16; i++) {
+        col_flags &= board->row[i];
+        row_count += (board->row[i] == 0xFFFF);
+    }
+
+    if (out_clear_mask) {
+        for (int i = 0; i < 16; i++) {
+            out_clear_mask->row[i] = (board->row[i] == 0xFFFF) ? 0xFFFF : col_flags;
+        }
+    }
+
+    return row_count + (u32)__builtin_popcount(col_flags);
+}
+
+u32 board16_clear_lines_scalar(Board16 *board, u8 *colors, Board16 *out_clear_mask)
+{
+    Board16 clear;
+    u32 lines = board16_full_lines_scalar(board, &clear);
+
+    if (lines) {
+        for (int i = 0; i < 16; i++) board->row[i] &= ~clear.row[i];
+        if (colors) board16_bake_colors(colors, &clear, 0);
+    }
+
+    if (out_clear_mask) *out_clear_mask = clear;
+    return lines;
+}
+
+
+bool board16_try_place(const Board16 *board, const ShapeInfo *shape, int gx, int gy, Board16 *out_mask)
+{
+#if defined(__AVX2__)
+    if (gx < 0 || gy < 0 || shape->cells == 0) return false;
+
+    u8 h = shape->height;
+    if (gx + shape->width > 16 || gy + h > 16) return false;
+
+    Board16 shifted = {0};
+    for (int i = 0; i < h; i++) {
+        u16 row = (u16)((shape->mask >> (56 - i * 8)) & 0xFF) << 8;
+        shifted.row[gy + i] = row >> gx;
+    }
+
+    __m256i b = _mm256_load_si256((const __m256i *)board->row);
+    __m256i s = _mm256_load_si256((const __m256i *)shifted.row);
+    if (!_mm256_testz_si256(b, s)) return false;
+
+    *out_mask = shifted;
+    return true;
+#else
+    return board16_try_place_scalar(board, shape, gx, gy, out_mask);
+#endif
+}
+
+void board16_place(Board16 *board, const Board16 *mask)
+{
+#if defined(__AVX2__)
+    __m256i b = _mm256_load_si256((const __m256i *)board->row);
+    __m256i m = _mm256_load_si256((const __m256i *)mask->row);
+    _mm256_store_si256((__m256i *)board->row, _mm256_or_si256(b, m));
+#else
+    board16_place_scalar(board, mask);
+#endif
+}
+
+u32 board16_full_lines(const Board16 *board, Board16 *out_clear_mask)
+{
+#if defined(__AVX2__)
+    __m256i b = _mm256_load_si256((const __m256i *)board->row);
+    __m256i ones = _mm256_set1_epi16(-1);
+
+    // Full rows: lanes equal to 0xFFFF
+    __m256i rows = _mm256_cmpeq_epi16(b, ones);
+
+    // Full columns: AND reduce the 16 lanes, result broadcast back to every lane
+    __m256i c = _mm256_and_si256(b, _mm256_permute2x128_si256(b, b, 0x01));
+    c = _mm256_and_si256(c, _mm256_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2)));
+    c = _mm256_and_si256(c, _mm256_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+    c = _mm256_and_si256(c, _mm256_shufflelo_epi16(_mm256_shufflehi_epi16(c, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
+
+    u16 col_flags = (u16)_mm256_extract_epi16(c, 0);
+    u32 row_count = (u32)__builtin_popcount((u32)_mm256_movemask_epi8(rows)) >> 1;
+
+    if (out_clear_mask) _mm256_store_si256((__m256i *)out_clear_mask->row, _mm256_or_si256(rows, c));
+
+    return row_count + (u32)__builtin_popcount(col_flags);
+#else
+    return board16_full_lines_scalar(board, out_clear_mask);
+#endif
+}
+
+void board16_bake_colors(u8 *colors, const Board16 *mask, u8 color)
+{
+    for (int y = 0; y < 16; y++) {
+        u32 bits = mask->row[y];
+        while (bits) {
+            // bit 15 is column 0
+            u32 x = 15 - (u32)__builtin_ctz(bits);
+            color_nibble_set(colors, (u32)y * 16 + x, color);
+            bits &= bits - 1;
+        }
+    }
+}
+
+u32 board16_clear_lines(Board16 *board, u8 *colors, Board16 *out_clear_mask)
+{
+#if defined(__AVX2__)
+    Board16 clear;
+    u32 lines = board16_full_lines(board, &clear);
+
+    if (lines) {
+        __m256i b = _mm256_load_si256((const __m256i *)board->row);
+        __m256i c = _mm256_load_si256((const __m256i *)clear.row);
+        _mm256_store_si256((__m256i *)board->row, _mm256_andnot_si256(c, b));
+        if (colors) board16_bake_colors(colors, &clear, 0);
+    }
+
+    if (out_clear_mask) *out_clear_mask = clear;
+    return lines;
+#else
+    return board16_clear_lines_scalar(board, colors, out_clear_mask);
+#endif
+}
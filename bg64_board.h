@@ -0,0 +1,249 @@
+#ifndef BG64_BOARD_H_
+#define BG64_BOARD_H_
+
+
+#include "bg64.h"
+#include "bg64_symmetry.h"
+
+
+// BOARD SIZE PARAMETERIZED CORE
+// Every board size uses the same "big endian" bit layout the 8x8 grid uses:
+// cell (x, y) lives at bit (CELLS - 1) - (y * DIM + x), so the top left cell is
+// the highest bit and a shape anchored at the top left is moved with one right shift.
+//
+// 8x8   -> Board8,  a single u64 (the original BG64 fast path)
+// 10x10 -> Board10, a u128 with the top 28 bits unused
+// 16x16 -> Board16, 16 u16 rows packed into one 256 bit AVX2 register
+//
+// Shapes always come in as SHAPE_INFO entries and their 8x8 masks are widened per board.
+
+
+// Bit helpers for the 128 bit word
+static inline u32 u128_popcount(u128 x)
+{
+    return (u32)__builtin_popcountll((u64)x) + (u32)__builtin_popcountll((u64)(x >> 64));
+}
+
+static inline u32 u128_ctz(u128 x)
+{
+    u64 lo = (u64)x;
+    return lo ? (u32)__builtin_ctzll(lo) : 64 + (u32)__builtin_ctzll((u64)(x >> 64));
+}
+
+static inline u32 u64_popcount(u64 x) { return (u32)__builtin_popcountll(x); }
+static inline u32 u64_ctz(u64 x) { return (u32)__builtin_ctzll(x); }
+
+
+// Colors are always nibble packed in cell order, even cell in the high nibble
+static inline void color_nibble_set(u8 *colors, u32 cell, u8 color)
+{
+    u8 shift = (cell & 1) ? 0 : 4;
+    colors[cell >> 1] = (u8)((colors[cell >> 1] & ~(0x0F << shift)) | ((color & 0x0F) << shift));
+}
+
+static inline u8 color_nibble_get(const u8 *colors, u32 cell)
+{
+    return (cell & 1) ? (colors[cell >> 1] & 0x0F) : (colors[cell >> 1] >> 4);
+}
+
+
+// Generates a scalar bitboard of DIM x DIM cells on an integer WORD.
+// Line detection is SWAR: a run AND along each row (stride 1) or column (stride DIM)
+// leaves one flag bit per full line, which is then smeared back out with a multiply.
+#define BG64_DEFINE_BOARD(TYPE, PREFIX, DIM, WORD, POPCOUNT, CTZ)                         \
+    typedef WORD TYPE;                                                                     \
+                                                                                           \
+    enum { PREFIX##_DIM = (DIM), PREFIX##_CELLS = (DIM) * (DIM) };                         \
+                                                                                           \
+    static inline WORD PREFIX##_bit(int x, int y)                                          \
+    {                                                                                      \
+        return (WORD)1 << (PREFIX##_CELLS - 1 - (y * (DIM) + x));                          \
+    }                                                                                      \
+                                                                                           \
+    /* One bit per row: the lowest bit of every row (also the rightmost column) */         \
+    static inline WORD PREFIX##_row_lsbs(void)                                             \
+    {                                                                                      \
+        WORD m = 0;                                                                        \
+        for (int k = 0; k < (DIM); k++) m |= (WORD)1 << (k * (DIM));                       \
+        return m;                                                                          \
+    }                                                                                      \
+                                                                                           \
+    static inline WORD PREFIX##_line_bits(void) { return ((WORD)1 << (DIM)) - 1; }         \
+                                                                                           \
+    static inline WORD PREFIX##_row_mask(int y)                                            \
+    {                                                                                      \
+        return PREFIX##_line_bits() << ((DIM) * ((DIM) - 1 - y));                          \
+    }                                                                                      \
+                                                                                           \
+    static inline WORD PREFIX##_col_mask(int x)                                            \
+    {                                                                                      \
+        return PREFIX##_row_lsbs() << ((DIM) - 1 - x);                                     \
+    }                                                                                      \
+                                                                                           \
+    /* AND of DIM consecutive bits spaced by stride, in log2(DIM) steps */                 \
+    static inline WORD PREFIX##_run_and(WORD b, u32 stride)                                \
+    {                                                                                      \
+        WORD t = b;                                                                        \
+        u32 run = 1;                                                                       \
+        while (run * 2 <= (DIM)) { t &= t >> (run * stride); run *= 2; }                   \
+        if (run < (DIM)) t &= t >> (((DIM) - run) * stride);                               \
+        return t;                                                                          \
+    }                                                                                      \
+                                                                                           \
+    /* Widen an 8x8 top left shape mask to this board's row pitch */                       \
+    static inline WORD PREFIX##_expand_shape(u64 shape_mask)                               \
+    {                                                                                      \
+        if ((DIM) == 8) return (WORD)shape_mask;                                           \
+        WORD out = 0;                                                                      \
+        for (int i = 0; i < 8; i++) {                                                      \
+            u8 row = (u8)(shape_mask >> (56 - i * 8));                                     \
+            if (row) out |= (WORD)row << (PREFIX##_CELLS - (DIM) * i - 8);                 \
+        }                                                                                  \
+        return out;                                                                        \
+    }                                                                                      \
+                                                                                           \
+    static inline bool PREFIX##_try_place(WORD board, const ShapeInfo *shape, int gx,      \
+                                          int gy, WORD *out_mask)                          \
+    {                                                                                      \
+        if (gx < 0 || gy < 0 || shape->cells == 0) return false;                           \
+        if (gx + shape->width > (DIM) || gy + shape->height > (DIM)) return false;         \
+                                                                                           \
+        WORD shifted = PREFIX##_expand_shape(shape->mask) >> (gy * (DIM) + gx);            \
+        if (board & shifted) return false;                                                 \
+                                                                                           \
+        *out_mask = shifted;                                                               \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* Mask of every cell on a full row or column, lines gets the line count */            \
+    static inline WORD PREFIX##_full_lines(WORD board, u32 *lines)                         \
+    {                                                                                      \
+        WORD row_flags = PREFIX##_run_and(board, 1) & PREFIX##_row_lsbs();                 \
+        WORD col_flags = PREFIX##_run_and(board, (DIM)) & PREFIX##_line_bits();            \
+                                                                                           \
+        if (lines) *lines = POPCOUNT(row_flags) + POPCOUNT(col_flags);                     \
+                                                                                           \
+        return (row_flags * PREFIX##_line_bits()) | (col_flags * PREFIX##_row_lsbs());     \
+    }                                                                                      \
+                                                                                           \
+    static inline void PREFIX##_bake_colors(u8 *colors, WORD mask, u8 color)               \
+    {                                                                                      \
+        while (mask) {                                                                     \
+            color_nibble_set(colors, PREFIX##_CELLS - 1 - CTZ(mask), color);               \
+            mask &= mask - 1;                                                              \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    /* Clears every full line from the board and its colors, returns the lines count */    \
+    static inline u32 PREFIX##_clear_lines(WORD *board, u8 *colors, WORD *out_clear_mask)  \
+    {                                                                                      \
+        u32 lines = 0;                                                                     \
+        WORD clear = PREFIX##_full_lines(*board, &lines);                                  \
+        if (clear) {                                                                       \
+            *board &= ~clear;                                                              \
+            if (colors) PREFIX##_bake_colors(colors, clear, 0);                            \
+        }                                                                                  \
+        if (out_clear_mask) *out_clear_mask = clear;                                       \
+        return lines;                                                                      \
+    }
+
+
+BG64_DEFINE_BOARD(Board8, board8, 8, u64, u64_popcount, u64_ctz)
+BG64_DEFINE_BOARD(Board10, board10, 10, u128, u128_popcount, u128_ctz)
+
+
+// 8x8 fast path: one bit test against the shape's precomputed anchor set
+static inline bool board8_try_place_anchor(u64 board, const ShapeInfo *shape, int gx, int gy, u64 *out_mask)
+{
+    if ((u32)gx >= 8 || (u32)gy >= 8) return false;
+
+    u32 bit = (u32)(gy * 8 + gx);
+    if (!((shape->anchors >> (63 - bit)) & 1)) return false;
+
+    u64 shifted = shape->mask >> bit;
+    if (board & shifted) return false;
+
+    *out_mask = shifted;
+    return true;
+}
+
+
+// 8x8 with a transposed copy kept alongside: row k of `transposed` is column k of `grid`
+// (bit 7 of the byte is row 0). Columns then are bytes like rows are, full columns are
+// byte compares and column tables index the bytes directly. Placements update the copy
+// with the shape's transposed mask, anchored at (gy, gx), so it is only transposed once.
+// GameState does not keep one: ApplyMove already finds full columns in one SWAR pass, the
+// kept copy saves it 1-2 ns of a ~65 ns move, and every writer of game_grid (symmetry,
+// batch, replay, loading, the tools) would have to keep it in step. Searches that expand
+// many children from one parent build a Board8T locally, as Eval_LineSuccessors does.
+typedef struct
+{
+    u64 grid;
+    u64 transposed;
+} Board8T;
+
+static inline Board8T board8t_from_grid(u64 grid)
+{
+    return (Board8T){ grid, grid_transpose(grid) };
+}
+
+// Row flags at the low bit of every full byte, moved to the column bits they stand for in
+// the other orientation: flag 8j lands on bit 56 + j in one multiply, then fills the column.
+static inline u64 board8t_flags_to_columns(u64 flags)
+{
+    return ((flags * 0x0102040810204080ULL) >> 56) * 0x0101010101010101ULL;
+}
+
+static inline bool board8t_try_place_anchor(Board8T board, const ShapeInfo *shape, int gx, int gy, Board8T *out_mask)
+{
+    u64 mask;
+    if (!board8_try_place_anchor(board.grid, shape, gx, gy, &mask)) return false;
+
+    *out_mask = (Board8T){ mask, shape->transposed >> (gx * 8 + gy) };
+    return true;
+}
+
+// Full rows and full columns as byte compares on each copy, returns both clear masks
+static inline Board8T board8t_full_lines(Board8T board, u32 *lines)
+{
+    u64 rows = board8_run_and(board.grid, 1) & board8_row_lsbs();
+    u64 cols = board8_run_and(board.transposed, 1) & board8_row_lsbs();
+
+    if (lines) *lines = u64_popcount(rows) + u64_popcount(cols);
+
+    return (Board8T){ rows * 0xFF | board8t_flags_to_columns(cols), cols * 0xFF | board8t_flags_to_columns(rows) };
+}
+
+static inline u32 board8t_place_and_clear(Board8T *board, Board8T mask)
+{
+    u32 lines;
+    Board8T placed = { board->grid | mask.grid, board->transposed | mask.transposed };
+    Board8T clear = board8t_full_lines(placed, &lines);
+    *board = (Board8T){ placed.grid & ~clear.grid, placed.transposed & ~clear.transposed };
+    return lines;
+}
+
+
+// 16x16: one u16 per row, bit 15 is column 0. 32 byte aligned so it loads as one __m256i.
+typedef struct
+{
+    alignas(32) u16 row[16];
+} Board16;
+
+enum { board16_DIM = 16, board16_CELLS = 256 };
+
+bool board16_try_place(const Board16 *board, const ShapeInfo *shape, int gx, int gy, Board16 *out_mask);
+void board16_place(Board16 *board, const Board16 *mask);
+u32 board16_full_lines(const Board16 *board, Board16 *out_clear_mask);
+void board16_bake_colors(u8 *colors, const Board16 *mask, u8 color);
+u32 board16_clear_lines(Board16 *board, u8 *colors, Board16 *out_clear_mask);
+
+// The same without AVX2, built either way: the build without AVX2 uses them and
+// tools/oracle checks both against a cell by cell reference
+bool board16_try_place_scalar(const Board16 *board, const ShapeInfo *shape, int gx, int gy, Board16 *out_mask);
+void board16_place_scalar(Board16 *board, const Board16 *mask);
+u32 board16_full_lines_scalar(const Board16 *board, Board16 *out_clear_mask);
+u32 board16_clear_lines_scalar(Board16 *board, u8 *colors, Board16 *out_clear_mask);
+
+
+#endif /* BG64_BOARD_H_ */
@@ -0,0 +1,571 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "bg64_eval.h"
+#include "bg64_board.h"
+#include "bg64_movegen.h"
+#include "bg64_symmetry.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+const char *EVAL_FEATURE_NAMES[EVAL_FEATURE_COUNT] = {
+    "empty", "holes", "near_rows", "near_cols", "perimeter", "max_rect"
+};
+
+// Hand tuned starting point, tools/tune replaces these with a weights file
+const EvalWeights EVAL_DEFAULT_WEIGHTS = {{
+    [EVAL_EMPTY] = 1.0f,
+    [EVAL_HOLES] = -3.0f,
+    [EVAL_NEAR_ROWS] = 0.5f,
+    [EVAL_NEAR_COLS] = 0.5f,
+    [EVAL_PERIMETER] = -0.25f,
+    [EVAL_MAX_RECT] = 0.25f,
+}};
+
+
+#define EDGE_TOP    0xFF00000000000000ULL
+#define EDGE_BOTTOM 0x00000000000000FFULL
+#define EDGE_LEFT   0x8080808080808080ULL
+#define EDGE_RIGHT  0x0101010101010101ULL
+
+#define BYTES_01 0x0101010101010101ULL
+#define BYTES_7F 0x7F7F7F7F7F7F7F7FULL
+#define BYTES_80 0x8080808080808080ULL
+
+// Rows of the board with exactly 7 filled cells: per byte popcount, then a per byte == 7
+static inline u32 near_full_rows(u64 g)
+{
+    u64 c = g - ((g >> 1) & 0x5555555555555555ULL);
+    c = (c & 0x3333333333333333ULL) + ((c >> 2) & 0x3333333333333333ULL);
+    c = (c + (c >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    // Exact zero byte test (no borrow between bytes)
+    u64 t = c ^ (7 * BYTES_01);
+    u64 zero = ~(((t & BYTES_7F) + BYTES_7F) | t) & BYTES_80;
+    return u64_popcount(zero);
+}
+
+// Area of the largest empty w x h rectangle. runs[w - 1] holds the anchors that start a
+// w wide empty run; its tallest stack of runs is found by composing 8, 4, 2 and 1 row
+// run-ands greedily, which needs no loop over the rows.
+static inline u32 max_empty_rect(u64 e)
+{
+    u64 runs[8];
+    u64 run = e;
+    for (u32 w = 1; w <= 8; w++) {
+        runs[w - 1] = run;
+        // Anchors in the last w columns would wrap into the next row
+        run &= (e << w) & ~(EDGE_RIGHT * ((1u << w) - 1));
+    }
+
+    u32 best = 0;
+    for (u32 w = 1; w <= 8; w++) {
+        u64 r1 = runs[w - 1];
+        u64 r2 = r1 & (r1 << 8);
+        u64 r4 = r2 & (r2 << 16);
+        u64 r8 = r4 & (r4 << 32);
+
+        // acc: anchors whose stack is at least h rows tall
+        u32 h = 0;
+        u64 acc = ~0ULL;
+        if (r4) { acc = r4; h = 4; }
+        u64 t = acc & (r2 << (8 * h));
+        if (t) { acc = t; h += 2; }
+        t = acc & (r1 << (8 * h));
+        if (t) h += 1;
+        if (r8) h = 8;
+
+        u32 area = w * h;
+        best = area > best ? area : best;
+    }
+
+    return best;
+}
+
+void Eval_Features(u64 g, EvalFeatures *out)
+{
+    u64 e = ~g;
+
+    // Walls count as filled neighbours
+    u64 up = (g >> 8) | EDGE_TOP;
+    u64 down = (g << 8) | EDGE_BOTTOM;
+    u64 left = (g >> 1) | EDGE_LEFT;
+    u64 right = (g << 1) | EDGE_RIGHT;
+
+    u64 horizontal_edges = (g ^ (g >> 1)) & ~EDGE_LEFT;
+    u64 vertical_edges = (g ^ (g >> 8)) & ~EDGE_TOP;
+
+    *out = (EvalFeatures){{
+        [EVAL_EMPTY] = (f32)u64_popcount(e),
+        [EVAL_HOLES] = (f32)u64_popcount(e & up & down & left & right),
+        [EVAL_NEAR_ROWS] = (f32)near_full_rows(g),
+        [EVAL_NEAR_COLS] = (f32)near_full_rows(grid_transpose(g)),
+        [EVAL_PERIMETER] = (f32)(u64_popcount(horizontal_edges) + u64_popcount(vertical_edges)),
+        [EVAL_MAX_RECT] = (f32)max_empty_rect(e),
+    }};
+}
+
+static inline f32 eval_dot(const EvalWeights *weights, const EvalFeatures *features)
+{
+    // Fixed 8 wide, compiles to a single vector multiply and horizontal add
+    f32 sum = 0;
+    for (u32 i = 0; i < EVAL_FEATURE_SLOTS; i++) sum += weights->w[i] * features->f[i];
+    return sum;
+}
+
+f32 Eval_Score(const EvalWeights *weights, u64 grid)
+{
+    EvalFeatures features;
+    Eval_Features(grid, &features);
+    return eval_dot(weights, &features);
+}
+
+#if defined(__AVX2__)
+// Four boards per 256 bit register, the same shift-and kernel lane by lane. AVX2 has no
+// 64 bit popcount so bytes are counted through a nibble table and summed with psadbw.
+static inline __m256i popcount_bytes4(__m256i v)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi64(v, 4), nibble));
+    return _mm256_add_epi8(lo, hi);
+}
+
+static inline __m256i popcount4(__m256i v)
+{
+    return _mm256_sad_epu8(popcount_bytes4(v), _mm256_setzero_si256());
+}
+
+static inline __m256i near_full_rows4(__m256i g)
+{
+    __m256i seven = _mm256_cmpeq_epi8(popcount_bytes4(g), _mm256_set1_epi8(7));
+    return _mm256_sad_epu8(_mm256_and_si256(seven, _mm256_set1_epi8(1)), _mm256_setzero_si256());
+}
+
+// grid_transpose, lane wise
+static inline __m256i transpose4(__m256i g)
+{
+    __m256i t;
+    t = _mm256_and_si256(_mm256_set1_epi64x(0x0F0F0F0F00000000LL), _mm256_xor_si256(g, _mm256_slli_epi64(g, 28)));
+    g = _mm256_xor_si256(g, _mm256_xor_si256(t, _mm256_srli_epi64(t, 28)));
+    t = _mm256_and_si256(_mm256_set1_epi64x(0x3333000033330000LL), _mm256_xor_si256(g, _mm256_slli_epi64(g, 14)));
+    g = _mm256_xor_si256(g, _mm256_xor_si256(t, _mm256_srli_epi64(t, 14)));
+    t = _mm256_and_si256(_mm256_set1_epi64x(0x5500550055005500LL), _mm256_xor_si256(g, _mm256_slli_epi64(g, 7)));
+    g = _mm256_xor_si256(g, _mm256_xor_si256(t, _mm256_srli_epi64(t, 7)));
+    return g;
+}
+
+// max_empty_rect with the greedy 4, 2, 1 composition done through per lane shifts and blends
+static inline __m256i max_empty_rect4(__m256i e)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i best = zero;
+    __m256i run = e;
+
+    for (u32 w = 1; w <= 8; w++) {
+        __m256i r1 = run;
+        __m256i wrap = _mm256_set1_epi64x((long long)(EDGE_RIGHT * ((1u << w) - 1)));
+        run = _mm256_and_si256(run, _mm256_andnot_si256(wrap, _mm256_sll_epi64(e, _mm_cvtsi32_si128((int)w))));
+
+        __m256i r2 = _mm256_and_si256(r1, _mm256_slli_epi64(r1, 8));
+        __m256i r4 = _mm256_and_si256(r2, _mm256_slli_epi64(r2, 16));
+        __m256i r8 = _mm256_and_si256(r4, _mm256_slli_epi64(r4, 32));
+
+        __m256i none = _mm256_cmpeq_epi64(r4, zero);
+        __m256i acc = _mm256_or_si256(r4, none);
+        __m256i h = _mm256_andnot_si256(none, _mm256_set1_epi64x(4));
+
+        __m256i t = _mm256_and_si256(acc, _mm256_sllv_epi64(r2, _mm256_slli_epi64(h, 3)));
+        none = _mm256_cmpeq_epi64(t, zero);
+        acc = _mm256_blendv_epi8(t, acc, none);
+        h = _mm256_add_epi64(h, _mm256_andnot_si256(none, _mm256_set1_epi64x(2)));
+
+        t = _mm256_and_si256(acc, _mm256_sllv_epi64(r1, _mm256_slli_epi64(h, 3)));
+        h = _mm256_add_epi64(h, _mm256_andnot_si256(_mm256_cmpeq_epi64(t, zero), _mm256_set1_epi64x(1)));
+        h = _mm256_blendv_epi8(_mm256_set1_epi64x(8), h, _mm256_cmpeq_epi64(r8, zero));
+
+        best = _mm256_max_epu32(best, _mm256_mul_epu32(h, _mm256_set1_epi64x(w)));
+    }
+
+    return best;
+}
+
+static inline void eval4_avx2(const EvalWeights *weights, const u64 *grids, f32 *out_scores)
+{
+    __m256i g = _mm256_loadu_si256((const __m256i *)grids);
+    __m256i e = _mm256_xor_si256(g, _mm256_set1_epi64x(-1));
+
+    __m256i up = _mm256_or_si256(_mm256_srli_epi64(g, 8), _mm256_set1_epi64x((long long)EDGE_TOP));
+    __m256i down = _mm256_or_si256(_mm256_slli_epi64(g, 8), _mm256_set1_epi64x((long long)EDGE_BOTTOM));
+    __m256i left = _mm256_or_si256(_mm256_srli_epi64(g, 1), _mm256_set1_epi64x((long long)EDGE_LEFT));
+    __m256i right = _mm256_or_si256(_mm256_slli_epi64(g, 1), _mm256_set1_epi64x((long long)EDGE_RIGHT));
+    __m256i holes = _mm256_and_si256(_mm256_and_si256(e, up), _mm256_and_si256(_mm256_and_si256(down, left), right));
+
+    __m256i horizontal_edges = _mm256_andnot_si256(_mm256_set1_epi64x((long long)EDGE_LEFT), _mm256_xor_si256(g, _mm256_srli_epi64(g, 1)));
+    __m256i vertical_edges = _mm256_andnot_si256(_mm256_set1_epi64x((long long)EDGE_TOP), _mm256_xor_si256(g, _mm256_srli_epi64(g, 8)));
+
+    __m256i features[EVAL_FEATURE_COUNT] = {
+        [EVAL_EMPTY] = popcount4(e),
+        [EVAL_HOLES] = popcount4(holes),
+        [EVAL_NEAR_ROWS] = near_full_rows4(g),
+        [EVAL_NEAR_COLS] = near_full_rows4(transpose4(g)),
+        [EVAL_PERIMETER] = _mm256_add_epi64(popcount4(horizontal_edges), popcount4(vertical_edges)),
+        [EVAL_MAX_RECT] = max_empty_rect4(e),
+    };
+
+    // Counts fit the low dword of each lane, pack them down and convert to f32
+    const __m256i low_dwords = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    __m128 score = _mm_setzero_ps();
+    for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) {
+        __m128 value = _mm_cvtepi32_ps(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(features[f], low_dwords)));
+        score = _mm_add_ps(score, _mm_mul_ps(_mm_set1_ps(weights->w[f]), value));
+    }
+    _mm_storeu_ps(out_scores, score);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+// Eight boards per 512 bit register, mask registers replace the compare vectors
+static inline __m512i popcount_bytes8(__m512i v)
+{
+    const __m512i lut = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(v, nibble));
+    __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi64(v, 4), nibble));
+    return _mm512_add_epi8(lo, hi);
+}
+
+static inline __m512i popcount8(__m512i v)
+{
+    return _mm512_sad_epu8(popcount_bytes8(v), _mm512_setzero_si512());
+}
+
+static inline __m512i near_full_rows8(__m512i g)
+{
+    __mmask64 seven = _mm512_cmpeq_epi8_mask(popcount_bytes8(g), _mm512_set1_epi8(7));
+    return _mm512_sad_epu8(_mm512_maskz_mov_epi8(seven, _mm512_set1_epi8(1)), _mm512_setzero_si512());
+}
+
+static inline __m512i transpose8(__m512i g)
+{
+    __m512i t;
+    t = _mm512_and_si512(_mm512_set1_epi64(0x0F0F0F0F00000000LL), _mm512_xor_si512(g, _mm512_slli_epi64(g, 28)));
+    g = _mm512_xor_si512(g, _mm512_xor_si512(t, _mm512_srli_epi64(t, 28)));
+    t = _mm512_and_si512(_mm512_set1_epi64(0x3333000033330000LL), _mm512_xor_si512(g, _mm512_slli_epi64(g, 14)));
+    g = _mm512_xor_si512(g, _mm512_xor_si512(t, _mm512_srli_epi64(t, 14)));
+    t = _mm512_and_si512(_mm512_set1_epi64(0x5500550055005500LL), _mm512_xor_si512(g, _mm512_slli_epi64(g, 7)));
+    g = _mm512_xor_si512(g, _mm512_xor_si512(t, _mm512_srli_epi64(t, 7)));
+    return g;
+}
+
+static inline __m512i max_empty_rect8(__m512i e)
+{
+    __m512i best = _mm512_setzero_si512();
+    __m512i run = e;
+
+    for (u32 w = 1; w <= 8; w++) {
+        __m512i r1 = run;
+        __m512i wrap = _mm512_set1_epi64((long long)(EDGE_RIGHT * ((1u << w) - 1)));
+        run = _mm512_and_si512(run, _mm512_andnot_si512(wrap, _mm512_sll_epi64(e, _mm_cvtsi32_si128((int)w))));
+
+        __m512i r2 = _mm512_and_si512(r1, _mm512_slli_epi64(r1, 8));
+        __m512i r4 = _mm512_and_si512(r2, _mm512_slli_epi64(r2, 16));
+        __m512i r8 = _mm512_and_si512(r4, _mm512_slli_epi64(r4, 32));
+
+        __mmask8 some = _mm512_test_epi64_mask(r4, r4);
+        __m512i acc = _mm512_mask_mov_epi64(_mm512_set1_epi64(-1), some, r4);
+        __m512i h = _mm512_maskz_mov_epi64(some, _mm512_set1_epi64(4));
+
+        __m512i t = _mm512_and_si512(acc, _mm512_sllv_epi64(r2, _mm512_slli_epi64(h, 3)));
+        some = _mm512_test_epi64_mask(t, t);
+        acc = _mm512_mask_mov_epi64(acc, some, t);
+        h = _mm512_mask_add_epi64(h, some, h, _mm512_set1_epi64(2));
+
+        t = _mm512_and_si512(acc, _mm512_sllv_epi64(r1, _mm512_slli_epi64(h, 3)));
+        h = _mm512_mask_add_epi64(h, _mm512_test_epi64_mask(t, t), h, _mm512_set1_epi64(1));
+        h = _mm512_mask_mov_epi64(h, _mm512_test_epi64_mask(r8, r8), _mm512_set1_epi64(8));
+
+        best = _mm512_max_epu32(best, _mm512_mul_epu32(h, _mm512_set1_epi64(w)));
+    }
+
+    return best;
+}
+
+static inline void eval8_avx512(const EvalWeights *weights, const u64 *grids, f32 *out_scores)
+{
+    __m512i g = _mm512_loadu_si512((const void *)grids);
+    __m512i e = _mm512_xor_si512(g, _mm512_set1_epi64(-1));
+
+    __m512i up = _mm512_or_si512(_mm512_srli_epi64(g, 8), _mm512_set1_epi64((long long)EDGE_TOP));
+    __m512i down = _mm512_or_si512(_mm512_slli_epi64(g, 8), _mm512_set1_epi64((long long)EDGE_BOTTOM));
+    __m512i left = _mm512_or_si512(_mm512_srli_epi64(g, 1), _mm512_set1_epi64((long long)EDGE_LEFT));
+    __m512i right = _mm512_or_si512(_mm512_slli_epi64(g, 1), _mm512_set1_epi64((long long)EDGE_RIGHT));
+    __m512i holes = _mm512_and_si512(_mm512_and_si512(e, up), _mm512_and_si512(_mm512_and_si512(down, left), right));
+
+    __m512i horizontal_edges = _mm512_andnot_si512(_mm512_set1_epi64((long long)EDGE_LEFT), _mm512_xor_si512(g, _mm512_srli_epi64(g, 1)));
+    __m512i vertical_edges = _mm512_andnot_si512(_mm512_set1_epi64((long long)EDGE_TOP), _mm512_xor_si512(g, _mm512_srli_epi64(g, 8)));
+
+    __m512i features[EVAL_FEATURE_COUNT] = {
+        [EVAL_EMPTY] = popcount8(e),
+        [EVAL_HOLES] = popcount8(holes),
+        [EVAL_NEAR_ROWS] = near_full_rows8(g),
+        [EVAL_NEAR_COLS] = near_full_rows8(transpose8(g)),
+        [EVAL_PERIMETER] = _mm512_add_epi64(popcount8(horizontal_edges), popcount8(vertical_edges)),
+        [EVAL_MAX_RECT] = max_empty_rect8(e),
+    };
+
+    __m256 score = _mm256_setzero_ps();
+    for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) {
+        __m256 value = _mm256_cvtepi32_ps(_mm512_cvtepi64_epi32(features[f]));
+        score = _mm256_add_ps(score, _mm256_mul_ps(_mm256_set1_ps(weights->w[f]), value));
+    }
+    _mm256_storeu_ps(out_scores, score);
+}
+#endif
+
+void Eval_ScoreBatch(const EvalWeights *weights, const u64 *grids, u32 count, f32 *out_scores)
+{
+    u32 i = 0;
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    for (; i + 8 <= count; i += 8) eval8_avx512(weights, &grids[i], &out_scores[i]);
+#endif
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) eval4_avx2(weights, &grids[i], &out_scores[i]);
+#endif
+
+    for (; i < count; i++) {
+        EvalFeatures features;
+        Eval_Features(grids[i], &features);
+        out_scores[i] = eval_dot(weights, &features);
+    }
+}
+
+// Every legal (slot, anchor) child of the position, children gets the boards to score
+static u32 eval_successors(const GameState *state, EvalMove *out_moves, u64 *children)
+{
+    Successor successors[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = MoveGen_Successors(state, successors);
+
+    for (u32 i = 0; i < count; i++) {
+        const Successor *s = &successors[i];
+        children[i] = s->grid;
+        out_moves[i] = (EvalMove){
+            .grid = s->grid,
+            .slot = s->slot,
+            .gx = (i8)(s->cell & 7),
+            .gy = (i8)(s->cell >> 3),
+            .lines = s->lines};
+    }
+
+    return count;
+}
+
+// Ties keep the first move, so play is deterministic for a given state
+static u32 eval_best_index(const EvalMove *moves, u32 count)
+{
+    u32 best = 0;
+    for (u32 i = 1; i < count; i++) {
+        if (moves[i].score > moves[best].score) best = i;
+    }
+    return best;
+}
+
+u32 Eval_ScoreSuccessors(const EvalWeights *weights, const GameState *state, EvalMove *out_moves)
+{
+    u64 children[EVAL_MAX_SUCCESSORS];
+    f32 scores[EVAL_MAX_SUCCESSORS];
+    u32 count = eval_successors(state, out_moves, children);
+    if (count == 0) return 0;
+
+    Eval_ScoreBatch(weights, children, count, scores);
+    for (u32 i = 0; i < count; i++) out_moves[i].score = scores[i];
+
+    return count;
+}
+
+bool Eval_BestMove(const EvalWeights *weights, const GameState *state, EvalMove *out_move)
+{
+    EvalMove moves[EVAL_MAX_SUCCESSORS];
+    u32 count = Eval_ScoreSuccessors(weights, state, moves);
+    if (count == 0) return false;
+
+    *out_move = moves[eval_best_index(moves, count)];
+    return true;
+}
+
+
+const char *EVAL_LINE_FEATURE_NAMES[EVAL_LINE_FEATURE_COUNT] = {
+    "line_empty", "line_fill", "line_gaps", "line_singles", "line_fit"
+};
+
+const EvalLineWeights EVAL_LINE_DEFAULT_WEIGHTS = {{
+    [EVAL_LINE_EMPTY] = 1.0f,
+    [EVAL_LINE_FILL] = 1.0f,
+    [EVAL_LINE_GAPS] = -1.0f,
+    [EVAL_LINE_SINGLES] = -1.0f,
+    [EVAL_LINE_FIT] = 4.0f,
+}};
+
+// Cells a shape covers along one line direction, bit 7 first like the grid bytes
+static inline u8 shape_footprint(u64 mask)
+{
+    u8 footprint = 0;
+    for (u32 r = 0; r < 8; r++) footprint |= (u8)(mask >> (56 - 8 * r));
+    return footprint;
+}
+
+static void line_features(u8 line, const u8 *footprints, f32 *out)
+{
+    u32 gaps = 0, singles = 0;
+    for (u32 i = 0; i < 8;) {
+        if ((line >> (7 - i)) & 1) { i++; continue; }
+
+        u32 start = i;
+        while (i < 8 && !((line >> (7 - i)) & 1)) i++;
+        gaps += start > 0 && i < 8;
+        singles += i - start == 1;
+    }
+
+    // A footprint slides right until its last cell reaches bit 0
+    u32 fits = 0;
+    for (u32 s = 1; s <= SHAPE_OPTIONS; s++) {
+        u8 footprint = footprints[s];
+        for (u32 x = 0; x <= u64_ctz(footprint); x++) {
+            if (!((footprint >> x) & line)) { fits++; break; }
+        }
+    }
+
+    u32 fill = u64_popcount(line);
+    out[EVAL_LINE_EMPTY] = (f32)(8 - fill);
+    out[EVAL_LINE_FILL] = (f32)(fill * fill) / 8.0f;
+    out[EVAL_LINE_GAPS] = (f32)gaps;
+    out[EVAL_LINE_SINGLES] = (f32)singles;
+    out[EVAL_LINE_FIT] = (f32)fits / SHAPE_OPTIONS;
+}
+
+void EvalLineTable_Build(const EvalLineWeights *weights, EvalLineTable *out_table)
+{
+    // Rows see a shape's horizontal extent, columns the extent of its transpose
+    u8 row_footprints[SHAPE_COUNT], col_footprints[SHAPE_COUNT];
+    for (u32 s = 1; s < SHAPE_COUNT; s++) {
+        row_footprints[s] = shape_footprint(SHAPE_INFO[s].mask);
+        col_footprints[s] = shape_footprint(grid_transpose(SHAPE_INFO[s].mask));
+    }
+
+    for (u32 line = 0; line < 256; line++) {
+        f32 row[EVAL_LINE_FEATURE_COUNT], col[EVAL_LINE_FEATURE_COUNT];
+        line_features((u8)line, row_footprints, row);
+        line_features((u8)line, col_footprints, col);
+
+        out_table->row[line] = 0;
+        out_table->col[line] = 0;
+        for (u32 f = 0; f < EVAL_LINE_FEATURE_COUNT; f++) {
+            out_table->row[line] += weights->w[f] * row[f];
+            out_table->col[line] += weights->w[f] * col[f];
+        }
+    }
+}
+
+f32 Eval_LineScoreTransposed(const EvalLineTable *table, u64 grid, u64 transposed)
+{
+    // Four independent sums, one dependent chain of 16 f32 adds would be the whole cost
+    f32 sum[4] = { 0 };
+    for (u32 k = 0; k < 4; k++) {
+        sum[k] = table->row[(u8)(grid >> (8 * k))] + table->row[(u8)(grid >> (8 * k + 32))] +
+                 (table->col[(u8)(transposed >> (8 * k))] + table->col[(u8)(transposed >> (8 * k + 32))]);
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+f32 Eval_LineScore(const EvalLineTable *table, u64 grid)
+{
+    return Eval_LineScoreTransposed(table, grid, grid_transpose(grid));
+}
+
+u32 Eval_LineSuccessors(const EvalLineTable *table, const GameState *state, EvalMove *out_moves)
+{
+    Board8T board = board8t_from_grid(state->grid.game_grid);
+    u32 count = 0;
+
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (state->session.is_active[slot]) continue;
+
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[slot])];
+        for (u64 anchors = shape->anchors; anchors; anchors &= anchors - 1) {
+            u32 bit = 63 - u64_ctz(anchors);
+
+            Board8T placed = { shape->mask >> bit, shape->transposed >> ((bit & 7) * 8 + (bit >> 3)) };
+            if (board.grid & placed.grid) continue;
+
+            Board8T child = board;
+            u32 lines = board8t_place_and_clear(&child, placed);
+
+            out_moves[count++] = (EvalMove){
+                .grid = child.grid,
+                .score = Eval_LineScoreTransposed(table, child.grid, child.transposed),
+                .slot = slot,
+                .gx = (i8)(bit & 7),
+                .gy = (i8)(bit >> 3),
+                .lines = (u8)lines};
+        }
+    }
+
+    return count;
+}
+
+bool Eval_LineBestMove(const EvalLineTable *table, const GameState *state, EvalMove *out_move)
+{
+    EvalMove moves[EVAL_MAX_SUCCESSORS];
+    u32 count = Eval_LineSuccessors(table, state, moves);
+    if (count == 0) return false;
+
+    *out_move = moves[eval_best_index(moves, count)];
+    return true;
+}
+
+
+bool EvalWeights_Load(const char *path, EvalWeights *out_weights)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    // Features the file leaves out keep their default weight
+    EvalWeights weights = EVAL_DEFAULT_WEIGHTS;
+    u32 known = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char name[64];
+        f32 value;
+        if (line[0] == '#' || sscanf(line, "%63s %f", name, &value) != 2) continue;
+
+        for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) {
+            if (strcmp(name, EVAL_FEATURE_NAMES[i]) == 0) {
+                weights.w[i] = value;
+                known++;
+            }
+        }
+    }
+
+    fclose(file);
+    if (known == 0) return false;
+
+    *out_weights = weights;
+    return true;
+}
+
+bool EvalWeights_Save(const char *path, const EvalWeights *weights)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "# bg64 evaluation weights\n");
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) fprintf(file, "%s %.9g\n", EVAL_FEATURE_NAMES[i], weights->w[i]);
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,110 @@
+#ifndef BG64_EVAL_H_
+#define BG64_EVAL_H_
+
+
+#include "bg64.h"
+
+
+// BOARD EVALUATION
+// Features are computed straight off the u64 occupancy with popcounts and shift-and
+// tricks, every feature is one pass over all 64 cells at once. Scores are a weighted sum,
+// higher is better for the player.
+typedef enum : u8 {
+    EVAL_EMPTY = 0,     // empty cells
+    EVAL_HOLES,         // empty cells boxed in on all four sides (walls count as filled)
+    EVAL_NEAR_ROWS,     // rows one cell short of clearing
+    EVAL_NEAR_COLS,     // columns one cell short of clearing
+    EVAL_PERIMETER,     // filled/empty edges between neighbouring cells
+    EVAL_MAX_RECT,      // area of the largest empty axis aligned rectangle
+    EVAL_FEATURE_COUNT
+} EvalFeature;
+
+#define EVAL_FEATURE_SLOTS 8 // padded to one 256 bit vector of f32
+
+typedef struct
+{
+    alignas(32) f32 f[EVAL_FEATURE_SLOTS];
+} EvalFeatures;
+
+typedef struct
+{
+    alignas(32) f32 w[EVAL_FEATURE_SLOTS];
+} EvalWeights;
+
+// One placement of a deck slot and what it leaves behind
+typedef struct
+{
+    u64 grid;     // board after placement and line clears
+    f32 score;    // evaluation of grid
+    u8 slot;
+    i8 gx;
+    i8 gy;
+    u8 lines;     // rows + columns cleared by the placement
+} EvalMove;
+
+#define EVAL_MAX_SUCCESSORS (3 * 64)
+
+extern const char *EVAL_FEATURE_NAMES[EVAL_FEATURE_COUNT];
+extern const EvalWeights EVAL_DEFAULT_WEIGHTS;
+
+void Eval_Features(u64 grid, EvalFeatures *out);
+f32 Eval_Score(const EvalWeights *weights, u64 grid);
+void Eval_ScoreBatch(const EvalWeights *weights, const u64 *grids, u32 count, f32 *out_scores);
+
+// Every legal (slot, anchor) child of the position, scored in one batch. Returns the count.
+u32 Eval_ScoreSuccessors(const EvalWeights *weights, const GameState *state, EvalMove *out_moves);
+
+// Greedy one ply player: the highest scoring successor, false when nothing fits
+bool Eval_BestMove(const EvalWeights *weights, const GameState *state, EvalMove *out_move);
+
+
+// TABLE DRIVEN LINE EVALUATION
+// Every row and column is an 8 bit pattern, so any per line heuristic can be tabulated
+// once for all 256 patterns. A board then scores as 8 row bytes of game_grid plus 8 column
+// bytes of its transpose, 16 lookups. Placeability is per shape: a row pattern is checked
+// against each shape's horizontal footprint, a column pattern against its vertical one,
+// which is why rows and columns get separate tables.
+typedef enum : u8 {
+    EVAL_LINE_EMPTY = 0, // empty cells
+    EVAL_LINE_FILL,      // filled cells squared over 8, favours a few nearly full lines
+    EVAL_LINE_GAPS,      // empty runs with a filled cell on both sides
+    EVAL_LINE_SINGLES,   // empty runs one cell long, walls count as filled
+    EVAL_LINE_FIT,       // share of the playable shapes whose footprint fits in the line
+    EVAL_LINE_FEATURE_COUNT
+} EvalLineFeature;
+
+typedef struct
+{
+    f32 w[EVAL_LINE_FEATURE_COUNT];
+} EvalLineWeights;
+
+typedef struct
+{
+    f32 row[256]; // indexed by the row byte, bit 7 is column 0
+    f32 col[256]; // indexed by the transposed grid's byte, bit 7 is row 0
+} EvalLineTable;
+
+extern const char *EVAL_LINE_FEATURE_NAMES[EVAL_LINE_FEATURE_COUNT];
+extern const EvalLineWeights EVAL_LINE_DEFAULT_WEIGHTS;
+
+// Weighted sum of the line features for every pattern, for rows and for columns
+void EvalLineTable_Build(const EvalLineWeights *weights, EvalLineTable *out_table);
+f32 Eval_LineScore(const EvalLineTable *table, u64 grid);
+
+// Same score when the caller keeps grid_transpose(grid) up to date (Board8T)
+f32 Eval_LineScoreTransposed(const EvalLineTable *table, u64 grid, u64 transposed);
+
+// Eval_ScoreSuccessors and Eval_BestMove with the line table as the evaluation. Children
+// are expanded on a Board8T, so the columns never get transposed per child. That is not a
+// win everywhere: tools/eval_bench compares it with transposing per child on the host.
+u32 Eval_LineSuccessors(const EvalLineTable *table, const GameState *state, EvalMove *out_moves);
+bool Eval_LineBestMove(const EvalLineTable *table, const GameState *state, EvalMove *out_move);
+
+// Weight files are plain text, one "feature_name value" per line, '#' starts a comment.
+// Features the file does not name keep their EVAL_DEFAULT_WEIGHTS value. Load fails, and
+// leaves out_weights alone, when the file cannot be read or names no known feature.
+bool EvalWeights_Load(const char *path, EvalWeights *out_weights);
+bool EvalWeights_Save(const char *path, const EvalWeights *weights);
+
+
+#endif /* BG64_EVAL_H_ */
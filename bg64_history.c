@@ -0,0 +1,96 @@
+#include <string.h>
+#include "bg64_history.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+
+void snapshot_copy(GameState *dst, const GameState *src, bool streaming)
+{
+#if defined(__AVX__)
+    const __m256i *s = (const __m256i *)src;
+    __m256i *d = (__m256i *)dst;
+
+    // 8 x 32 byte lanes, both sides are 64 byte aligned by construction
+    __m256i v0 = _mm256_load_si256(s + 0), v1 = _mm256_load_si256(s + 1);
+    __m256i v2 = _mm256_load_si256(s + 2), v3 = _mm256_load_si256(s + 3);
+    __m256i v4 = _mm256_load_si256(s + 4), v5 = _mm256_load_si256(s + 5);
+    __m256i v6 = _mm256_load_si256(s + 6), v7 = _mm256_load_si256(s + 7);
+
+    if (streaming) {
+        _mm256_stream_si256(d + 0, v0); _mm256_stream_si256(d + 1, v1);
+        _mm256_stream_si256(d + 2, v2); _mm256_stream_si256(d + 3, v3);
+        _mm256_stream_si256(d + 4, v4); _mm256_stream_si256(d + 5, v5);
+        _mm256_stream_si256(d + 6, v6); _mm256_stream_si256(d + 7, v7);
+        _mm_sfence();
+    } else {
+        _mm256_store_si256(d + 0, v0); _mm256_store_si256(d + 1, v1);
+        _mm256_store_si256(d + 2, v2); _mm256_store_si256(d + 3, v3);
+        _mm256_store_si256(d + 4, v4); _mm256_store_si256(d + 5, v5);
+        _mm256_store_si256(d + 6, v6); _mm256_store_si256(d + 7, v7);
+    }
+#else
+    (void)streaming;
+    memcpy(dst, src, sizeof(GameState));
+#endif
+}
+
+SnapshotRing SnapshotRing_Allocation(Arena *arena, u32 capacity, bool streaming)
+{
+    // round up to a power of two so the ring index is a mask
+    u32 cap = 1;
+    while (cap < capacity) cap <<= 1;
+
+    SnapshotRing ring = {
+        .slots = (GameState *)Arena_Push(arena, (usize)cap * sizeof(GameState), 64),
+        .capacity = cap,
+        .streaming = streaming};
+
+    return ring;
+}
+
+void SnapshotRing_Clear(SnapshotRing *ring)
+{
+    ring->bottom = ring->head = ring->top = 0;
+}
+
+void SnapshotRing_Push(SnapshotRing *ring, const GameState *state)
+{
+    // A new snapshot after an undo drops the redo branch
+    if (!SnapshotRing_Empty(ring)) ring->top = ring->head + 1;
+
+    ring->head = ring->top++;
+    snapshot_copy(&ring->slots[ring->head & (ring->capacity - 1)], state, ring->streaming);
+
+    // Full: the oldest snapshot falls off
+    if (ring->top - ring->bottom > ring->capacity) ring->bottom = ring->top - ring->capacity;
+}
+
+bool SnapshotRing_Undo(SnapshotRing *ring, GameState *state)
+{
+    if (SnapshotRing_Empty(ring) || ring->head == ring->bottom) return false;
+
+    ring->head--;
+    snapshot_copy(state, &ring->slots[ring->head & (ring->capacity - 1)], false);
+    return true;
+}
+
+bool SnapshotRing_Redo(SnapshotRing *ring, GameState *state)
+{
+    if (ring->head + 1 >= ring->top) return false;
+
+    ring->head++;
+    snapshot_copy(state, &ring->slots[ring->head & (ring->capacity - 1)], false);
+    return true;
+}
+
+bool SnapshotRing_Unmake(SnapshotRing *ring, GameState *state)
+{
+    if (SnapshotRing_Empty(ring)) return false;
+
+    ring->top--;
+    snapshot_copy(state, &ring->slots[ring->top & (ring->capacity - 1)], false);
+    ring->head = ring->top - 1;
+    return true;
+}
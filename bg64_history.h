@@ -0,0 +1,48 @@
+#ifndef BG64_HISTORY_H_
+#define BG64_HISTORY_H_
+
+
+#include "bg64.h"
+
+
+// SNAPSHOT RING
+// A GameState is exactly 4 cache lines, so the game's undo/redo just copies whole states
+// instead of reversing moves, and so does tools/perft when it walks ApplyMove depth first.
+// The searches (bg64_solver, bg64_mcts, bg64_adversary) step bare u64 grids and keep no
+// GameState stack. Slots are carved from the Arena.
+//
+// Indices are monotonic u32 counters masked by capacity:
+//   [bottom, top)  snapshots still held by the ring (the oldest fall off when full)
+//   head           snapshot that matches the live state, head + 1 .. top - 1 is redo
+typedef struct SnapshotRing
+{
+    GameState *slots;  // capacity snapshots, 64 byte aligned
+    u32 capacity;      // power of two
+    u32 bottom;
+    u32 head;
+    u32 top;
+    bool streaming;    // non-temporal pushes, for cold history that is rarely read back
+} SnapshotRing;
+
+#define HISTORY_CAPACITY 1024 // undo depth of the game, 256KB
+#define PERFT_STACK_CAPACITY 256 // make/unmake depth of a tools/perft worker
+
+SnapshotRing SnapshotRing_Allocation(Arena *arena, u32 capacity, bool streaming);
+void SnapshotRing_Clear(SnapshotRing *ring);
+static inline bool SnapshotRing_Empty(const SnapshotRing *ring) { return ring->top == ring->bottom; }
+
+// Undo / redo: the ring holds the state after every committed move
+void SnapshotRing_Push(SnapshotRing *ring, const GameState *state);
+bool SnapshotRing_Undo(SnapshotRing *ring, GameState *state);
+bool SnapshotRing_Redo(SnapshotRing *ring, GameState *state);
+
+// Make / unmake for tools/perft's GameState kernels: push the state before a move, unmake
+// restores and pops it
+static inline void SnapshotRing_Make(SnapshotRing *ring, const GameState *state) { SnapshotRing_Push(ring, state); }
+bool SnapshotRing_Unmake(SnapshotRing *ring, GameState *state);
+
+// 256 byte aligned copy, AVX loads/stores (streaming stores skip the cache)
+void snapshot_copy(GameState *dst, const GameState *src, bool streaming);
+
+
+#endif /* BG64_HISTORY_H_ */
@@ -0,0 +1,46 @@
+#include "bg64_input.h"
+
+
+void InputQueue_Clear(InputQueue *queue)
+{
+    queue->head = queue->tail = 0;
+}
+
+bool InputQueue_Push(InputQueue *queue, InputEvent event)
+{
+    if (queue->tail - queue->head == INPUT_QUEUE_CAPACITY) return false;
+
+    queue->events[queue->tail & (INPUT_QUEUE_CAPACITY - 1)] = event;
+    queue->tail++;
+    return true;
+}
+
+bool InputQueue_Pop(InputQueue *queue, f64 until, InputEvent *out_event)
+{
+    if (queue->head == queue->tail) return false;
+
+    const InputEvent *event = &queue->events[queue->head & (INPUT_QUEUE_CAPACITY - 1)];
+    if (event->time > until) return false;
+
+    *out_event = *event;
+    queue->head++;
+    return true;
+}
+
+void InputQueue_Sample(InputQueue *queue, f64 now, Vector2 virtual_mouse)
+{
+    // Position first, so a press or release lands where the pointer is this frame
+    if (virtual_mouse.x != queue->last_pos.x || virtual_mouse.y != queue->last_pos.y) {
+        if (InputQueue_Push(queue, (InputEvent){ now, virtual_mouse, INPUT_POINTER_MOVE })) queue->last_pos = virtual_mouse;
+    }
+
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) InputQueue_Push(queue, (InputEvent){ now, virtual_mouse, INPUT_POINTER_DOWN });
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) InputQueue_Push(queue, (InputEvent){ now, virtual_mouse, INPUT_POINTER_UP });
+
+    // Undo: ctrl + z, redo: ctrl + y (or ctrl + shift + z)
+    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
+        bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+        if (IsKeyPressed(KEY_Z) && !shift) InputQueue_Push(queue, (InputEvent){ now, virtual_mouse, INPUT_UNDO });
+        if (IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift)) InputQueue_Push(queue, (InputEvent){ now, virtual_mouse, INPUT_REDO });
+    }
+}
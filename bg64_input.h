@@ -0,0 +1,52 @@
+#ifndef BG64_INPUT_H_
+#define BG64_INPUT_H_
+
+
+#include "bg64.h"
+
+
+// FIXED TIMESTEP INPUT
+// Game logic runs on fixed ticks of LOGIC_TICK_DT simulated seconds, independent of the
+// render rate. Input is sampled once per rendered frame, stamped with the simulation time
+// of that frame and queued; each tick consumes the events stamped at or before its end.
+// The logic only ever sees (time, event) pairs, so a run replays the same under frame drops.
+#define LOGIC_TICK_HZ 120
+#define LOGIC_TICK_DT (1.0 / LOGIC_TICK_HZ)
+#define LOGIC_MAX_FRAME 0.25 // longest frame fed to the accumulator, a hitch drops time instead of spiralling
+
+typedef enum : u8 {
+    INPUT_POINTER_MOVE = 0,
+    INPUT_POINTER_DOWN,
+    INPUT_POINTER_UP,
+    INPUT_UNDO,
+    INPUT_REDO
+} InputType;
+
+typedef struct
+{
+    f64 time;      // simulation seconds
+    Vector2 pos;   // virtual canvas coordinates
+    InputType type;
+} InputEvent; // 24 bytes
+
+#define INPUT_QUEUE_CAPACITY 256 // power of two
+
+typedef struct InputQueue
+{
+    InputEvent events[INPUT_QUEUE_CAPACITY];
+    u32 head;          // next event to pop
+    u32 tail;          // next free slot
+    Vector2 last_pos;  // pointer position of the last queued move
+} InputQueue;
+
+void InputQueue_Clear(InputQueue *queue);
+bool InputQueue_Push(InputQueue *queue, InputEvent event);
+
+// Oldest event stamped at or before until, false when there is none
+bool InputQueue_Pop(InputQueue *queue, f64 until, InputEvent *out_event);
+
+// Reads this frame's pointer and keys from raylib into the queue
+void InputQueue_Sample(InputQueue *queue, f64 now, Vector2 virtual_mouse);
+
+
+#endif /* BG64_INPUT_H_ */
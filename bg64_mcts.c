@@ -0,0 +1,405 @@
+#define _GNU_SOURCE // clock_gettime
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "bg64_mcts.h"
+#include "bg64_board.h"
+#include "bg64_movegen.h"
+#include "bg64_pieces.h"
+
+#define MCTS_MAX_THREADS 64
+#define MCTS_MAX_DEPTH 4 // root plus one ply per deck piece
+
+// Rewards are summed in 16.16 fixed point so a node's statistics are two atomic adds
+#define REWARD_ONE 65536.0
+
+// A cleared line is worth half a survived placement
+#define LINE_BONUS 0.5
+
+// Candidates the line clearing rollout policy draws per move
+#define LINE_CANDIDATES 4
+
+enum { NODE_LEAF = 0, NODE_EXPANDING, NODE_EXPANDED, NODE_STUCK };
+
+// 32 bytes, two per cache line
+struct MctsNode
+{
+    u64 grid;              // after the move and its line clears
+    atomic_ullong reward;  // sum of rewards, REWARD_ONE fixed point
+    atomic_uint visits;    // completed visits plus walks still in flight (the virtual loss)
+    u32 first_child;       // valid once state is NODE_EXPANDED
+    u16 child_count;
+    atomic_uchar state;
+    u8 used;               // deck slots placed, bit per slot
+    u8 move;               // slot << 6 | cell
+    u8 lines;              // cleared by the move
+};
+
+typedef struct
+{
+    Mcts *mcts;
+    const ShapeInfo *deck[3];
+    PieceDistribution pieces; // the game's, rollouts deal their decks from it
+    u8 root_used;
+    f32 horizon;             // placements a rollout from the root can make at most
+
+    atomic_uint node_count;  // never past the capacity, nodes are only reserved when they fit
+    atomic_bool tree_full;   // an expansion did not fit, the leaves stay leaves from then on
+    atomic_ullong claimed;   // rollouts handed out
+    u64 budget;
+    f64 deadline;
+    atomic_bool stop;
+} MctsShared;
+
+typedef struct
+{
+    MctsShared *shared;
+    u64 rng;
+    u64 rollouts;
+    u64 moves;
+} MctsWorker;
+
+
+static f64 mcts_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+Mcts Mcts_Allocation(Arena *arena, u32 capacity)
+{
+    Mcts mcts = {
+        .nodes = (MctsNode *)Arena_Push(arena, (u64)capacity * sizeof(MctsNode), 64),
+        .capacity = capacity,
+        .rollout = MCTS_ROLLOUT_LINES,
+        .rollout_decks = 4,
+        .exploration = 0.5f,
+        .expand_visits = 2,
+        .seed = 0x9E3779B97F4A7C15ull};
+    return mcts;
+}
+
+// Position of the n-th set bit, counting from the lowest
+static inline u32 mcts_select_bit(u64 bits, u32 n)
+{
+#if defined(__BMI2__)
+    return u64_ctz(_pdep_u64(1ull << n, bits));
+#else
+    while (n--) bits &= bits - 1;
+    return u64_ctz(bits);
+#endif
+}
+
+// Legal anchors per slot still to play, returns the placement count
+static inline u32 mcts_legal_moves(u64 grid, const ShapeInfo *const *deck, u8 used, u64 *legal)
+{
+    u32 total = 0;
+    for (u32 s = 0; s < 3; s++) {
+        legal[s] = (used >> s) & 1 ? 0 : MoveGen_LegalAnchors(grid, deck[s]);
+        total += u64_popcount(legal[s]);
+    }
+    return total;
+}
+
+// Uniform pick among the `total` placements in legal, returns the placed cells
+static inline u64 mcts_pick(const ShapeInfo *const *deck, const u64 *legal, u32 total, u64 *rng, u32 *out_slot)
+{
+    u32 n = (u32)(((xorshift(rng) >> 32) * total) >> 32);
+    u32 s = 0;
+    while (n >= u64_popcount(legal[s])) n -= u64_popcount(legal[s++]);
+
+    *out_slot = s;
+    return deck[s]->mask >> (63 - mcts_select_bit(legal[s], n));
+}
+
+// Plays the deck's remaining slots, then `decks` random decks dealt from pieces. Returns
+// placements made, out_lines gets the lines they cleared.
+static u32 mcts_rollout(u64 grid, const ShapeInfo *const *root_deck, u8 used, const PieceDistribution *pieces, u32 decks,
+                        MctsRollout policy, u64 *rng, u32 *out_lines)
+{
+    const ShapeInfo *deck[3] = { root_deck[0], root_deck[1], root_deck[2] };
+    u32 placed = 0, lines = 0;
+
+    for (u32 d = 0;; d++) {
+        while (used != 7) {
+            u64 legal[3];
+            u32 total = mcts_legal_moves(grid, deck, used, legal);
+            if (total == 0) goto done;
+
+            u32 slot;
+            u64 mask = mcts_pick(deck, legal, total, rng, &slot);
+            u32 cleared;
+            u64 clear = board8_full_lines(grid | mask, &cleared);
+
+            if (policy == MCTS_ROLLOUT_LINES) {
+                for (u32 c = 1; c < LINE_CANDIDATES; c++) {
+                    u32 other_slot, other_cleared;
+                    u64 other = mcts_pick(deck, legal, total, rng, &other_slot);
+                    u64 other_clear = board8_full_lines(grid | other, &other_cleared);
+                    if (other_cleared > cleared) {
+                        mask = other, clear = other_clear, cleared = other_cleared, slot = other_slot;
+                    }
+                }
+            }
+
+            grid = (grid | mask) & ~clear;
+            used |= (u8)(1u << slot);
+            lines += cleared;
+            placed++;
+        }
+
+        if (d == decks) break;
+        for (u32 s = 0; s < 3; s++) deck[s] = &SHAPE_INFO[GET_SHAPE(Pieces_Draw(pieces, rng))];
+        used = 0;
+    }
+
+done:
+    *out_lines = lines;
+    return placed;
+}
+
+// Gives node one child per legal placement of its unplayed slots. Slots holding the same
+// shape lead to the same boards, so only the first of them is expanded.
+static void mcts_expand(MctsShared *shared, MctsNode *node)
+{
+    u64 legal[3] = { 0 };
+    u32 total = 0;
+    for (u32 s = 0; s < 3; s++) {
+        if ((node->used >> s) & 1) continue;
+
+        bool repeat = false;
+        for (u32 p = 0; p < s; p++) repeat |= !((node->used >> p) & 1) && shared->deck[p] == shared->deck[s];
+        if (repeat) continue;
+
+        legal[s] = MoveGen_LegalAnchors(node->grid, shared->deck[s]);
+        total += u64_popcount(legal[s]);
+    }
+
+    if (total == 0) {
+        atomic_store_explicit(&node->state, NODE_STUCK, memory_order_release);
+        return;
+    }
+
+    Mcts *mcts = shared->mcts;
+    u32 first = atomic_load_explicit(&shared->node_count, memory_order_relaxed);
+    do {
+        if ((u64)first + total > mcts->capacity) {
+            // Out of nodes: the leaf stays a leaf and keeps being valued by rollouts, and no
+            // other leaf tries again
+            atomic_store_explicit(&shared->tree_full, true, memory_order_relaxed);
+            atomic_store_explicit(&node->state, NODE_LEAF, memory_order_release);
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&shared->node_count, &first, first + total, memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    MctsNode *child = &mcts->nodes[first];
+    for (u32 s = 0; s < 3; s++) {
+        for (u64 a = legal[s]; a; a &= a - 1) {
+            u32 cell = 63 - u64_ctz(a);
+            u32 lines;
+            u64 grid = node->grid | (shared->deck[s]->mask >> cell);
+            grid &= ~board8_full_lines(grid, &lines);
+
+            child->grid = grid;
+            atomic_init(&child->reward, 0);
+            atomic_init(&child->visits, 0);
+            child->first_child = 0;
+            child->child_count = 0;
+            atomic_init(&child->state, NODE_LEAF);
+            child->used = (u8)(node->used | 1u << s);
+            child->move = (u8)(s << 6 | cell);
+            child->lines = (u8)lines;
+            child++;
+        }
+    }
+
+    node->first_child = first;
+    node->child_count = (u16)total;
+    atomic_store_explicit(&node->state, NODE_EXPANDED, memory_order_release);
+}
+
+// UCT over the children. Counting a walk as a visit before its reward arrives makes the
+// child look worse to every other thread until it does, which is the virtual loss.
+static MctsNode *mcts_select(const MctsShared *shared, MctsNode *node)
+{
+    MctsNode *children = &shared->mcts->nodes[node->first_child];
+    u32 parent_visits = atomic_load_explicit(&node->visits, memory_order_relaxed);
+    f64 log_parent = log((f64)(parent_visits > 1 ? parent_visits : 1));
+    f64 c = shared->mcts->exploration;
+
+    MctsNode *best = children;
+    f64 best_key = -1.0;
+    for (u32 i = 0; i < node->child_count; i++) {
+        u32 n = atomic_load_explicit(&children[i].visits, memory_order_relaxed);
+        if (n == 0) return &children[i];
+
+        f64 q = (f64)atomic_load_explicit(&children[i].reward, memory_order_relaxed) / (REWARD_ONE * n);
+        f64 key = q + c * sqrt(log_parent / n);
+        if (key > best_key) best_key = key, best = &children[i];
+    }
+    return best;
+}
+
+// One walk: down the tree by UCT, grow the leaf if it is ready, roll out, back up
+static void mcts_iterate(MctsWorker *worker)
+{
+    MctsShared *shared = worker->shared;
+    Mcts *mcts = shared->mcts;
+
+    MctsNode *path[MCTS_MAX_DEPTH];
+    u32 depth = 0;
+    u32 lines = 0;
+
+    MctsNode *node = &mcts->nodes[0];
+    atomic_fetch_add_explicit(&node->visits, 1, memory_order_relaxed);
+    path[depth++] = node;
+
+    for (;;) {
+        u8 state = atomic_load_explicit(&node->state, memory_order_acquire);
+        if (state == NODE_LEAF && node->used != 7 && !atomic_load_explicit(&shared->tree_full, memory_order_relaxed) &&
+            atomic_load_explicit(&node->visits, memory_order_relaxed) >= mcts->expand_visits) {
+            u8 expected = NODE_LEAF;
+            if (atomic_compare_exchange_strong_explicit(&node->state, &expected, NODE_EXPANDING, memory_order_acquire,
+                                                        memory_order_relaxed)) {
+                mcts_expand(shared, node);
+                state = atomic_load_explicit(&node->state, memory_order_acquire);
+            }
+        }
+        if (state != NODE_EXPANDED) break;
+
+        node = mcts_select(shared, node);
+        atomic_fetch_add_explicit(&node->visits, 1, memory_order_relaxed);
+        path[depth++] = node;
+        lines += node->lines;
+    }
+
+    u32 placed = depth - 1;
+    if (atomic_load_explicit(&node->state, memory_order_relaxed) != NODE_STUCK) {
+        u32 rollout_lines;
+        u32 rollout_placed = mcts_rollout(node->grid, shared->deck, node->used, &shared->pieces, mcts->rollout_decks,
+                                          mcts->rollout, &worker->rng, &rollout_lines);
+        placed += rollout_placed;
+        lines += rollout_lines;
+        worker->moves += rollout_placed;
+    }
+    worker->rollouts++;
+
+    f64 reward = ((f64)placed + LINE_BONUS * lines) / shared->horizon;
+    u64 fixed = (u64)(reward * REWARD_ONE);
+    for (u32 i = 0; i < depth; i++) atomic_fetch_add_explicit(&path[i]->reward, fixed, memory_order_relaxed);
+}
+
+static void *mcts_worker_run(void *arg)
+{
+    MctsWorker *worker = (MctsWorker *)arg;
+    MctsShared *shared = worker->shared;
+
+    while (!atomic_load_explicit(&shared->stop, memory_order_relaxed)) {
+        // Claim rollouts in small batches, the clock is read once per batch
+        u64 first = atomic_fetch_add_explicit(&shared->claimed, 64, memory_order_relaxed);
+        if (shared->budget && first >= shared->budget) break;
+
+        u64 count = shared->budget && shared->budget - first < 64 ? shared->budget - first : 64;
+        for (u64 i = 0; i < count; i++) mcts_iterate(worker);
+
+        if (shared->deadline > 0 && mcts_now() >= shared->deadline) atomic_store(&shared->stop, true);
+    }
+    return NULL;
+}
+
+bool Mcts_Search(Mcts *mcts, const GameState *state, u32 threads, u64 rollouts, f64 seconds, MctsResult *out_result)
+{
+    f64 start = mcts_now();
+    *out_result = (MctsResult){ 0 };
+
+    MctsShared shared = { .mcts = mcts, .budget = rollouts, .deadline = seconds > 0 ? start + seconds : 0 };
+    u32 pieces_left = 0;
+    for (u32 s = 0; s < 3; s++) {
+        shared.deck[s] = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[s])];
+        if (state->session.is_active[s]) shared.root_used |= (u8)(1u << s);
+        else pieces_left++;
+    }
+    shared.horizon = (f32)(pieces_left + 3 * mcts->rollout_decks);
+    shared.pieces = *Pieces_StateDistribution(state);
+    atomic_init(&shared.node_count, 1);
+    atomic_init(&shared.tree_full, false);
+    atomic_init(&shared.claimed, 0);
+    atomic_init(&shared.stop, false);
+
+    MctsNode *root = &mcts->nodes[0];
+    root->grid = state->grid.game_grid;
+    atomic_init(&root->reward, 0);
+    atomic_init(&root->visits, 0);
+    atomic_init(&root->state, NODE_EXPANDING);
+    root->used = shared.root_used;
+    root->move = 0;
+    root->lines = 0;
+    mcts_expand(&shared, root);
+    if (atomic_load(&root->state) != NODE_EXPANDED) return false;
+
+    if (threads == 0) threads = (u32)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > MCTS_MAX_THREADS) threads = MCTS_MAX_THREADS;
+
+    MctsWorker workers[MCTS_MAX_THREADS];
+    pthread_t handles[MCTS_MAX_THREADS];
+    for (u32 t = 0; t < threads; t++) {
+        workers[t] = (MctsWorker){ .shared = &shared, .rng = (mcts->seed + t) * 0x9E3779B97F4A7C15ull | 1 };
+    }
+    // The calling thread is worker 0
+    for (u32 t = 1; t < threads; t++) pthread_create(&handles[t], NULL, mcts_worker_run, &workers[t]);
+    mcts_worker_run(&workers[0]);
+    for (u32 t = 1; t < threads; t++) pthread_join(handles[t], NULL);
+
+    // Play the most visited child, the most explored one is the most trusted
+    const MctsNode *children = &mcts->nodes[root->first_child];
+    const MctsNode *best = children;
+    for (u32 i = 1; i < root->child_count; i++) {
+        if (atomic_load(&children[i].visits) > atomic_load(&best->visits)) best = &children[i];
+    }
+
+    u32 cell = best->move & 63;
+    u32 visits = atomic_load(&best->visits);
+    out_result->slot = best->move >> 6;
+    out_result->gx = (i8)(cell % 8);
+    out_result->gy = (i8)(cell / 8);
+    out_result->lines = best->lines;
+    out_result->visits = visits;
+    out_result->value = visits ? (f32)(atomic_load(&best->reward) / (REWARD_ONE * visits)) : 0;
+    out_result->nodes = atomic_load(&shared.node_count);
+    for (u32 t = 0; t < threads; t++) {
+        out_result->rollouts += workers[t].rollouts;
+        out_result->rollout_moves += workers[t].moves;
+    }
+    out_result->seconds = mcts_now() - start;
+    return true;
+}
+
+u64 Mcts_RolloutBench(const Mcts *mcts, const GameState *state, u64 rollouts, u64 *out_lines)
+{
+    const ShapeInfo *deck[3];
+    u8 used = 0;
+    for (u32 s = 0; s < 3; s++) {
+        deck[s] = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[s])];
+        if (state->session.is_active[s]) used |= (u8)(1u << s);
+    }
+
+    const PieceDistribution *pieces = Pieces_StateDistribution(state);
+    u64 rng = mcts->seed | 1;
+    u64 moves = 0, lines = 0;
+    for (u64 i = 0; i < rollouts; i++) {
+        u32 rollout_lines;
+        moves += mcts_rollout(state->grid.game_grid, deck, used, pieces, mcts->rollout_decks, mcts->rollout, &rng,
+                              &rollout_lines);
+        lines += rollout_lines;
+    }
+    if (out_lines) *out_lines = lines;
+    return moves;
+}
@@ -0,0 +1,67 @@
+#ifndef BG64_MCTS_H_
+#define BG64_MCTS_H_
+
+
+#include "bg64.h"
+
+
+// MONTE CARLO TREE SEARCH
+// For play when the piece stream can't be known ahead (a hidden or reseeded rng_seed):
+// only the current deck is trusted, everything past it is sampled. The tree covers the
+// placements of the deck pieces still to play, one ply per piece, and picks children by
+// UCT. Each leaf is valued by rollouts straight on the u64 bitboard: the rest of the deck,
+// then random decks dealt from the game's piece distribution (bg64_pieces), placed by a
+// random or a line clearing policy until the horizon ends or nothing fits. A rollout's
+// reward is the fraction of the horizon survived, with cleared lines on top.
+//
+// Worker threads share one tree. A thread walking down adds a virtual loss to every node
+// it passes so the others spread over different children, and takes it back when it adds
+// the real result. Nodes come from one arena block handed out with an atomic cursor.
+typedef enum : u8 {
+    MCTS_ROLLOUT_RANDOM = 0, // uniform over every legal placement of the deck
+    MCTS_ROLLOUT_LINES,      // the best of a few random placements by lines cleared
+} MctsRollout;
+
+typedef struct MctsNode MctsNode;
+
+typedef struct
+{
+    MctsNode *nodes;
+    u32 capacity;
+
+    // Tuning, Mcts_Allocation fills in the defaults
+    MctsRollout rollout;
+    u32 rollout_decks;  // random decks played after the current one
+    f32 exploration;    // UCT constant
+    u32 expand_visits;  // visits a leaf needs before it gets children
+    u64 seed;           // rollout piece stream, every thread derives its own
+} Mcts;
+
+typedef struct
+{
+    u8 slot;            // most visited root child
+    i8 gx;
+    i8 gy;
+    u8 lines;
+    f32 value;          // its mean reward, 0..1 plus line bonus
+    u32 visits;
+    u32 nodes;
+    u64 rollouts;
+    u64 rollout_moves;
+    f64 seconds;
+} MctsResult;
+
+// capacity: tree nodes (32 bytes each), a search stops growing the tree once they run out
+Mcts Mcts_Allocation(Arena *arena, u32 capacity);
+
+// Searches state's current deck with `threads` workers (0 = one per core) until `rollouts`
+// rollouts or `seconds` have passed, 0 meaning no limit on that one. False when no deck
+// piece fits anywhere.
+bool Mcts_Search(Mcts *mcts, const GameState *state, u32 threads, u64 rollouts, f64 seconds, MctsResult *out_result);
+
+// Plays rollouts from state with no tree, for measuring the rollout kernel alone.
+// Returns the placements made, out_lines gets the lines cleared.
+u64 Mcts_RolloutBench(const Mcts *mcts, const GameState *state, u64 rollouts, u64 *out_lines);
+
+
+#endif /* BG64_MCTS_H_ */
@@ -0,0 +1,105 @@
+#include "bg64_movegen.h"
+#include "bg64_board.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+#if defined(__AVX2__)
+// Four boards: full rows are bytes equal to 0xFF, full columns the AND of a lane's 8 bytes
+// broadcast back to every byte. Same shift-and kernel as Batch_Step.
+static inline void movegen_full_lines4(const u64 *boards, u64 *out_clear, u8 *out_lines)
+{
+    __m256i grid = _mm256_loadu_si256((const __m256i *)boards);
+    __m256i rows = _mm256_cmpeq_epi8(grid, _mm256_set1_epi8(-1));
+
+    __m256i c = _mm256_and_si256(grid, _mm256_srli_epi64(grid, 32));
+    c = _mm256_and_si256(c, _mm256_srli_epi64(c, 16));
+    c = _mm256_and_si256(c, _mm256_srli_epi64(c, 8));
+    __m256i cols = _mm256_shuffle_epi8(c, _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8,
+                                                           0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8));
+    _mm256_storeu_si256((__m256i *)out_clear, _mm256_or_si256(rows, cols));
+
+    // One movemask bit per full row byte, the column flags are the low byte of c
+    u32 row_bits = (u32)_mm256_movemask_epi8(rows);
+    alignas(32) u64 col_lanes[4];
+    _mm256_store_si256((__m256i *)col_lanes, c);
+    for (u32 k = 0; k < 4; k++) {
+        out_lines[k] = (u8)(u64_popcount((row_bits >> (8 * k)) & 0xFF) + u64_popcount(col_lanes[k] & 0xFF));
+    }
+}
+#endif
+
+// Clear masks and line counts for every board, in bulk
+static void movegen_full_lines(const u64 *boards, u32 count, u64 *out_clear, u8 *out_lines)
+{
+    u32 i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) movegen_full_lines4(&boards[i], &out_clear[i], &out_lines[i]);
+#endif
+    for (; i < count; i++) {
+        u32 lines;
+        out_clear[i] = board8_full_lines(boards[i], &lines);
+        out_lines[i] = (u8)lines;
+    }
+}
+
+u32 MoveGen_Board(u64 grid, const u8 *deck, u8 active, Successor *out_successors)
+{
+    u64 boards[MOVEGEN_MAX_SUCCESSORS];
+    u64 clears[MOVEGEN_MAX_SUCCESSORS];
+    u8 lines[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = 0;
+
+    // Placement pass: boards before clears go to their own array for the bulk pass
+    for (u8 slot = 0; slot < 3; slot++) {
+        if ((active >> slot) & 1) continue;
+
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(deck[slot])];
+        for (u64 a = MoveGen_LegalAnchors(grid, shape); a; a &= a - 1) {
+            u32 cell = 63 - u64_ctz(a);
+            u64 placed = shape->mask >> cell;
+
+            boards[count] = grid | placed;
+            out_successors[count].placed_mask = placed;
+            out_successors[count].slot = slot;
+            out_successors[count].cell = (u8)cell;
+            out_successors[count]._pad = 0;
+            count++;
+        }
+    }
+
+    movegen_full_lines(boards, count, clears, lines);
+
+    for (u32 i = 0; i < count; i++) {
+        out_successors[i].grid = boards[i] & ~clears[i];
+        out_successors[i].clear_mask = clears[i];
+        out_successors[i].lines = lines[i];
+        out_successors[i].score_delta = lines[i] * 10u; // 10 points per line, as ClearLinesAndColors
+    }
+
+    return count;
+}
+
+u32 MoveGen_Successors(const GameState *state, Successor *out_successors)
+{
+    u8 active = 0;
+    for (u8 k = 0; k < 3; k++) active |= (u8)(state->session.is_active[k] << k);
+    return MoveGen_Board(state->grid.game_grid, state->session.deck_shape_color_bits, active, out_successors);
+}
+
+u32 MoveGen_Count(const GameState *state, u64 *out_legal)
+{
+    u32 count = 0;
+    for (u8 slot = 0; slot < 3; slot++) {
+        u64 legal = 0;
+        if (!state->session.is_active[slot]) {
+            const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[slot])];
+            legal = MoveGen_LegalAnchors(state->grid.game_grid, shape);
+        }
+        if (out_legal) out_legal[slot] = legal;
+        count += u64_popcount(legal);
+    }
+    return count;
+}
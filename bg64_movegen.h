@@ -0,0 +1,50 @@
+#ifndef BG64_MOVEGEN_H_
+#define BG64_MOVEGEN_H_
+
+
+#include "bg64.h"
+
+
+// BULK SUCCESSOR GENERATION
+// Expands a node in one call: every legal (slot, anchor) child of every deck slot not
+// placed yet, with the board after its line clears, the cells placed and cleared and the
+// points scored, the same values TryPlace + ClearLinesAndColors would give one by one.
+//
+// Legality is found per shape, not per anchor: a shape cell k places past the anchor hits
+// the grid bit k places further on, so OR'ing the grid shifted by every cell offset marks
+// every blocked anchor at once. Line clears are then detected across the children, four
+// boards per AVX2 register, and the arrays are the caller's: nothing is allocated.
+typedef struct
+{
+    u64 grid;          // game_grid after the placement and its line clears
+    u64 placed_mask;
+    u64 clear_mask;
+    u32 score_delta;
+    u8 slot;
+    u8 cell;           // gy * 8 + gx
+    u8 lines;          // rows + columns cleared
+    u8 _pad;
+} Successor;
+
+#define MOVEGEN_MAX_SUCCESSORS (3 * 64)
+
+// Anchors where shape fits on grid, bit (63 - (gy * 8 + gx)) like ShapeInfo.anchors
+static inline u64 MoveGen_LegalAnchors(u64 grid, const ShapeInfo *shape)
+{
+    u64 blocked = 0;
+    for (u64 m = shape->mask; m; m &= m - 1) blocked |= grid << (63 - __builtin_ctzll(m));
+    return shape->anchors & ~blocked;
+}
+
+// Children of a bare board: deck holds composite bytes, bit i of active marks slot i as
+// placed. Slot order, then cell order (highest cell first). Returns the count written.
+u32 MoveGen_Board(u64 grid, const u8 *deck, u8 active, Successor *out_successors);
+
+// Children of state, out_successors needs room for MOVEGEN_MAX_SUCCESSORS
+u32 MoveGen_Successors(const GameState *state, Successor *out_successors);
+
+// Legal moves only, no boards: the count, out_legal[slot] gets the anchor set per slot
+u32 MoveGen_Count(const GameState *state, u64 *out_legal);
+
+
+#endif /* BG64_MOVEGEN_H_ */
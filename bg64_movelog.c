@@ -0,0 +1,407 @@
+#define _GNU_SOURCE     // madvise
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bg64_movelog.h"
+#include "bg64_board.h"
+#include "bg64_eval.h"
+#include "bg64_history.h"
+
+#define RANGE_TOP (1u << 24)      // renormalize below this, a byte at a time
+#define RANKS_INCREMENT 24
+#define RANKS_LIMIT (1u << 16)    // totals stay under it: range / total keeps 8 bits
+#define SYMBOL_NEW_GAME (MOVELOG_SYMBOLS - 1)
+
+
+// RANK MODEL
+static void ranks_init(MoveLogRanks *ranks)
+{
+    for (u32 s = 0; s < MOVELOG_SYMBOLS; s++) ranks->freq[s] = 1;
+    ranks->total = MOVELOG_SYMBOLS;
+}
+
+static void ranks_update(MoveLogRanks *ranks, u32 symbol)
+{
+    ranks->freq[symbol] += RANKS_INCREMENT;
+    ranks->total += RANKS_INCREMENT;
+    if (ranks->total < RANKS_LIMIT) return;
+
+    // Halve and keep every symbol codable, recent moves weigh more
+    ranks->total = 0;
+    for (u32 s = 0; s < MOVELOG_SYMBOLS; s++) {
+        ranks->freq[s] = (u16)((ranks->freq[s] + 1) / 2);
+        ranks->total += ranks->freq[s];
+    }
+}
+
+// Interval of symbol among the ranks below count and the new game marker
+static u32 ranks_interval(const MoveLogRanks *ranks, u32 count, u32 symbol, u32 *out_start, u32 *out_size)
+{
+    u32 start = 0, below = 0;
+    for (u32 s = 0; s < count; s++) {
+        if (s == symbol) start = below;
+        below += ranks->freq[s];
+    }
+    if (symbol == SYMBOL_NEW_GAME) start = below;
+
+    *out_start = start;
+    *out_size = ranks->freq[symbol];
+    return below + ranks->freq[SYMBOL_NEW_GAME];
+}
+
+
+// POSITIONS
+// The legal moves of a position in the order the model codes them
+typedef struct
+{
+    u32 count;
+    u64 legal[3];                          // index model
+    EvalMove moves[MOVEGEN_MAX_SUCCESSORS]; // ranked model, move generator order
+} MoveLogPosition;
+
+static void position_moves(const GameState *state, MoveLogModel model, MoveLogPosition *out)
+{
+    if (model == MOVELOG_MODEL_RANKED) out->count = Eval_ScoreSuccessors(&EVAL_DEFAULT_WEIGHTS, state, out->moves);
+    else out->count = MoveGen_Count(state, out->legal);
+}
+
+// Move i ranks ahead of move j: higher score, ties to the earlier move as Eval_BestMove
+static inline bool ranks_ahead(const EvalMove *moves, u32 i, u32 j)
+{
+    return moves[i].score > moves[j].score || (moves[i].score == moves[j].score && i < j);
+}
+
+// Symbol of a move, false when it is not legal in the position
+static bool position_symbol(const MoveLogPosition *position, MoveLogModel model, ReplayMove move, u32 *out_symbol)
+{
+    if (move.slot == REPLAY_NEW_GAME) {
+        *out_symbol = SYMBOL_NEW_GAME;
+        return true;
+    }
+    if (move.slot >= 3 || move.gx < 0 || move.gx > 7 || move.gy < 0 || move.gy > 7) return false;
+
+    if (model == MOVELOG_MODEL_INDEX) {
+        // Slot by slot, anchors lowest bit first as the move generator walks them
+        u64 bit = 1ULL << (63 - (move.gy * 8 + move.gx));
+        if (!(position->legal[move.slot] & bit)) return false;
+
+        u32 index = u64_popcount(position->legal[move.slot] & (bit - 1));
+        for (u32 k = 0; k < move.slot; k++) index += u64_popcount(position->legal[k]);
+        *out_symbol = index;
+        return true;
+    }
+
+    for (u32 i = 0; i < position->count; i++) {
+        const EvalMove *m = &position->moves[i];
+        if (m->slot != move.slot || m->gx != move.gx || m->gy != move.gy) continue;
+
+        u32 rank = 0;
+        for (u32 j = 0; j < position->count; j++) rank += ranks_ahead(position->moves, j, i);
+        *out_symbol = rank;
+        return true;
+    }
+    return false;
+}
+
+// Move of a symbol, which must be below the position's count or the new game marker
+static ReplayMove position_move(const MoveLogPosition *position, MoveLogModel model, u32 symbol)
+{
+    if (symbol == SYMBOL_NEW_GAME) return (ReplayMove){ .slot = REPLAY_NEW_GAME };
+
+    if (model == MOVELOG_MODEL_INDEX) {
+        u8 slot = 0;
+        while (symbol >= u64_popcount(position->legal[slot])) symbol -= u64_popcount(position->legal[slot++]);
+
+        u64 legal = position->legal[slot];
+        for (u32 k = 0; k < symbol; k++) legal &= legal - 1;
+        u32 cell = 63 - u64_ctz(legal);
+        return (ReplayMove){ .slot = slot, .gx = (i8)(cell & 7), .gy = (i8)(cell >> 3) };
+    }
+
+    // Selection up to the rank, it is almost always 0 or close
+    u8 order[MOVEGEN_MAX_SUCCESSORS];
+    for (u32 i = 0; i < position->count; i++) order[i] = (u8)i;
+    for (u32 r = 0; r <= symbol; r++) {
+        u32 best = r;
+        for (u32 j = r + 1; j < position->count; j++) {
+            if (ranks_ahead(position->moves, order[j], order[best])) best = j;
+        }
+        u8 t = order[r];
+        order[r] = order[best];
+        order[best] = t;
+    }
+
+    const EvalMove *m = &position->moves[order[symbol]];
+    return (ReplayMove){ .slot = m->slot, .gx = m->gx, .gy = m->gy };
+}
+
+// Interval of a symbol and the total it is coded over
+static u32 position_interval(const MoveLogPosition *position, MoveLogModel model, const MoveLogRanks *ranks, u32 symbol,
+                             u32 *out_start, u32 *out_size)
+{
+    if (model == MOVELOG_MODEL_RANKED) return ranks_interval(ranks, position->count, symbol, out_start, out_size);
+
+    // Uniform, the new game marker last
+    *out_start = symbol == SYMBOL_NEW_GAME ? position->count : symbol;
+    *out_size = 1;
+    return position->count + 1;
+}
+
+
+// RANGE ENCODER
+static bool writer_put(MoveLogWriter *writer, u8 byte)
+{
+    writer->buffer[writer->buffered++] = byte;
+    writer->payload_bytes++;
+    if (writer->buffered < sizeof(writer->buffer)) return true;
+
+    bool ok = fwrite(writer->buffer, 1, writer->buffered, writer->file) == writer->buffered;
+    writer->buffered = 0;
+    return ok;
+}
+
+// Top byte of low leaves, unless it may still take a carry: 0xFF bytes wait in the run
+static bool encoder_shift(MoveLogWriter *writer)
+{
+    bool ok = true;
+    if ((u32)writer->low < 0xFF000000u || (writer->low >> 32) != 0) {
+        u8 carry = (u8)(writer->low >> 32);
+        u8 byte = writer->cache;
+        do {
+            ok = writer_put(writer, (u8)(byte + carry)) && ok;
+            byte = 0xFF;
+        } while (--writer->cache_run != 0);
+        writer->cache = (u8)(writer->low >> 24);
+    }
+    writer->cache_run++;
+    writer->low = (writer->low & 0x00FFFFFF) << 8;
+    return ok;
+}
+
+static bool encoder_encode(MoveLogWriter *writer, u32 start, u32 size, u32 total)
+{
+    u32 r = writer->range / total;
+    writer->low += (u64)r * start;
+    writer->range = r * size;
+
+    bool ok = true;
+    while (writer->range < RANGE_TOP) {
+        writer->range <<= 8;
+        ok = encoder_shift(writer) && ok;
+    }
+    return ok;
+}
+
+
+bool MoveLogWriter_Create(MoveLogWriter *writer, const char *path, const GameState *initial, MoveLogModel model)
+{
+    memset(writer, 0, sizeof(*writer));
+    if (model >= MOVELOG_MODEL_COUNT) return false;
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return false;
+
+    snapshot_copy(&writer->state, initial, false);
+    ranks_init(&writer->ranks);
+    writer->model = model;
+    writer->range = 0xFFFFFFFF;
+    writer->cache_run = 1;
+
+    // Counts are filled in by Finish
+    MoveLogHeader header = {
+        .magic = MOVELOG_MAGIC,
+        .version = MOVELOG_VERSION,
+        .model = model};
+    return fwrite(&header, sizeof(header), 1, writer->file) == 1 && fwrite(initial, sizeof(GameState), 1, writer->file) == 1;
+}
+
+bool MoveLogWriter_Append(MoveLogWriter *writer, ReplayMove move)
+{
+    MoveLogPosition position;
+    position_moves(&writer->state, writer->model, &position);
+
+    u32 symbol;
+    if (!position_symbol(&position, writer->model, move, &symbol)) return false;
+
+    GameState next;
+    snapshot_copy(&next, &writer->state, false);
+    if (!Replay_ApplyMove(&next, move)) return false;
+
+    // Nothing to place: the new game is the only move, it costs nothing
+    if (position.count > 0) {
+        u32 start, size;
+        u32 total = position_interval(&position, writer->model, &writer->ranks, symbol, &start, &size);
+        if (!encoder_encode(writer, start, size, total)) return false;
+        if (writer->model == MOVELOG_MODEL_RANKED) ranks_update(&writer->ranks, symbol);
+    }
+
+    snapshot_copy(&writer->state, &next, false);
+    writer->move_count++;
+    return true;
+}
+
+bool MoveLogWriter_Finish(MoveLogWriter *writer)
+{
+    // Five shifts push out the cache and all four bytes of low
+    bool ok = true;
+    for (u32 i = 0; i < 5; i++) ok = encoder_shift(writer) && ok;
+    ok = ok && fwrite(writer->buffer, 1, writer->buffered, writer->file) == writer->buffered;
+
+    MoveLogHeader header = {
+        .magic = MOVELOG_MAGIC,
+        .version = MOVELOG_VERSION,
+        .model = writer->model,
+        .move_count = writer->move_count,
+        .payload_bytes = writer->payload_bytes};
+    ok = ok && fseek(writer->file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer->file) == 1;
+
+    ok = (fclose(writer->file) == 0) && ok;
+    writer->file = NULL;
+    return ok;
+}
+
+
+// RANGE DECODER
+// Past the end of the payload reads zeros, what the encoder's flush stands for
+static inline u8 reader_byte(MoveLogReader *reader)
+{
+    return reader->payload < reader->payload_end ? *reader->payload++ : 0;
+}
+
+bool MoveLogReader_Open(MoveLogReader *reader, const char *path)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (usize)st.st_size < sizeof(MoveLogHeader) + sizeof(GameState)) {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (usize)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    reader->map = (const u8 *)map;
+    reader->size = (usize)st.st_size;
+
+    // Read once front to back, read ahead and drop behind
+    madvise(map, reader->size, MADV_SEQUENTIAL);
+
+    const MoveLogHeader *header = (const MoveLogHeader *)reader->map;
+    bool valid = header->magic == MOVELOG_MAGIC && header->version == MOVELOG_VERSION &&
+                 header->model < MOVELOG_MODEL_COUNT &&
+                 sizeof(MoveLogHeader) + sizeof(GameState) + header->payload_bytes == reader->size;
+    if (!valid) {
+        MoveLogReader_Close(reader);
+        return false;
+    }
+
+    snapshot_copy(&reader->state, (const GameState *)(reader->map + sizeof(MoveLogHeader)), false);
+    reader->payload = reader->map + sizeof(MoveLogHeader) + sizeof(GameState);
+    reader->payload_end = reader->map + reader->size;
+    reader->model = (MoveLogModel)header->model;
+    reader->move_count = header->move_count;
+    ranks_init(&reader->ranks);
+
+    reader->range = 0xFFFFFFFF;
+    for (u32 i = 0; i < 5; i++) reader->code = (reader->code << 8) | reader_byte(reader);
+    return true;
+}
+
+void MoveLogReader_Close(MoveLogReader *reader)
+{
+    if (reader->map) munmap((void *)reader->map, reader->size);
+    memset(reader, 0, sizeof(*reader));
+}
+
+bool MoveLogReader_Next(MoveLogReader *reader, ReplayMove *out_move)
+{
+    if (reader->moves_read >= reader->move_count) return false;
+
+    MoveLogPosition position;
+    position_moves(&reader->state, reader->model, &position);
+
+    u32 symbol = SYMBOL_NEW_GAME;
+    if (position.count > 0) {
+        // Total first, then the symbol whose interval holds the code
+        u32 start, size;
+        u32 total = position_interval(&position, reader->model, &reader->ranks, SYMBOL_NEW_GAME, &start, &size);
+        u32 r = reader->range / total;
+        u32 target = reader->code / r;
+        if (target >= total) return false;
+
+        if (target >= start) {
+            symbol = SYMBOL_NEW_GAME;
+        } else if (reader->model == MOVELOG_MODEL_INDEX) {
+            symbol = target;
+            start = target;
+            size = 1;
+        } else {
+            u32 s = 0;
+            start = 0;
+            while (start + reader->ranks.freq[s] <= target) start += reader->ranks.freq[s++];
+            symbol = s;
+            size = reader->ranks.freq[s];
+        }
+
+        reader->code -= r * start;
+        reader->range = r * size;
+        while (reader->range < RANGE_TOP) {
+            reader->code = (reader->code << 8) | reader_byte(reader);
+            reader->range <<= 8;
+        }
+        if (reader->model == MOVELOG_MODEL_RANKED) ranks_update(&reader->ranks, symbol);
+    }
+
+    ReplayMove move = position_move(&position, reader->model, symbol);
+    if (!Replay_ApplyMove(&reader->state, move)) return false;
+
+    reader->moves_read++;
+    *out_move = move;
+    return true;
+}
+
+
+bool MoveLog_Compress(const Replay *replay, const char *path, MoveLogModel model, u64 *out_moves)
+{
+    MoveLogWriter writer;
+    if (!MoveLogWriter_Create(&writer, path, Replay_Keyframe(replay, 0), model)) return false;
+
+    bool ok = true;
+    for (u64 k = 0; k < replay->keyframe_count && ok; k++) {
+        u32 count;
+        const ReplayMove *moves = Replay_ChunkMoves(replay, k, &count);
+        for (u32 i = 0; i < count && ok; i++) ok = MoveLogWriter_Append(&writer, moves[i]);
+    }
+
+    if (out_moves) *out_moves = writer.move_count;
+    return MoveLogWriter_Finish(&writer) && ok;
+}
+
+bool MoveLog_Expand(const char *path, const char *replay_path, u32 keyframe_interval, u64 *out_moves)
+{
+    MoveLogReader reader;
+    if (!MoveLogReader_Open(&reader, path)) return false;
+
+    ReplayWriter writer;
+    if (!ReplayWriter_Create(&writer, replay_path, &reader.state, keyframe_interval)) {
+        MoveLogReader_Close(&reader);
+        return false;
+    }
+
+    bool ok = true;
+    ReplayMove move;
+    while (ok && MoveLogReader_Next(&reader, &move)) ok = ReplayWriter_Append(&writer, move);
+    ok = ok && reader.moves_read == reader.move_count;
+
+    if (out_moves) *out_moves = reader.moves_read;
+    ok = ReplayWriter_Finish(&writer) && ok;
+    MoveLogReader_Close(&reader);
+    return ok;
+}
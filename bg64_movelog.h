@@ -0,0 +1,110 @@
+#ifndef BG64_MOVELOG_H_
+#define BG64_MOVELOG_H_
+
+
+#include <stdio.h>
+#include "bg64.h"
+#include "bg64_movegen.h"
+#include "bg64_replay.h"
+
+
+// RANGE CODED MOVE LOGS
+// The pieces follow from the seed, so a move log only has to say which of the legal moves
+// was played. Writer and reader both keep the game going, enumerate the legal (slot,
+// anchor) moves of every position through the move generator and range code the index of
+// the chosen one:
+//
+//   MoveLogHeader           64 bytes
+//   GameState               256 bytes, the initial state
+//   range coded moves       payload_bytes
+//
+// MOVELOG_MODEL_INDEX codes the index uniformly, log2(legal moves + 1) bits a move (the
+// + 1 is the new game marker). MOVELOG_MODEL_RANKED orders the moves by the default board
+// evaluation first and codes the rank with adaptive frequencies, so a player that mostly
+// agrees with the evaluation costs a fraction of a bit a move. The default weights are
+// multiples of 1/4 on integer features, every sum is exact whatever the vector width, so
+// any build ranks the same way. A new game with nothing left to place costs no bits.
+//
+// Logs are for archiving and are read front to back; MoveLog_Expand writes a seekable
+// replay back out.
+#define MOVELOG_MAGIC 0x4C4D4742 // "BGML"
+#define MOVELOG_VERSION 1
+#define MOVELOG_SYMBOLS (MOVEGEN_MAX_SUCCESSORS + 1) // ranks, then the new game marker
+
+typedef enum : u8 {
+    MOVELOG_MODEL_INDEX = 0,
+    MOVELOG_MODEL_RANKED,
+    MOVELOG_MODEL_COUNT
+} MoveLogModel;
+
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u8 model;
+    u8 _pad[7];
+    u64 move_count;
+    u64 payload_bytes;
+    u8 _reserved[32];
+} MoveLogHeader; // 64 bytes
+
+_Static_assert(sizeof(MoveLogHeader) == 64, "MoveLogHeader is 64 bytes on disk");
+
+// Adaptive rank frequencies, coded over the ranks that exist in the position only
+typedef struct
+{
+    u16 freq[MOVELOG_SYMBOLS];
+    u32 total;
+} MoveLogRanks;
+
+typedef struct
+{
+    FILE *file;
+    GameState state;         // the game as of the next move
+    MoveLogRanks ranks;
+    MoveLogModel model;
+    u64 move_count;
+    u64 payload_bytes;
+
+    // Range encoder: carries ripple through the cached byte and the run of 0xFF after it
+    u64 low;
+    u32 range;
+    u8 cache;
+    u64 cache_run;
+    u32 buffered;
+    u8 buffer[4096];
+} MoveLogWriter;
+
+bool MoveLogWriter_Create(MoveLogWriter *writer, const char *path, const GameState *initial, MoveLogModel model);
+bool MoveLogWriter_Append(MoveLogWriter *writer, ReplayMove move); // false: illegal move, nothing coded
+bool MoveLogWriter_Finish(MoveLogWriter *writer);
+
+// Reading: the payload is decoded straight out of a read only mapping
+typedef struct
+{
+    const u8 *map;
+    usize size;
+    const u8 *payload;
+    const u8 *payload_end;
+    GameState state;         // the game as of the next move, the initial state after Open
+    MoveLogRanks ranks;
+    MoveLogModel model;
+    u64 move_count;
+    u64 moves_read;
+
+    u32 range;
+    u32 code;
+} MoveLogReader;
+
+bool MoveLogReader_Open(MoveLogReader *reader, const char *path);
+void MoveLogReader_Close(MoveLogReader *reader);
+
+// Next move, applied to reader->state. false at the end or on a corrupt payload.
+bool MoveLogReader_Next(MoveLogReader *reader, ReplayMove *out_move);
+
+// Whole replays both ways, out_moves gets the move count
+bool MoveLog_Compress(const Replay *replay, const char *path, MoveLogModel model, u64 *out_moves);
+bool MoveLog_Expand(const char *path, const char *replay_path, u32 keyframe_interval, u64 *out_moves);
+
+
+#endif /* BG64_MOVELOG_H_ */
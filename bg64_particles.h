@@ -0,0 +1,52 @@
+#ifndef BG64_PARTICLES_H_
+#define BG64_PARTICLES_H_
+
+
+#include "bg64.h"
+
+
+// PARTICLE POOL
+// Fixed capacity, struct of arrays, carved from the Arena once at startup: emitting and
+// updating never allocate. Every field is its own 64 byte aligned f32 array so the
+// integrate loop is straight line code the compiler turns into 8 or 16 wide vector math.
+// Dead particles are removed by swapping the last live one into their place, order is
+// irrelevant for additive looking effects.
+typedef struct ParticlePool
+{
+    f32 *x;
+    f32 *y;
+    f32 *vx;
+    f32 *vy;
+    f32 *life;       // seconds left
+    f32 *inv_span;   // 1 / starting life, alpha fades with life * inv_span
+    f32 *size;       // edge length in pixels
+    Color *color;
+    u32 count;       // live particles, always the first count entries
+    u32 capacity;
+    u64 rng;
+} ParticlePool;
+
+#define PARTICLE_CAPACITY 16384
+#define PARTICLE_GRAVITY 900.0f // pixels / s^2
+
+ParticlePool Particles_Allocation(Arena *arena, u32 capacity, u64 seed);
+void Particles_Clear(ParticlePool *pool);
+
+// false when the pool is full, the particle is dropped
+bool Particles_Emit(ParticlePool *pool, Vector2 pos, Vector2 vel, f32 life, f32 size, Color color);
+
+// count particles flung out of pos in random directions at up to speed
+void Particles_Burst(ParticlePool *pool, Vector2 pos, u32 count, f32 speed, f32 life, Color color);
+
+// per_cell particles from the center of every cell in mask. colors is the nibble packed
+// grid_color to read each cell's palette index from, NULL uses fallback for every cell.
+void Particles_BurstCells(ParticlePool *pool, u64 mask, const u8 *colors, const Color *palette, Color fallback,
+                          u32 per_cell, Vector2 grid_origin, u32 cellSize, f32 speed);
+
+void Particles_Update(ParticlePool *pool, f32 dt);
+
+// Every live particle as one quad batch (one draw call until raylib's batch fills up)
+void Particles_Draw(const ParticlePool *pool);
+
+
+#endif /* BG64_PARTICLES_H_ */
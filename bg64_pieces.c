@@ -0,0 +1,186 @@
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+#include "bg64_pieces.h"
+#include "bg64_board.h"
+#include "bg64_movegen.h"
+#include "bg64_rng.h"
+
+
+_Static_assert(SHAPE_OPTIONS + COLOR_OPTIONS <= 2 * sizeof(((GameState *)0)->grid.piece_weights),
+               "every custom weight needs a nibble");
+
+static PieceDistribution PIECE_DISTRIBUTIONS[PIECE_MODE_COUNT];
+static pthread_once_t piece_distributions_once = PTHREAD_ONCE_INIT;
+
+void AliasTable_Build(AliasTable *table, const f32 *weights, u32 count)
+{
+    if (count > ALIAS_MAX_COLUMNS) count = ALIAS_MAX_COLUMNS;
+    table->count = count;
+
+    f64 sum = 0;
+    for (u32 i = 0; i < count; i++) sum += weights[i] > 0 ? weights[i] : 0;
+
+    // Vose: columns scaled so the mean is 1, each small one is topped up by a large one
+    // that gives away the difference and goes back on the list it now belongs to
+    f64 scaled[ALIAS_MAX_COLUMNS];
+    u8 small[ALIAS_MAX_COLUMNS], large[ALIAS_MAX_COLUMNS];
+    u32 small_count = 0, large_count = 0;
+    for (u32 i = 0; i < count; i++) {
+        f64 w = weights[i] > 0 ? weights[i] : 0;
+        scaled[i] = sum > 0 ? w * count / sum : 1.0;
+        if (scaled[i] < 1.0) small[small_count++] = (u8)i;
+        else large[large_count++] = (u8)i;
+    }
+
+    while (small_count && large_count) {
+        u8 s = small[--small_count];
+        u8 l = large[--large_count];
+
+        table->threshold[s] = scaled[s] > 0 ? (u32)(scaled[s] * 4294967296.0) : 0;
+        table->alias[s] = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) small[small_count++] = l;
+        else large[large_count++] = l;
+    }
+
+    // What is left is 1 up to rounding: the column always keeps itself
+    while (large_count) {
+        u8 l = large[--large_count];
+        table->threshold[l] = UINT32_MAX;
+        table->alias[l] = l;
+    }
+    while (small_count) {
+        u8 s = small[--small_count];
+        table->threshold[s] = UINT32_MAX;
+        table->alias[s] = s;
+    }
+}
+
+static void piece_distributions_build(void)
+{
+    f32 uniform_colors[COLOR_OPTIONS];
+    for (u32 c = 0; c < COLOR_OPTIONS; c++) uniform_colors[c] = 1.0f;
+
+    f32 relaxed[SHAPE_OPTIONS], hard[SHAPE_OPTIONS], uniform[SHAPE_OPTIONS];
+    for (u32 s = 0; s < SHAPE_OPTIONS; s++) {
+        relaxed[s] = 1.0f / SHAPE_INFO[s + 1].cells;
+        hard[s] = (f32)SHAPE_INFO[s + 1].cells;
+        uniform[s] = 1.0f;
+    }
+
+    const f32 *shape_weights[PIECE_MODE_COUNT] = {
+        [PIECE_MODE_CLASSIC] = uniform,
+        [PIECE_MODE_RELAXED] = relaxed,
+        [PIECE_MODE_HARD] = hard,
+        [PIECE_MODE_CUSTOM] = uniform};
+
+    for (u32 m = 0; m < PIECE_MODE_COUNT; m++) {
+        PieceDistribution *d = &PIECE_DISTRIBUTIONS[m];
+        AliasTable_Build(&d->shapes, shape_weights[m], SHAPE_OPTIONS);
+        AliasTable_Build(&d->colors, uniform_colors, COLOR_OPTIONS);
+        d->classic = m == PIECE_MODE_CLASSIC;
+    }
+}
+
+const PieceDistribution *Pieces_Distribution(u8 mode)
+{
+    pthread_once(&piece_distributions_once, piece_distributions_build);
+    return &PIECE_DISTRIBUTIONS[mode < PIECE_MODE_COUNT ? mode : PIECE_MODE_CLASSIC];
+}
+
+void Pieces_BuildCustom(const u8 *piece_weights, PieceDistribution *out)
+{
+    f32 shapes[SHAPE_OPTIONS], colors[COLOR_OPTIONS];
+    for (u32 s = 0; s < SHAPE_OPTIONS; s++) shapes[s] = (f32)Pieces_WeightLevel(piece_weights, s);
+    for (u32 c = 0; c < COLOR_OPTIONS; c++) colors[c] = (f32)Pieces_WeightLevel(piece_weights, SHAPE_OPTIONS + c);
+
+    AliasTable_Build(&out->shapes, shapes, SHAPE_OPTIONS);
+    AliasTable_Build(&out->colors, colors, COLOR_OPTIONS);
+    out->classic = false;
+}
+
+const PieceDistribution *Pieces_StateDistribution(const GameState *state)
+{
+    if (state->session.piece_mode != PIECE_MODE_CUSTOM) return Pieces_Distribution(state->session.piece_mode);
+
+    // Refills of one game ask for the same weights over and over, build them once
+    static _Thread_local struct
+    {
+        bool valid;
+        u8 weights[sizeof(state->grid.piece_weights)];
+        PieceDistribution distribution;
+    } custom;
+
+    if (!custom.valid || memcmp(custom.weights, state->grid.piece_weights, sizeof(custom.weights)) != 0) {
+        memcpy(custom.weights, state->grid.piece_weights, sizeof(custom.weights));
+        Pieces_BuildCustom(custom.weights, &custom.distribution);
+        custom.valid = true;
+    }
+    return &custom.distribution;
+}
+
+static void pieces_store_levels(u8 *piece_weights, const f32 *weights, u32 first, u32 count)
+{
+    f32 max = 0;
+    for (u32 i = 0; i < count; i++) max = weights[i] > max ? weights[i] : max;
+
+    for (u32 i = 0; i < count; i++) {
+        u32 level = 0;
+        if (max > 0 && weights[i] > 0) {
+            level = (u32)(weights[i] * PIECE_WEIGHT_LEVELS / max + 0.5f);
+            if (level == 0) level = 1;
+        }
+        u32 n = first + i;
+        u8 shift = (n & 1) ? 0 : 4;
+        piece_weights[n >> 1] = (u8)((piece_weights[n >> 1] & ~(0x0F << shift)) | (level << shift));
+    }
+}
+
+void Pieces_SetCustomWeights(GameState *state, const f32 *shape_weights, const f32 *color_weights)
+{
+    if (shape_weights) pieces_store_levels(state->grid.piece_weights, shape_weights, 0, SHAPE_OPTIONS);
+    if (color_weights) pieces_store_levels(state->grid.piece_weights, color_weights, SHAPE_OPTIONS, COLOR_OPTIONS);
+}
+
+void Pieces_BoardWeights(const f32 *base, u64 grid, f32 bias, f32 *out_weights)
+{
+    for (u32 s = 0; s < SHAPE_OPTIONS; s++) {
+        const ShapeInfo *shape = &SHAPE_INFO[s + 1];
+        f32 spots = (f32)u64_popcount(MoveGen_LegalAnchors(grid, shape));
+        f32 empty = (f32)u64_popcount(shape->anchors);
+        out_weights[s] = base[s] * powf((spots + 1.0f) / (empty + 1.0f), bias);
+    }
+}
+
+void Pieces_Fill(const PieceDistribution *distribution, u64 *seed, u8 *out, u32 count)
+{
+    // Split on the mode once, the loops then inline the draw
+    if (distribution->classic) {
+        for (u32 i = 0; i < count; i++) out[i] = generate_composite_byte(seed);
+        return;
+    }
+
+    // Local copies: stores through out may alias the tables, the counts would be reloaded
+    AliasTable shapes = distribution->shapes;
+    AliasTable colors = distribution->colors;
+    u64 x = *seed;
+    for (u32 i = 0; i < count; i++) {
+        // xorshift, kept in a register across the loop
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        u64 r = x;
+        u8 shape = (u8)(AliasTable_Sample(&shapes, (u32)r) + 1);
+        u8 color = (u8)(AliasTable_Sample(&colors, (u32)(r >> 32)) + 1);
+        out[i] = MAKE_COMPOSITE(shape, color);
+    }
+    *seed = x;
+}
+
+u8 Pieces_At(const PieceDistribution *distribution, u64 seed, u64 index)
+{
+    xorshift_jump(&seed, index);
+    return Pieces_Draw(distribution, &seed);
+}
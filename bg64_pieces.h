@@ -0,0 +1,106 @@
+#ifndef BG64_PIECES_H_
+#define BG64_PIECES_H_
+
+
+#include "bg64.h"
+
+
+// WEIGHTED PIECE DISTRIBUTIONS
+// Each piece mode deals shapes and colors from its own weights. A weighted draw is one
+// table lookup (Walker's alias method): column i of an alias table keeps its own value
+// with probability threshold / 2^32 and gives its alias otherwise, so one multiply by the
+// column count picks the column from the high half of the product and the coin is the low
+// half. Tables are rebuilt in O(count) whenever the weights change, a board dependent mode
+// can afford a rebuild per deck.
+//
+// A piece still takes exactly one xorshift step, shape from the low 32 bits and color from
+// the high 32, so xorshift_jump indexes every mode's stream like the classic one.
+// PIECE_MODE_CLASSIC keeps the original modulo draw bit for bit: saves, replays and the
+// perft reference counts were all dealt by it.
+//
+// CUSTOM weights travel with the game: game_grid.piece_weights holds them as 4 bit levels,
+// so saves, replay keyframes and move logs deal the same pieces after a restart and every
+// session has its own. All zero levels deal uniformly.
+#define ALIAS_MAX_COLUMNS 32
+#define PIECE_WEIGHT_LEVELS 15 // a custom weight is 0..15, the shapes' nibbles first, then the colors'
+
+typedef enum : u8 {
+    PIECE_MODE_CLASSIC = 0, // uniform, r % SHAPE_OPTIONS as generate_composite_byte
+    PIECE_MODE_RELAXED,     // small shapes more often: weight 1 / cells
+    PIECE_MODE_HARD,        // big shapes more often: weight cells
+    PIECE_MODE_CUSTOM,      // the state's piece_weights, Pieces_SetCustomWeights
+    PIECE_MODE_COUNT
+} PieceMode;
+
+typedef struct
+{
+    u32 threshold[ALIAS_MAX_COLUMNS]; // coin below it keeps the column
+    u8 alias[ALIAS_MAX_COLUMNS];
+    u32 count;
+} AliasTable;
+
+typedef struct
+{
+    AliasTable shapes;  // column s - 1 deals shape s
+    AliasTable colors;  // column c - 1 deals color c
+    bool classic;       // legacy modulo draw, the tables are not used
+} PieceDistribution;
+
+// weights[0..count), any scale, negative counts as 0. All zero falls back to uniform.
+void AliasTable_Build(AliasTable *table, const f32 *weights, u32 count);
+
+static inline u32 AliasTable_Sample(const AliasTable *table, u32 r)
+{
+    u64 product = (u64)r * table->count;
+    u32 column = (u32)(product >> 32);
+
+    // Select without a branch, the coin is a coin flip to the predictor
+    u32 keep = 0u - (u32)((u32)product < table->threshold[column]);
+    return (column & keep) | (table->alias[column] & ~keep);
+}
+
+// Distribution of a mode, out of range modes deal classic and CUSTOM deals uniformly
+const PieceDistribution *Pieces_Distribution(u8 mode);
+
+// Distribution a game deals from: its mode, with its own weights for CUSTOM. A custom one
+// lives in a per thread cache and stays valid until the same thread asks for other weights.
+const PieceDistribution *Pieces_StateDistribution(const GameState *state);
+
+// Tables for CUSTOM weights, piece_weights as in game_grid
+void Pieces_BuildCustom(const u8 *piece_weights, PieceDistribution *out);
+
+// Stores CUSTOM weights in the state, scaled so the largest is PIECE_WEIGHT_LEVELS and a
+// positive weight never rounds to 0. shape_weights holds SHAPE_OPTIONS entries (shape 1
+// first), color_weights COLOR_OPTIONS, NULL keeps that half as it is. The state deals them
+// once its piece_mode is PIECE_MODE_CUSTOM.
+void Pieces_SetCustomWeights(GameState *state, const f32 *shape_weights, const f32 *color_weights);
+
+// Level of custom weight i: shape s is s - 1, color c is SHAPE_OPTIONS + c - 1
+static inline u32 Pieces_WeightLevel(const u8 *piece_weights, u32 i)
+{
+    return (piece_weights[i >> 1] >> ((i & 1) ? 0 : 4)) & 0x0F;
+}
+
+// Board dependent weights: base scaled by ((spots + 1) / (empty board spots + 1))^bias,
+// spots being where the shape fits on grid. bias > 0 favors shapes that still fit,
+// bias < 0 the ones that do not.
+void Pieces_BoardWeights(const f32 *base, u64 grid, f32 bias, f32 *out_weights);
+
+static inline u8 Pieces_Draw(const PieceDistribution *distribution, u64 *seed)
+{
+    if (distribution->classic) return generate_composite_byte(seed);
+
+    u64 r = xorshift(seed);
+    u8 shape = (u8)(AliasTable_Sample(&distribution->shapes, (u32)r) + 1);
+    u8 color = (u8)(AliasTable_Sample(&distribution->colors, (u32)(r >> 32)) + 1);
+    return MAKE_COMPOSITE(shape, color);
+}
+
+// count pieces in stream order, the same bytes as count Pieces_Draw calls
+void Pieces_Fill(const PieceDistribution *distribution, u64 *seed, u8 *out, u32 count);
+
+// Piece at position index of the stream, piece_at for any mode
+u8 Pieces_At(const PieceDistribution *distribution, u64 seed, u64 index);
+
+
+#endif /* BG64_PIECES_H_ */
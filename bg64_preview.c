@@ -0,0 +1,50 @@
+#include "bg64_preview.h"
+#include "bg64_board.h"
+
+
+void Preview_Invalidate(PlacementPreview *preview)
+{
+    preview->active = false;
+    preview->slot = 0xFF; // no real slot, the next update always misses
+}
+
+bool Preview_Update(PlacementPreview *preview, const GameState *state, u32 offsetX, u32 offsetY, u32 cellSize)
+{
+    if (!state->session.is_dragging) {
+        Preview_Invalidate(preview);
+        return false;
+    }
+
+    int gx, gy;
+    DragSnapCell(state, offsetX, offsetY, cellSize, &gx, &gy);
+
+    u8 slot = state->session.dragging_slot_index;
+    u8 composite = state->session.deck_shape_color_bits[slot];
+    u64 board = state->grid.game_grid;
+
+    // Hit: same piece over the same cell of the same board
+    if (preview->slot == slot && preview->composite == composite && preview->gx == gx &&
+        preview->gy == gy && preview->board == board) {
+        preview->active = true;
+        return false;
+    }
+
+    u64 placed = 0;
+    u32 lines = 0;
+    bool legal = board8_try_place_anchor(board, &SHAPE_INFO[GET_SHAPE(composite)], gx, gy, &placed);
+
+    *preview = (PlacementPreview){
+        .board = board,
+        .placed_mask = legal ? placed : 0,
+        .clear_mask = legal ? board8_full_lines(board | placed, &lines) : 0,
+        .recomputes = preview->recomputes + 1,
+        .slot = slot,
+        .composite = composite,
+        .gx = (i8)gx,
+        .gy = (i8)gy,
+        .lines = (u8)lines,
+        .legal = legal,
+        .active = true};
+
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef BG64_PREVIEW_H_
+#define BG64_PREVIEW_H_
+
+
+#include "bg64.h"
+
+
+// PLACEMENT PREVIEW
+// While a piece is dragged the renderer shows where it would land and which lines it
+// would clear. The snapped cell only changes a few times per second, so the placement
+// mask and predicted clears are cached under (slot, piece, gx, gy, board) and only
+// recomputed when one of those changes; rendering just reads the masks.
+typedef struct PlacementPreview
+{
+    u64 board;        // game_grid the cache was computed against
+    u64 placed_mask;  // cells the piece would fill, 0 when the drop is illegal
+    u64 clear_mask;   // cells of every line the drop would clear
+    u32 recomputes;   // cache misses, for profiling
+    u8 slot;
+    u8 composite;
+    i8 gx;
+    i8 gy;
+    u8 lines;         // rows + columns the drop would clear
+    bool legal;
+    bool active;      // a piece is being dragged and the fields above are current
+} PlacementPreview;
+
+void Preview_Invalidate(PlacementPreview *preview);
+
+// Refreshes the cache from the current drag, returns true when it had to recompute
+bool Preview_Update(PlacementPreview *preview, const GameState *state, u32 offsetX, u32 offsetY, u32 cellSize);
+
+
+#endif /* BG64_PREVIEW_H_ */
@@ -0,0 +1,128 @@
+#include "bg64_reference.h"
+
+
+static inline u64 cell_bit(int x, int y)
+{
+    return 1ULL << (63 - (y * 8 + x));
+}
+
+static void set_cell_color(u8 *colors, int x, int y, u8 color)
+{
+    // Two cells per byte, the even cell in the high nibble
+    int cell = y * 8 + x;
+    if (cell % 2 == 0) colors[cell / 2] = (u8)((colors[cell / 2] & 0x0F) | (color << 4));
+    else colors[cell / 2] = (u8)((colors[cell / 2] & 0xF0) | (color & 0x0F));
+}
+
+bool Reference_TryPlace(const GameState *state, u8 slot_idx, int gx, int gy, u64 *out_mask)
+{
+    u64 shape = SHAPE_LIBRARY[GET_SHAPE(state->session.deck_shape_color_bits[slot_idx])];
+    if (shape == 0) return false;
+
+    // Every cell of the shape must land on the board and on an empty cell
+    u64 mask = 0;
+    for (int sy = 0; sy < 8; sy++) {
+        for (int sx = 0; sx < 8; sx++) {
+            if (!(shape & cell_bit(sx, sy))) continue;
+
+            int x = gx + sx;
+            int y = gy + sy;
+            if (x < 0 || x >= 8 || y < 0 || y >= 8) return false;
+            if (state->grid.game_grid & cell_bit(x, y)) return false;
+
+            mask |= cell_bit(x, y);
+        }
+    }
+
+    *out_mask = mask;
+    return true;
+}
+
+void Reference_BakeColorsIntoGrid(GameState *state, u64 mask, u8 slot_index)
+{
+    u8 color = GET_COLOR(state->session.deck_shape_color_bits[slot_index]);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            if (mask & cell_bit(x, y)) set_cell_color(state->grid.grid_color, x, y, color);
+        }
+    }
+}
+
+u32 Reference_ClearLinesAndColors(GameState *state, u64 *out_clear_mask)
+{
+    u64 grid = state->grid.game_grid;
+    u64 clear = 0;
+    u32 lines = 0;
+
+    // Rows and columns are both judged on the board before anything is removed
+    for (int y = 0; y < 8; y++) {
+        bool full = true;
+        for (int x = 0; x < 8; x++) full = full && (grid & cell_bit(x, y));
+        if (!full) continue;
+
+        lines++;
+        for (int x = 0; x < 8; x++) clear |= cell_bit(x, y);
+    }
+
+    for (int x = 0; x < 8; x++) {
+        bool full = true;
+        for (int y = 0; y < 8; y++) full = full && (grid & cell_bit(x, y));
+        if (!full) continue;
+
+        lines++;
+        for (int y = 0; y < 8; y++) clear |= cell_bit(x, y);
+    }
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            if (!(clear & cell_bit(x, y))) continue;
+            state->grid.game_grid &= ~cell_bit(x, y);
+            set_cell_color(state->grid.grid_color, x, y, 0);
+        }
+    }
+
+    state->session.current_score += lines * 10;
+
+    if (out_clear_mask) *out_clear_mask = clear;
+    return lines;
+}
+
+bool Reference_ApplyMove(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result)
+{
+    if (slot_idx > 2 || state->session.is_active[slot_idx]) return false;
+
+    u64 mask;
+    if (!Reference_TryPlace(state, slot_idx, gx, gy, &mask)) return false;
+
+    u64 score_before = state->session.current_score;
+
+    state->grid.game_grid |= mask;
+    Reference_BakeColorsIntoGrid(state, mask, slot_idx);
+
+    u64 clear_mask;
+    u32 lines = Reference_ClearLinesAndColors(state, &clear_mask);
+
+    state->session.is_active[slot_idx] = true;
+
+    // Last piece of the deck placed: three new pieces from the queue, then top it up
+    bool refilled = state->session.is_active[0] && state->session.is_active[1] && state->session.is_active[2];
+    if (refilled) {
+        for (u8 k = 0; k < 3; k++) {
+            state->session.deck_shape_color_bits[k] = ring_buffer_consume(state);
+            state->session.is_active[k] = false;
+        }
+        fill_queue(state);
+    }
+
+    if (out_result) {
+        out_result->placed_mask = mask;
+        out_result->clear_mask = clear_mask;
+        out_result->score_delta = (u32)(state->session.current_score - score_before);
+        out_result->lines = (u8)lines;
+        out_result->slot = slot_idx;
+        out_result->deck_refilled = refilled;
+    }
+
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef BG64_REFERENCE_H_
+#define BG64_REFERENCE_H_
+
+
+#include "bg64.h"
+
+
+// REFERENCE ENGINE
+// The placement rules written out cell by cell straight from the game definition, with no
+// anchor tables, SWAR line detection or set bit walks. Nothing in the game calls these:
+// they are the oracle every optimized kernel (TryPlace, BakeColorsIntoGrid,
+// ClearLinesAndColors, ApplyMove, Batch_Step) is checked against by tools/oracle, so keep
+// them obvious rather than fast.
+
+bool Reference_TryPlace(const GameState *state, u8 slot_idx, int gx, int gy, u64 *out_mask);
+void Reference_BakeColorsIntoGrid(GameState *state, u64 mask, u8 slot_index);
+u32 Reference_ClearLinesAndColors(GameState *state, u64 *out_clear_mask);
+
+// Same contract as ApplyMove: false leaves the state untouched
+bool Reference_ApplyMove(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result);
+
+
+#endif /* BG64_REFERENCE_H_ */
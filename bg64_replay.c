@@ -0,0 +1,230 @@
+#define _GNU_SOURCE     // MAP_POPULATE
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bg64_replay.h"
+#include "bg64_history.h"
+
+#define REPLAY_INDEX_RESERVE ((usize)1 << 32) // address space for the writer's index
+
+
+bool Replay_ApplyMove(GameState *state, ReplayMove move)
+{
+    if (move.slot == REPLAY_NEW_GAME) {
+        // Next game continues the same piece stream, mode and weights, high score carries over
+        u64 high = state->session.high_score > state->session.current_score ? state->session.high_score : state->session.current_score;
+        u8 screen = state->utility.current_screen;
+        GameState_ResetPieces(state, state->utility.rng_seed, state->session.piece_mode, state->grid.piece_weights);
+        state->session.high_score = high;
+        state->utility.current_screen = screen;
+        return true;
+    }
+
+    return ApplyMove(state, move.slot, move.gx, move.gy, NULL);
+}
+
+
+static bool replay_write(ReplayWriter *writer, const void *data, usize size)
+{
+    if (fwrite(data, 1, size, writer->file) != size) return false;
+    writer->offset += size;
+    return true;
+}
+
+static bool replay_pad(ReplayWriter *writer, usize align)
+{
+    static const u8 zeros[64] = { 0 };
+    usize pad = (usize)((align - (writer->offset & (align - 1))) & (align - 1));
+    return pad == 0 || replay_write(writer, zeros, pad);
+}
+
+static bool replay_keyframe(ReplayWriter *writer)
+{
+    if (!replay_pad(writer, 64)) return false;
+
+    ReplayIndexEntry *entry = (ReplayIndexEntry *)Arena_Push(&writer->index_arena, sizeof(ReplayIndexEntry), 8);
+    *entry = (ReplayIndexEntry){ writer->move_count, writer->offset };
+    writer->keyframe_count++;
+
+    return replay_write(writer, writer->mirror, sizeof(GameState));
+}
+
+bool ReplayWriter_Create(ReplayWriter *writer, const char *path, const GameState *initial, u32 keyframe_interval)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return false;
+
+    // Mirror first, then the index grows contiguously behind it
+    writer->index_arena = Arena_Reserve(REPLAY_INDEX_RESERVE, 0);
+    writer->mirror = (GameState *)Arena_Push(&writer->index_arena, sizeof(GameState), 64);
+    writer->index = (ReplayIndexEntry *)Arena_Push(&writer->index_arena, 0, 8);
+    snapshot_copy(writer->mirror, initial, false);
+    writer->keyframe_interval = keyframe_interval ? keyframe_interval : REPLAY_DEFAULT_INTERVAL;
+
+    ReplayHeader header = {
+        .magic = REPLAY_MAGIC,
+        .version = REPLAY_VERSION,
+        .keyframe_interval = writer->keyframe_interval};
+
+    return replay_write(writer, &header, sizeof(header)) && replay_keyframe(writer);
+}
+
+bool ReplayWriter_Append(ReplayWriter *writer, ReplayMove move)
+{
+    GameState next;
+    snapshot_copy(&next, writer->mirror, false);
+    if (!Replay_ApplyMove(&next, move)) return false;
+
+    // Keyframes hold the state before the first move of their chunk
+    if (writer->move_count && writer->move_count % writer->keyframe_interval == 0) {
+        if (!replay_keyframe(writer)) return false;
+    }
+    if (!replay_write(writer, &move, sizeof(move))) return false;
+
+    snapshot_copy(writer->mirror, &next, false);
+    writer->move_count++;
+    return true;
+}
+
+bool ReplayWriter_Finish(ReplayWriter *writer)
+{
+    bool ok = replay_pad(writer, 8);
+
+    ReplayFooter footer = {
+        .index_offset = writer->offset,
+        .keyframe_count = writer->keyframe_count,
+        .move_count = writer->move_count,
+        .keyframe_interval = writer->keyframe_interval,
+        .magic = REPLAY_MAGIC};
+    ok = ok && replay_write(writer, writer->index, writer->keyframe_count * sizeof(ReplayIndexEntry));
+    ok = ok && replay_write(writer, &footer, sizeof(footer));
+
+    // Counts go back into the header too, for tools that only read the first bytes
+    ReplayHeader header = {
+        .magic = REPLAY_MAGIC,
+        .version = REPLAY_VERSION,
+        .keyframe_interval = writer->keyframe_interval,
+        .move_count = writer->move_count,
+        .keyframe_count = writer->keyframe_count};
+    ok = ok && fseek(writer->file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer->file) == 1;
+
+    ok = (fclose(writer->file) == 0) && ok;
+    Arena_Release(&writer->index_arena);
+    writer->file = NULL;
+    return ok;
+}
+
+
+// Every index entry is checked once here, so seeking can trust them: keyframes 64 byte
+// aligned after the header, chunk k starting at move k * interval, and each chunk's moves
+// ending before the next keyframe (the index for the last one)
+static bool replay_index_valid(const Replay *replay, u64 index_offset)
+{
+    u64 end = sizeof(ReplayHeader);
+    for (u64 k = 0; k < replay->keyframe_count; k++) {
+        const ReplayIndexEntry *entry = &replay->index[k];
+        if (entry->offset % 64 != 0 || entry->offset < end) return false;
+        if (entry->offset > index_offset || index_offset - entry->offset < sizeof(GameState)) return false;
+
+        // first_move == k * interval keeps first_move strictly increasing, a chunk never
+        // holds more than interval moves
+        if (entry->first_move != k * replay->keyframe_interval || entry->first_move > replay->move_count) return false;
+        u64 next_move = k + 1 < replay->keyframe_count ? replay->index[k + 1].first_move : replay->move_count;
+        if (next_move < entry->first_move || next_move - entry->first_move > replay->keyframe_interval) return false;
+
+        end = entry->offset + sizeof(GameState) + (next_move - entry->first_move) * sizeof(ReplayMove);
+        if (end > index_offset) return false;
+    }
+    return true;
+}
+
+bool Replay_Open(Replay *replay, const char *path)
+{
+    memset(replay, 0, sizeof(*replay));
+
+    i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (usize)st.st_size < sizeof(ReplayHeader) + sizeof(ReplayFooter)) {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (usize)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    replay->map = (const u8 *)map;
+    replay->size = (usize)st.st_size;
+
+    // A file without a footer was never finished (crash mid write)
+    const ReplayHeader *header = (const ReplayHeader *)replay->map;
+    const ReplayFooter *footer = (const ReplayFooter *)(replay->map + replay->size - sizeof(ReplayFooter));
+    u64 index_room = replay->size - sizeof(ReplayFooter);
+    bool valid = header->magic == REPLAY_MAGIC && header->version == REPLAY_VERSION &&
+                 footer->magic == REPLAY_MAGIC && footer->keyframe_count > 0 && footer->keyframe_interval > 0 &&
+                 footer->keyframe_count <= index_room / sizeof(ReplayIndexEntry) && footer->index_offset % 8 == 0 &&
+                 footer->index_offset + footer->keyframe_count * sizeof(ReplayIndexEntry) == index_room;
+    if (valid) {
+        replay->index = (const ReplayIndexEntry *)(replay->map + footer->index_offset);
+        replay->move_count = footer->move_count;
+        replay->keyframe_count = footer->keyframe_count;
+        replay->keyframe_interval = footer->keyframe_interval;
+        valid = replay_index_valid(replay, footer->index_offset);
+    }
+    if (!valid) {
+        Replay_Close(replay);
+        return false;
+    }
+
+    // Only the index is touched up front, chunks page in as they are seeked to
+    madvise((void *)replay->map, replay->size, MADV_RANDOM);
+    return true;
+}
+
+void Replay_Close(Replay *replay)
+{
+    if (replay->map) munmap((void *)replay->map, replay->size);
+    memset(replay, 0, sizeof(*replay));
+}
+
+const GameState *Replay_Keyframe(const Replay *replay, u64 k)
+{
+    if (k >= replay->keyframe_count) return NULL;
+    return (const GameState *)(replay->map + replay->index[k].offset);
+}
+
+const ReplayMove *Replay_ChunkMoves(const Replay *replay, u64 k, u32 *out_count)
+{
+    if (k >= replay->keyframe_count) {
+        *out_count = 0;
+        return NULL;
+    }
+
+    u64 end = (k + 1 < replay->keyframe_count) ? replay->index[k + 1].first_move : replay->move_count;
+    *out_count = (u32)(end - replay->index[k].first_move);
+    return (const ReplayMove *)(replay->map + replay->index[k].offset + sizeof(GameState));
+}
+
+bool Replay_Seek(const Replay *replay, u64 move, GameState *out_state)
+{
+    if (move > replay->move_count) return false;
+
+    // The last keyframe also covers a seek to the very end of the replay
+    u64 k = move / replay->keyframe_interval;
+    if (k >= replay->keyframe_count) k = replay->keyframe_count - 1;
+
+    u32 count;
+    const ReplayMove *moves = Replay_ChunkMoves(replay, k, &count);
+    snapshot_copy(out_state, Replay_Keyframe(replay, k), false);
+
+    u64 steps = move - replay->index[k].first_move;
+    if (steps > count) return false;
+    for (u64 i = 0; i < steps; i++) Replay_ApplyMove(out_state, moves[i]);
+
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef BG64_REPLAY_H_
+#define BG64_REPLAY_H_
+
+
+#include <stdio.h>
+#include "bg64.h"
+
+
+// SEEKABLE REPLAYS
+// A replay is the exact GameState every keyframe_interval moves with the moves in between:
+//
+//   ReplayHeader                                     64 bytes
+//   chunk 0: GameState keyframe, moves 0 .. K-1      256 + 4K bytes, padded to 64
+//   chunk 1: GameState keyframe, moves K .. 2K-1
+//   ...
+//   ReplayIndexEntry[keyframes]                      where every chunk starts
+//   ReplayFooter                                     32 bytes, always the last bytes
+//
+// Seeking to move m loads keyframe m / K straight out of the mapping and replays at most
+// K - 1 moves. Keyframes sit at 64 byte aligned offsets, so they are read in place.
+#define REPLAY_MAGIC 0x50524742 // "BGRP"
+#define REPLAY_VERSION 1
+#define REPLAY_DEFAULT_INTERVAL 256
+
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u32 keyframe_interval;
+    u32 _reserved0;
+    u64 move_count;       // also in the footer, which is authoritative
+    u64 keyframe_count;
+    u8 _reserved[32];
+} ReplayHeader; // 64 bytes
+
+typedef struct
+{
+    u8 slot;       // deck slot, or REPLAY_NEW_GAME
+    i8 gx;
+    i8 gy;
+    u8 _pad;
+} ReplayMove; // 4 bytes
+
+// Starts the next game seeded from the current rng_seed, so a long bot session is one replay
+#define REPLAY_NEW_GAME 0xFF
+
+typedef struct
+{
+    u64 first_move;  // index of the first move after the keyframe
+    u64 offset;      // file offset of the keyframe
+} ReplayIndexEntry;
+
+typedef struct
+{
+    u64 index_offset;
+    u64 keyframe_count;
+    u64 move_count;
+    u32 keyframe_interval;
+    u32 magic;
+} ReplayFooter; // 32 bytes
+
+_Static_assert(sizeof(ReplayHeader) == 64, "ReplayHeader keeps keyframes 64 byte aligned");
+_Static_assert(sizeof(ReplayMove) == 4, "ReplayMove is 4 bytes on disk");
+_Static_assert(sizeof(ReplayFooter) == 32, "ReplayFooter is 32 bytes on disk");
+
+
+// Writing: the writer keeps its own copy of the game and applies every move to it, so
+// keyframes always match the moves and illegal moves never reach the file
+typedef struct
+{
+    FILE *file;
+    Arena index_arena;       // ReplayIndexEntry array, grows in place
+    ReplayIndexEntry *index;
+    GameState *mirror;
+    u64 move_count;
+    u64 keyframe_count;
+    u64 offset;              // bytes written so far
+    u32 keyframe_interval;
+} ReplayWriter;
+
+bool ReplayWriter_Create(ReplayWriter *writer, const char *path, const GameState *initial, u32 keyframe_interval);
+bool ReplayWriter_Append(ReplayWriter *writer, ReplayMove move); // false: illegal move, nothing written
+bool ReplayWriter_Finish(ReplayWriter *writer);
+
+// Applies one recorded move to a state, the same way the writer did
+bool Replay_ApplyMove(GameState *state, ReplayMove move);
+
+
+// Reading: everything points into a read only mapping of the file
+typedef struct
+{
+    const u8 *map;
+    usize size;
+    const ReplayIndexEntry *index;
+    u64 move_count;
+    u64 keyframe_count;
+    u32 keyframe_interval;
+} Replay;
+
+// false on a file that was never finished or whose index does not describe its chunks
+bool Replay_Open(Replay *replay, const char *path);
+void Replay_Close(Replay *replay);
+
+// Keyframe k (the state before move k * interval), in place in the mapping
+const GameState *Replay_Keyframe(const Replay *replay, u64 k);
+
+// Moves recorded after keyframe k, in place
+const ReplayMove *Replay_ChunkMoves(const Replay *replay, u64 k, u32 *out_count);
+
+// out_state = the state after the first `move` moves (0 is the initial state)
+bool Replay_Seek(const Replay *replay, u64 move, GameState *out_state);
+
+
+#endif /* BG64_REPLAY_H_ */
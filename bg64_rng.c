@@ -0,0 +1,64 @@
+#include <pthread.h>
+#include "bg64_rng.h"
+
+
+// A matrix is stored by columns: column i is the image of the basis seed 1 << i, so
+// M * v is the xor of the columns selected by the set bits of v
+typedef struct
+{
+    u64 col[64];
+} BitMatrix;
+
+static BitMatrix XORSHIFT_POWERS[64]; // M^(2^k)
+static pthread_once_t xorshift_powers_once = PTHREAD_ONCE_INIT;
+
+static inline u64 matrix_apply(const BitMatrix *m, u64 v)
+{
+    u64 r = 0;
+    while (v) {
+        r ^= m->col[__builtin_ctzll(v)];
+        v &= v - 1;
+    }
+    return r;
+}
+
+static void xorshift_powers_build(void)
+{
+    // M itself straight from the generator, it is linear so the basis images are enough
+    for (u32 i = 0; i < 64; i++) {
+        u64 x = 1ULL << i;
+        XORSHIFT_POWERS[0].col[i] = xorshift(&x);
+    }
+
+    // (M^(2^k))^2 column by column
+    for (u32 k = 1; k < 64; k++) {
+        const BitMatrix *a = &XORSHIFT_POWERS[k - 1];
+        for (u32 i = 0; i < 64; i++) XORSHIFT_POWERS[k].col[i] = matrix_apply(a, a->col[i]);
+    }
+}
+
+u64 xorshift_jump(u64 *seed, u64 n)
+{
+    pthread_once(&xorshift_powers_once, xorshift_powers_build);
+
+    u64 x = *seed;
+    while (n) {
+        x = matrix_apply(&XORSHIFT_POWERS[__builtin_ctzll(n)], x);
+        n &= n - 1;
+    }
+
+    return *seed = x;
+}
+
+u64 xorshift_jump_back(u64 *seed, u64 n)
+{
+    // n == XORSHIFT_PERIOD is a whole cycle, both directions land on the seed itself
+    return xorshift_jump(seed, XORSHIFT_PERIOD - (n % XORSHIFT_PERIOD));
+}
+
+u8 piece_at(u64 seed, u64 index)
+{
+    // generate_composite_byte steps once per piece
+    xorshift_jump(&seed, index);
+    return generate_composite_byte(&seed);
+}
@@ -0,0 +1,29 @@
+#ifndef BG64_RNG_H_
+#define BG64_RNG_H_
+
+
+#include "bg64.h"
+
+
+// XORSHIFT JUMP AHEAD
+// One xorshift step (13/7/17) is linear over GF(2): the next seed is M * seed for a fixed
+// 64x64 bit matrix M. The powers M^(2^k) for k = 0..63 are built once by repeated
+// squaring, so advancing by any n applies one precomputed matrix per set bit of n.
+//
+// The generator has full period 2^64 - 1 over non zero seeds, so stepping back n is the
+// same as stepping forward 2^64 - 1 - n.
+#define XORSHIFT_PERIOD UINT64_MAX
+
+// Same result as n calls to xorshift(seed), updates and returns *seed
+u64 xorshift_jump(u64 *seed, u64 n);
+
+// Same result as n calls to xorshift_back(seed)
+u64 xorshift_jump_back(u64 *seed, u64 n);
+
+// Composite byte of the piece at position index of the classic stream from seed, index 0
+// being the next piece generated. Games in another piece mode use Pieces_At with
+// Pieces_StateDistribution (bg64_pieces).
+u8 piece_at(u64 seed, u64 index);
+
+
+#endif /* BG64_RNG_H_ */
@@ -0,0 +1,247 @@
+// GENERATED by tools/shapegen from shapes.txt. Do not edit, edit shapes.txt.
+#ifndef BG64_SHAPES_H_
+#define BG64_SHAPES_H_
+
+
+#define SHAPE_COUNT 28   // library slots including the void shape
+#define SHAPE_OPTIONS 27 // playable shapes, 1..SHAPE_OPTIONS
+
+
+static const u64 SHAPE_LIBRARY[SHAPE_COUNT] = {
+    [0] = 0, // Void
+
+    // [X]
+    [1] = 0x8000000000000000ULL, // dot (1x1)
+
+    // [X][X]
+    [2] = 0xC000000000000000ULL, // line2 (2x1)
+
+    // [X][X][X]
+    [3] = 0xE000000000000000ULL, // line3 (3x1)
+
+    // [ ][X][ ]
+    // [X][X][X]
+    [4] = 0x40E0000000000000ULL, // tee (3x2)
+
+    // [X][ ][ ]
+    // [X][X][X]
+    [5] = 0x80E0000000000000ULL, // ell_small (3x2)
+
+    // [X][X]
+    // [X][X]
+    [6] = 0xC0C0000000000000ULL, // square2 (2x2)
+
+    // [X][ ][ ]
+    // [X][ ][ ]
+    // [X][X][X]
+    [7] = 0x8080E00000000000ULL, // ell_big (3x3)
+
+    // [X][X][X]
+    // [X][X][X]
+    // [X][X][X]
+    [8] = 0xE0E0E00000000000ULL, // square3 (3x3)
+
+    // [X][X][X][X]
+    [9] = 0xF000000000000000ULL, // line4 (4x1)
+
+    // [X][X]
+    // [X][X]
+    // [X][X]
+    [10] = 0xC0C0C00000000000ULL, // bar2x3 (2x3)
+
+    // [X]
+    // [X]
+    [11] = 0x8080000000000000ULL, // line2_1 (1x2)
+
+    // [X]
+    // [X]
+    // [X]
+    [12] = 0x8080800000000000ULL, // line3_1 (1x3)
+
+    // [X][ ]
+    // [X][X]
+    // [X][ ]
+    [13] = 0x80C0800000000000ULL, // tee_1 (2x3)
+
+    // [X][X][X]
+    // [ ][X][ ]
+    [14] = 0xE040000000000000ULL, // tee_2 (3x2)
+
+    // [ ][X]
+    // [X][X]
+    // [ ][X]
+    [15] = 0x40C0400000000000ULL, // tee_3 (2x3)
+
+    // [X][X]
+    // [X][ ]
+    // [X][ ]
+    [16] = 0xC080800000000000ULL, // ell_small_1 (2x3)
+
+    // [X][X][X]
+    // [ ][ ][X]
+    [17] = 0xE020000000000000ULL, // ell_small_2 (3x2)
+
+    // [ ][X]
+    // [ ][X]
+    // [X][X]
+    [18] = 0x4040C00000000000ULL, // ell_small_3 (2x3)
+
+    // [ ][ ][X]
+    // [X][X][X]
+    [19] = 0x20E0000000000000ULL, // ell_small_4 (3x2)
+
+    // [X][ ]
+    // [X][ ]
+    // [X][X]
+    [20] = 0x8080C00000000000ULL, // ell_small_5 (2x3)
+
+    // [X][X][X]
+    // [X][ ][ ]
+    [21] = 0xE080000000000000ULL, // ell_small_6 (3x2)
+
+    // [X][X]
+    // [ ][X]
+    // [ ][X]
+    [22] = 0xC040400000000000ULL, // ell_small_7 (2x3)
+
+    // [X][X][X]
+    // [X][ ][ ]
+    // [X][ ][ ]
+    [23] = 0xE080800000000000ULL, // ell_big_1 (3x3)
+
+    // [X][X][X]
+    // [ ][ ][X]
+    // [ ][ ][X]
+    [24] = 0xE020200000000000ULL, // ell_big_2 (3x3)
+
+    // [ ][ ][X]
+    // [ ][ ][X]
+    // [X][X][X]
+    [25] = 0x2020E00000000000ULL, // ell_big_3 (3x3)
+
+    // [X]
+    // [X]
+    // [X]
+    // [X]
+    [26] = 0x8080808000000000ULL, // line4_1 (1x4)
+
+    // [X][X][X]
+    // [X][X][X]
+    [27] = 0xE0E0000000000000ULL, // bar2x3_1 (3x2)
+};
+
+
+static const ShapeInfo SHAPE_INFO[SHAPE_COUNT] = {
+    [0] = { .name = "void" },
+    [1] = { .mask = 0x8000000000000000ULL, .anchors = 0xFFFFFFFFFFFFFFFFULL,
+            .transposed = 0x8000000000000000ULL,
+            .width = 1, .height = 1, .cells = 1, .row_extent = { 1 },
+            .render_dx = 0.0f, .render_dy = 0.0f, .name = "dot" },
+    [2] = { .mask = 0xC000000000000000ULL, .anchors = 0xFEFEFEFEFEFEFEFEULL,
+            .transposed = 0x8080000000000000ULL,
+            .width = 2, .height = 1, .cells = 2, .row_extent = { 2 },
+            .render_dx = -0.5f, .render_dy = 0.0f, .name = "line2" },
+    [3] = { .mask = 0xE000000000000000ULL, .anchors = 0xFCFCFCFCFCFCFCFCULL,
+            .transposed = 0x8080800000000000ULL,
+            .width = 3, .height = 1, .cells = 3, .row_extent = { 3 },
+            .render_dx = -1.0f, .render_dy = 0.0f, .name = "line3" },
+    [4] = { .mask = 0x40E0000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0x40C0400000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 2, 3 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "tee" },
+    [5] = { .mask = 0x80E0000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0xC040400000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 1, 3 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "ell_small" },
+    [6] = { .mask = 0xC0C0000000000000ULL, .anchors = 0xFEFEFEFEFEFEFE00ULL,
+            .transposed = 0xC0C0000000000000ULL,
+            .width = 2, .height = 2, .cells = 4, .row_extent = { 2, 2 },
+            .render_dx = -0.5f, .render_dy = -0.5f, .name = "square2" },
+    [7] = { .mask = 0x8080E00000000000ULL, .anchors = 0xFCFCFCFCFCFC0000ULL,
+            .transposed = 0xE020200000000000ULL,
+            .width = 3, .height = 3, .cells = 5, .row_extent = { 1, 1, 3 },
+            .render_dx = -1.0f, .render_dy = -1.0f, .name = "ell_big" },
+    [8] = { .mask = 0xE0E0E00000000000ULL, .anchors = 0xFCFCFCFCFCFC0000ULL,
+            .transposed = 0xE0E0E00000000000ULL,
+            .width = 3, .height = 3, .cells = 9, .row_extent = { 3, 3, 3 },
+            .render_dx = -1.0f, .render_dy = -1.0f, .name = "square3" },
+    [9] = { .mask = 0xF000000000000000ULL, .anchors = 0xF8F8F8F8F8F8F8F8ULL,
+            .transposed = 0x8080808000000000ULL,
+            .width = 4, .height = 1, .cells = 4, .row_extent = { 4 },
+            .render_dx = -1.5f, .render_dy = 0.0f, .name = "line4" },
+    [10] = { .mask = 0xC0C0C00000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0xE0E0000000000000ULL,
+            .width = 2, .height = 3, .cells = 6, .row_extent = { 2, 2, 2 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "bar2x3" },
+    [11] = { .mask = 0x8080000000000000ULL, .anchors = 0xFFFFFFFFFFFFFF00ULL,
+            .transposed = 0xC000000000000000ULL,
+            .width = 1, .height = 2, .cells = 2, .row_extent = { 1, 1 },
+            .render_dx = 0.0f, .render_dy = -0.5f, .name = "line2_1" },
+    [12] = { .mask = 0x8080800000000000ULL, .anchors = 0xFFFFFFFFFFFF0000ULL,
+            .transposed = 0xE000000000000000ULL,
+            .width = 1, .height = 3, .cells = 3, .row_extent = { 1, 1, 1 },
+            .render_dx = 0.0f, .render_dy = -1.0f, .name = "line3_1" },
+    [13] = { .mask = 0x80C0800000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0xE040000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 1, 2, 1 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "tee_1" },
+    [14] = { .mask = 0xE040000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0x80C0800000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 3, 2 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "tee_2" },
+    [15] = { .mask = 0x40C0400000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0x40E0000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 2, 2, 2 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "tee_3" },
+    [16] = { .mask = 0xC080800000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0xE080000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 2, 1, 1 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "ell_small_1" },
+    [17] = { .mask = 0xE020000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0x8080C00000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 3, 3 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "ell_small_2" },
+    [18] = { .mask = 0x4040C00000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0x20E0000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 2, 2, 2 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "ell_small_3" },
+    [19] = { .mask = 0x20E0000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0x4040C00000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 3, 3 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "ell_small_4" },
+    [20] = { .mask = 0x8080C00000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0xE020000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 1, 1, 2 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "ell_small_5" },
+    [21] = { .mask = 0xE080000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0xC080800000000000ULL,
+            .width = 3, .height = 2, .cells = 4, .row_extent = { 3, 1 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "ell_small_6" },
+    [22] = { .mask = 0xC040400000000000ULL, .anchors = 0xFEFEFEFEFEFE0000ULL,
+            .transposed = 0x80E0000000000000ULL,
+            .width = 2, .height = 3, .cells = 4, .row_extent = { 2, 2, 2 },
+            .render_dx = -0.5f, .render_dy = -1.0f, .name = "ell_small_7" },
+    [23] = { .mask = 0xE080800000000000ULL, .anchors = 0xFCFCFCFCFCFC0000ULL,
+            .transposed = 0xE080800000000000ULL,
+            .width = 3, .height = 3, .cells = 5, .row_extent = { 3, 1, 1 },
+            .render_dx = -1.0f, .render_dy = -1.0f, .name = "ell_big_1" },
+    [24] = { .mask = 0xE020200000000000ULL, .anchors = 0xFCFCFCFCFCFC0000ULL,
+            .transposed = 0x8080E00000000000ULL,
+            .width = 3, .height = 3, .cells = 5, .row_extent = { 3, 3, 3 },
+            .render_dx = -1.0f, .render_dy = -1.0f, .name = "ell_big_2" },
+    [25] = { .mask = 0x2020E00000000000ULL, .anchors = 0xFCFCFCFCFCFC0000ULL,
+            .transposed = 0x2020E00000000000ULL,
+            .width = 3, .height = 3, .cells = 5, .row_extent = { 3, 3, 3 },
+            .render_dx = -1.0f, .render_dy = -1.0f, .name = "ell_big_3" },
+    [26] = { .mask = 0x8080808000000000ULL, .anchors = 0xFFFFFFFFFF000000ULL,
+            .transposed = 0xF000000000000000ULL,
+            .width = 1, .height = 4, .cells = 4, .row_extent = { 1, 1, 1, 1 },
+            .render_dx = 0.0f, .render_dy = -1.5f, .name = "line4_1" },
+    [27] = { .mask = 0xE0E0000000000000ULL, .anchors = 0xFCFCFCFCFCFCFC00ULL,
+            .transposed = 0xC0C0C00000000000ULL,
+            .width = 3, .height = 2, .cells = 6, .row_extent = { 3, 3 },
+            .render_dx = -1.0f, .render_dy = -0.5f, .name = "bar2x3_1" },
+};
+
+
+#endif /* BG64_SHAPES_H_ */
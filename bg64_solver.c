@@ -0,0 +1,357 @@
+#define _GNU_SOURCE // clock_gettime
+#include <string.h>
+#include <time.h>
+#include "bg64_solver.h"
+#include "bg64_board.h"
+#include "bg64_movegen.h"
+#include "bg64_pieces.h"
+#include "bg64_symmetry.h"
+
+// Entry bounds: EXACT is the node's value, UPPER only says the value is at most this
+#define BOUND_EXACT 1
+#define BOUND_UPPER 2
+
+// Survival ranks pieces placed above any score, a sequence never scores 2^16
+#define SURVIVAL_PIECE (1u << 16)
+
+typedef struct
+{
+    u64 grid;    // after line clears
+    f32 key;     // ordering, best first
+    u32 gain;    // value of the move itself
+    u8 slot;
+    u8 cell;
+    u8 lines;
+} SolverChild;
+
+
+static f64 solver_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+Solver Solver_Allocation(Arena *arena, u32 table_bits)
+{
+    u64 entries = 1ULL << table_bits;
+    Solver solver = {
+        .table = (SolverEntry *)Arena_PushZero(arena, entries * sizeof(SolverEntry), 64),
+        .table_mask = entries - 1};
+    return solver;
+}
+
+static inline u64 solver_hash(u64 grid, u8 deck, u8 used)
+{
+    u64 h = (grid ^ ((u64)deck << 3 | used) * 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 31);
+}
+
+static inline SolverEntry *solver_probe(Solver *solver, u64 grid, u8 deck, u8 used)
+{
+    SolverEntry *e = &solver->table[solver_hash(grid, deck, used) & solver->table_mask];
+    if (e->generation != solver->generation || e->grid != grid || e->deck != deck || (e->flags & 7) != used) return NULL;
+    return e;
+}
+
+static inline void solver_store(Solver *solver, u64 grid, u8 deck, u8 used, u32 value, u8 bound, u8 move)
+{
+    // Always replace: the newest node is the likeliest to be revisited
+    SolverEntry *e = &solver->table[solver_hash(grid, deck, used) & solver->table_mask];
+    *e = (SolverEntry){ grid, value, deck, (u8)(bound << 3 | used), move, solver->generation };
+}
+
+// Most line clears `cells` placed cells can produce on this grid, or cap if that many are
+// possible. A row clear needs every empty cell of its row filled, the emptiest rows last
+// and 8 cells for a row cleared again. A column clear needs the same, except that up to
+// one cell per row clear can be shared with it, so with r row clears a column with e empty
+// cells costs max(0, e - r).
+static u32 solver_lines_by_cells(u64 grid, u32 cells, u32 cap)
+{
+    // Rows and columns by empty cell count, full lines never stay on the board
+    u8 rows[9] = { 0 }, cols[9] = { 0 };
+    u64 t = grid_transpose(grid);
+    for (u32 k = 0; k < 8; k++) {
+        rows[8 - __builtin_popcount((u32)(grid >> (k * 8)) & 0xFF)]++;
+        cols[8 - __builtin_popcount((u32)(t >> (k * 8)) & 0xFF)]++;
+    }
+
+    u32 best = 0;
+    u32 row_cost = 0;
+    u32 e = 1, left = rows[1];
+    for (u32 r = 0; r <= cap; r++) {
+        if (r > 0) {
+            // Cheapest row still unused, every row costs 8 once all are cleared once
+            while (e < 8 && left == 0) left = rows[++e];
+            row_cost += left ? e : 8;
+            if (left) left--;
+        }
+        if (row_cost > cells) break;
+
+        u32 budget = cells - row_cost;
+        u32 c = 0;
+        for (u32 ce = 1; ce <= 9 && r + c < cap; ce++) {
+            // ce == 9 stands for columns cleared a second time, 8 cells each, any number
+            u32 cost = ce == 9 ? 8 : ce;
+            u32 need = cost > r ? cost - r : 0;
+            u32 supply = ce == 9 ? cap : cols[ce];
+            u32 take = need ? budget / need : supply;
+            if (take > supply) take = supply;
+            if (take > cap - r - c) take = cap - r - c;
+            c += take;
+            budget -= take * need;
+        }
+        if (r + c > best) best = r + c;
+        if (best >= cap) break;
+    }
+    return best;
+}
+
+// Best value the rest of the horizon could possibly add. Every move clears at most its
+// height + width lines, and every clear needs its empty cells filled by the pieces still to
+// come (see above). The cell count is only worked out when the first cap does not already
+// put the bound at or below floor, which is all the caller wants to know.
+static u32 solver_bound(const Solver *solver, u64 grid, u8 deck, u8 used, i64 floor)
+{
+    u32 lines = solver->suffix_lines[deck + 1];
+    u32 cells = solver->suffix_cells[deck + 1];
+    u32 pieces = solver->suffix_pieces[deck + 1];
+
+    for (u8 k = 0; k < 3; k++) {
+        if (used & (1u << k)) continue;
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(solver->pieces[deck * 3 + k])];
+        lines += shape->width + shape->height;
+        cells += shape->cells;
+        pieces++;
+    }
+
+    u32 base = solver->goal == SOLVER_SURVIVAL ? pieces * SURVIVAL_PIECE : 0;
+    u32 cheap = base + 10 * lines;
+    if ((i64)cheap <= floor || (i64)base > floor) return cheap;
+
+    // Only whether the cells allow more than floor matters
+    u32 target = (u32)((floor - base) / 10) + 1;
+    u32 fine = solver_lines_by_cells(grid, cells, target < lines ? target : lines);
+    return fine >= target ? cheap : base + 10 * fine;
+}
+
+static u32 solver_children(const Solver *solver, u64 grid, u8 deck, u8 used, SolverChild *out)
+{
+    Successor successors[MOVEGEN_MAX_SUCCESSORS];
+    u64 grids[MOVEGEN_MAX_SUCCESSORS];
+    f32 scores[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = MoveGen_Board(grid, &solver->pieces[deck * 3], used, successors);
+
+    for (u32 i = 0; i < count; i++) {
+        const Successor *s = &successors[i];
+        grids[i] = s->grid;
+        out[i] = (SolverChild){
+            .grid = s->grid,
+            .gain = s->score_delta + (solver->goal == SOLVER_SURVIVAL ? SURVIVAL_PIECE : 0),
+            .slot = s->slot,
+            .cell = s->cell,
+            .lines = s->lines};
+    }
+
+    // Ordering only: the evaluation never decides what is pruned
+    Eval_ScoreBatch(solver->weights, grids, count, scores);
+    for (u32 i = 0; i < count; i++) out[i].key = scores[i] + 4.0f * (f32)out[i].lines;
+
+    for (u32 i = 1; i < count; i++) {
+        SolverChild c = out[i];
+        u32 j = i;
+        while (j > 0 && out[j - 1].key < c.key) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = c;
+    }
+    return count;
+}
+
+static inline void solver_advance(u8 deck, u8 used, u8 slot, u8 *out_deck, u8 *out_used)
+{
+    used |= (u8)(1u << slot);
+    if (used == 7) {
+        *out_deck = deck + 1;
+        *out_used = 0;
+    } else {
+        *out_deck = deck;
+        *out_used = used;
+    }
+}
+
+// Fail soft: a result above alpha is the exact value of the node, anything else is an
+// upper bound on it. alpha < 0 asks for the exact value.
+static i64 solver_search(Solver *solver, u64 grid, u8 deck, u8 used, i64 alpha)
+{
+    if (deck == solver->decks) return 0;
+
+    solver->nodes++;
+    if ((solver->nodes & 4095) == 0) {
+        if ((solver->node_budget && solver->nodes >= solver->node_budget) ||
+            (solver->deadline > 0 && solver_now() >= solver->deadline)) {
+            solver->aborted = true;
+        }
+    }
+    if (solver->aborted) return 0;
+
+    u32 optimistic = solver_bound(solver, grid, deck, used, alpha);
+
+    SolverEntry *e = solver_probe(solver, grid, deck, used);
+    if (e) {
+        u8 bound = e->flags >> 3;
+        if (bound == BOUND_EXACT || (i64)e->value <= alpha) {
+            solver->memo_hits++;
+            return e->value;
+        }
+        if (e->value < optimistic) optimistic = e->value;
+    }
+
+    if ((i64)optimistic <= alpha) {
+        solver->cutoffs++;
+        return optimistic;
+    }
+
+    SolverChild children[EVAL_MAX_SUCCESSORS];
+    u32 count = solver_children(solver, grid, deck, used, children);
+
+    i64 best = 0;
+    u8 best_move = SOLVER_NO_MOVE;
+    for (u32 i = 0; i < count; i++) {
+        const SolverChild *c = &children[i];
+        i64 floor = alpha > best ? alpha : best;
+
+        u8 child_deck, child_used;
+        solver_advance(deck, used, c->slot, &child_deck, &child_used);
+
+        // Not even a perfect continuation gets past the floor: the bound stands in for it
+        i64 child_optimistic = c->gain;
+        if (child_deck < solver->decks) child_optimistic += solver_bound(solver, c->grid, child_deck, child_used, floor - c->gain);
+        if (child_optimistic <= floor && best_move != SOLVER_NO_MOVE) {
+            solver->cutoffs++;
+            if (child_optimistic > best && best <= alpha) best = child_optimistic;
+            continue;
+        }
+
+        i64 v = (i64)c->gain + solver_search(solver, c->grid, child_deck, child_used, floor - (i64)c->gain);
+        if (solver->aborted) return 0;
+
+        if (v > best || best_move == SOLVER_NO_MOVE) {
+            if (v > best) best = v;
+            best_move = (u8)(c->slot << 6 | c->cell);
+        }
+    }
+
+    // No children: stuck, the value of the rest is 0
+    solver_store(solver, grid, deck, used, (u32)best, (best > alpha || count == 0) ? BOUND_EXACT : BOUND_UPPER, best_move);
+    return best;
+}
+
+// Walks the proven value back down the tree, re-searching nodes the table lost
+static void solver_line(Solver *solver, u64 grid, u32 value, SolverResult *out)
+{
+    u8 deck = 0, used = solver->used;
+    out->move_count = 0;
+    out->score = 0;
+
+    while (deck < solver->decks) {
+        SolverChild children[EVAL_MAX_SUCCESSORS];
+        u32 count = solver_children(solver, grid, deck, used, children);
+
+        // First child (best evaluated) whose exact value delivers the rest of the total
+        const SolverChild *pick = NULL;
+        for (u32 i = 0; i < count && !pick; i++) {
+            const SolverChild *c = &children[i];
+            if (c->gain > value) continue;
+
+            u8 child_deck, child_used;
+            solver_advance(deck, used, c->slot, &child_deck, &child_used);
+            i64 need = (i64)(value - c->gain);
+            if (solver_search(solver, c->grid, child_deck, child_used, need - 1) == need) pick = c;
+        }
+        if (!pick) break;
+
+        out->moves[out->move_count++] = (SolverMove){ pick->slot, (i8)(pick->cell & 7), (i8)(pick->cell >> 3), pick->lines };
+        out->score += pick->lines * 10u;
+        value -= pick->gain;
+        grid = pick->grid;
+        solver_advance(deck, used, pick->slot, &deck, &used);
+    }
+}
+
+static void solver_next_generation(Solver *solver)
+{
+    // A wrapped generation would make stale entries look current
+    if (++solver->generation == 0) {
+        memset(solver->table, 0, (solver->table_mask + 1) * sizeof(SolverEntry));
+        solver->generation = 1;
+    }
+}
+
+bool Solver_Solve(Solver *solver, const GameState *state, u32 decks, SolverGoal goal, const EvalWeights *weights,
+                  u64 node_budget, f64 seconds, SolverResult *out_result)
+{
+    if (decks == 0) decks = 1;
+    if (decks > SOLVER_MAX_DECKS) decks = SOLVER_MAX_DECKS;
+
+    // Future pieces: the deck, the queue in consumption order, then the seed's stream
+    for (u8 k = 0; k < 3; k++) solver->pieces[k] = state->session.deck_shape_color_bits[k];
+    u32 n = 3;
+    for (u8 k = 0; k < state->utility.ring_buffer_counter && n < SOLVER_MAX_PIECES; k++) {
+        solver->pieces[n++] = state->ring_buffer[(state->utility.ring_buffer_read_index + k) & 63];
+    }
+    u64 seed = state->utility.rng_seed;
+    Pieces_Fill(Pieces_StateDistribution(state), &seed, &solver->pieces[n], SOLVER_MAX_PIECES - n);
+
+    solver->used = 0;
+    for (u8 k = 0; k < 3; k++) solver->used |= (u8)(state->session.is_active[k] << k);
+
+    solver->goal = goal;
+    solver->weights = weights ? weights : &EVAL_DEFAULT_WEIGHTS;
+    solver->node_budget = node_budget;
+    solver->aborted = false;
+    solver->nodes = solver->memo_hits = solver->cutoffs = 0;
+
+    f64 start = solver_now();
+    solver->deadline = seconds > 0 ? start + seconds : 0;
+
+    bool any = false;
+    for (u32 horizon = 1; horizon <= decks; horizon++) {
+        solver->decks = horizon;
+        solver->suffix_lines[horizon] = solver->suffix_cells[horizon] = solver->suffix_pieces[horizon] = 0;
+        for (i32 d = (i32)horizon - 1; d >= 0; d--) {
+            u32 lines = 0, cells = 0;
+            for (u8 k = 0; k < 3; k++) {
+                const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(solver->pieces[d * 3 + k])];
+                lines += shape->width + shape->height;
+                cells += shape->cells;
+            }
+            solver->suffix_lines[d] = solver->suffix_lines[d + 1] + lines;
+            solver->suffix_cells[d] = solver->suffix_cells[d + 1] + cells;
+            solver->suffix_pieces[d] = solver->suffix_pieces[d + 1] + 3;
+        }
+
+        solver_next_generation(solver);
+        i64 value = solver_search(solver, state->grid.game_grid, 0, solver->used, -1);
+        if (solver->aborted) break;
+
+        // The line re-searches lost nodes and can run out of budget too
+        SolverResult line;
+        solver_line(solver, state->grid.game_grid, (u32)value, &line);
+        if (solver->aborted) break;
+
+        memcpy(out_result->moves, line.moves, line.move_count * sizeof(SolverMove));
+        out_result->move_count = line.move_count;
+        out_result->score = line.score;
+        out_result->decks = horizon;
+        any = true;
+    }
+
+    out_result->proven = any && !solver->aborted;
+    out_result->nodes = solver->nodes;
+    out_result->memo_hits = solver->memo_hits;
+    out_result->cutoffs = solver->cutoffs;
+    out_result->seconds = solver_now() - start;
+    return any;
+}
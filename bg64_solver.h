@@ -0,0 +1,101 @@
+#ifndef BG64_SOLVER_H_
+#define BG64_SOLVER_H_
+
+
+#include "bg64.h"
+#include "bg64_eval.h"
+
+
+// EXACT LOOKAHEAD SOLVER
+// Every future piece is already known: the current deck, the 64 pieces waiting in the
+// ring buffer and, past those, the stream rng_seed generates. The solver searches the
+// placement sequences over the next K decks depth first for the one with the best value:
+//   SOLVER_SCORE     points gained
+//   SOLVER_SURVIVAL  pieces placed before getting stuck, then points
+//
+// Nodes are (grid, deck index, slots used) and memoized in a transposition table, so the
+// orders a deck can be played in collapse. Children are tried best evaluation first to
+// find a strong sequence early, and a subtree is cut when even an optimistic bound on what
+// is left cannot beat the best sequence already found. The bound is admissible, so a search
+// that completes is a proof. Decks are deepened one at a time: when the budget runs out the
+// result is the optimum over the last horizon that finished.
+#define SOLVER_MAX_DECKS 16
+#define SOLVER_MAX_PIECES (3 * SOLVER_MAX_DECKS)
+
+typedef enum : u8 {
+    SOLVER_SCORE = 0,
+    SOLVER_SURVIVAL,
+} SolverGoal;
+
+// 16 bytes, 4 per cache line
+typedef struct
+{
+    u64 grid;
+    u32 value;
+    u8 deck;
+    u8 flags;      // bound << 3 | slots used
+    u8 move;       // slot << 6 | cell, SOLVER_NO_MOVE when none
+    u8 generation; // one per deepening step, older entries are misses
+} SolverEntry;
+
+#define SOLVER_NO_MOVE 0xFF
+
+typedef struct
+{
+    u8 slot;
+    i8 gx;
+    i8 gy;
+    u8 lines;
+} SolverMove;
+
+typedef struct
+{
+    SolverMove moves[SOLVER_MAX_PIECES];
+    u32 move_count;
+    u32 decks;        // horizon the result is optimal for
+    u32 score;        // points gained along moves
+    bool proven;      // the requested horizon finished inside the budget
+    u64 nodes;
+    u64 memo_hits;
+    u64 cutoffs;
+    f64 seconds;
+} SolverResult;
+
+typedef struct
+{
+    SolverEntry *table;
+    u64 table_mask;
+    u8 generation;
+
+    // Search setup
+    u8 pieces[SOLVER_MAX_PIECES]; // deck d slot k is pieces[3 * d + k]
+    u8 used;                      // slots of deck 0 placed before the search
+    u32 decks;
+    SolverGoal goal;
+    const EvalWeights *weights;
+
+    // Optimistic bound per deck: lines possible and pieces left from deck d on
+    u32 suffix_lines[SOLVER_MAX_DECKS + 1];
+    u32 suffix_cells[SOLVER_MAX_DECKS + 1];
+    u32 suffix_pieces[SOLVER_MAX_DECKS + 1];
+
+    // Budget
+    u64 node_budget;
+    f64 deadline;
+    bool aborted;
+
+    u64 nodes;
+    u64 memo_hits;
+    u64 cutoffs;
+} Solver;
+
+// table_bits: log2 of the transposition table entries (16 bytes each)
+Solver Solver_Allocation(Arena *arena, u32 table_bits);
+
+// Searches up to `decks` decks (1..SOLVER_MAX_DECKS) ahead of state. node_budget and
+// seconds of 0 mean unlimited. False when not even the first deck could be searched.
+bool Solver_Solve(Solver *solver, const GameState *state, u32 decks, SolverGoal goal, const EvalWeights *weights,
+                  u64 node_budget, f64 seconds, SolverResult *out_result);
+
+
+#endif /* BG64_SOLVER_H_ */
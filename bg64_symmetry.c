@@ -0,0 +1,98 @@
+#include <string.h>
+#include <pthread.h>
+#include "bg64_symmetry.h"
+
+
+u64 grid_symmetry(u64 grid, Symmetry sym)
+{
+    switch (sym) {
+        case SYM_ROT90:          return grid_rotate90(grid);
+        case SYM_ROT180:         return grid_rotate180(grid);
+        case SYM_ROT270:         return grid_rotate270(grid);
+        case SYM_MIRROR:         return grid_mirror(grid);
+        case SYM_FLIP:           return grid_flip(grid);
+        case SYM_TRANSPOSE:      return grid_transpose(grid);
+        case SYM_ANTI_TRANSPOSE: return grid_anti_transpose(grid);
+        case SYM_IDENTITY:
+        default:                 return grid;
+    }
+}
+
+Symmetry symmetry_inverse(Symmetry sym)
+{
+    // Only the quarter turns are not their own inverse
+    if (sym == SYM_ROT90) return SYM_ROT270;
+    if (sym == SYM_ROT270) return SYM_ROT90;
+    return sym;
+}
+
+u64 grid_canonical(u64 grid, Symmetry *out_sym)
+{
+    // Share the intermediate images: 1 transpose, 2 flips, 3 mirrors for all 8
+    u64 t = grid_transpose(grid);
+    u64 images[SYM_COUNT];
+    images[SYM_IDENTITY] = grid;
+    images[SYM_FLIP] = grid_flip(grid);
+    images[SYM_MIRROR] = grid_mirror(grid);
+    images[SYM_ROT180] = grid_mirror(images[SYM_FLIP]);
+    images[SYM_TRANSPOSE] = t;
+    images[SYM_ROT270] = grid_flip(t);
+    images[SYM_ROT90] = grid_mirror(t);
+    images[SYM_ANTI_TRANSPOSE] = grid_mirror(images[SYM_ROT270]);
+
+    u64 best = images[0];
+    Symmetry best_sym = SYM_IDENTITY;
+    for (u8 s = 1; s < SYM_COUNT; s++) {
+        if (images[s] < best) {
+            best = images[s];
+            best_sym = (Symmetry)s;
+        }
+    }
+
+    if (out_sym) *out_sym = best_sym;
+    return best;
+}
+
+
+// Cell permutation per symmetry, derived once from the bitboard transforms themselves
+static u8 SYMMETRY_CELL_MAP[SYM_COUNT][64];
+static pthread_once_t symmetry_map_once = PTHREAD_ONCE_INIT;
+
+static void symmetry_map_build(void)
+{
+    for (u8 s = 0; s < SYM_COUNT; s++) {
+        for (u8 cell = 0; cell < 64; cell++) {
+            u64 image = grid_symmetry(1ULL << (63 - cell), (Symmetry)s);
+            SYMMETRY_CELL_MAP[s][cell] = (u8)(63 - __builtin_ctzll(image));
+        }
+    }
+}
+
+void colors_symmetry(const u8 *src, u8 *dst, Symmetry sym)
+{
+    pthread_once(&symmetry_map_once, symmetry_map_build);
+
+    // Unpack to one byte per cell, scatter through the map, pack back
+    u8 cells[64];
+    u8 moved[64];
+    for (u8 i = 0; i < 32; i++) {
+        cells[2 * i] = src[i] >> 4;
+        cells[2 * i + 1] = src[i] & 0x0F;
+    }
+
+    const u8 *map = SYMMETRY_CELL_MAP[sym];
+    for (u8 cell = 0; cell < 64; cell++) moved[map[cell]] = cells[cell];
+
+    for (u8 i = 0; i < 32; i++) dst[i] = (u8)((moved[2 * i] << 4) | moved[2 * i + 1]);
+}
+
+void GameState_ApplySymmetry(GameState *state, Symmetry sym)
+{
+    if (sym == SYM_IDENTITY) return;
+
+    state->grid.game_grid = grid_symmetry(state->grid.game_grid, sym);
+
+    u8 colors[32];
+    colors_symmetry(state->grid.grid_color, colors, sym);
+    memcpy(state->grid.grid_color, colors, sizeof(colors));
+}
@@ -0,0 +1,75 @@
+#ifndef BG64_SYMMETRY_H_
+#define BG64_SYMMETRY_H_
+
+
+#include "bg64.h"
+
+
+// DIHEDRAL SYMMETRY (D4)
+// The 8 images of an 8x8 board under rotation and reflection. With a rotation closed
+// shape set (see shapes.txt) boards in one orbit play identically, so caches and datasets
+// key on the canonical image and store the symmetry that maps back to the real board.
+//
+// Bit layout reminder: cell (x, y) is bit 63 - (y * 8 + x), row y is byte 7 - y and the
+// most significant bit of a byte is column 0.
+typedef enum : u8 {
+    SYM_IDENTITY = 0,
+    SYM_ROT90,          // clockwise: (x, y) -> (7 - y, x)
+    SYM_ROT180,         // (x, y) -> (7 - x, 7 - y)
+    SYM_ROT270,         // (x, y) -> (y, 7 - x)
+    SYM_MIRROR,         // left/right: (x, y) -> (7 - x, y)
+    SYM_FLIP,           // top/bottom: (x, y) -> (x, 7 - y)
+    SYM_TRANSPOSE,      // main diagonal: (x, y) -> (y, x)
+    SYM_ANTI_TRANSPOSE, // anti diagonal: (x, y) -> (7 - y, 7 - x)
+    SYM_COUNT
+} Symmetry;
+
+
+// Rows upside down: one byte swap
+static inline u64 grid_flip(u64 g)
+{
+    return __builtin_bswap64(g);
+}
+
+// Columns left to right: reverse the bits of every byte with three delta swaps
+static inline u64 grid_mirror(u64 g)
+{
+    g = ((g >> 1) & 0x5555555555555555ULL) | ((g & 0x5555555555555555ULL) << 1);
+    g = ((g >> 2) & 0x3333333333333333ULL) | ((g & 0x3333333333333333ULL) << 2);
+    g = ((g >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((g & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return g;
+}
+
+// Swap x and y: three delta swaps across the diagonal (4x4 blocks, 2x2 blocks, cells)
+static inline u64 grid_transpose(u64 g)
+{
+    u64 t;
+    t = 0x0F0F0F0F00000000ULL & (g ^ (g << 28));
+    g ^= t ^ (t >> 28);
+    t = 0x3333000033330000ULL & (g ^ (g << 14));
+    g ^= t ^ (t >> 14);
+    t = 0x5500550055005500ULL & (g ^ (g << 7));
+    g ^= t ^ (t >> 7);
+    return g;
+}
+
+static inline u64 grid_rotate90(u64 g) { return grid_mirror(grid_transpose(g)); }
+static inline u64 grid_rotate180(u64 g) { return grid_mirror(grid_flip(g)); }
+static inline u64 grid_rotate270(u64 g) { return grid_flip(grid_transpose(g)); }
+static inline u64 grid_anti_transpose(u64 g) { return grid_rotate180(grid_transpose(g)); }
+
+u64 grid_symmetry(u64 grid, Symmetry sym);
+Symmetry symmetry_inverse(Symmetry sym);
+
+// Smallest of the 8 images, out_sym (optional) gets the symmetry that produced it:
+// grid_symmetry(grid, *out_sym) == canonical
+u64 grid_canonical(u64 grid, Symmetry *out_sym);
+
+// Nibble packed cell colors (game_grid.grid_color layout)
+void colors_symmetry(const u8 *src, u8 *dst, Symmetry sym);
+
+// Whole board: occupancy and colors together
+void GameState_ApplySymmetry(GameState *state, Symmetry sym);
+
+
+#endif /* BG64_SYMMETRY_H_ */
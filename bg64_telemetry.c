@@ -0,0 +1,342 @@
+#define _GNU_SOURCE     // clock_gettime, nanosleep
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bg64_telemetry.h"
+
+
+// One producer thread per ring. head is only written by the producer, tail only by the
+// flush thread; they sit on separate cache lines so neither side bounces the other's.
+typedef struct
+{
+    alignas(64) atomic_uint head;
+    TelemetryRecord *records;
+    u64 dropped;
+
+    // Producer side game bookkeeping for the helpers
+    u64 last_place_ns;
+    u32 moves;
+    u8 combo;
+    u8 index;
+
+    alignas(64) atomic_uint tail;
+} TelemetryRing;
+
+typedef struct
+{
+    TelemetryRing rings[TELEMETRY_MAX_THREADS];
+    atomic_uint ring_count;
+    atomic_bool accepting;    // producers may push
+    atomic_bool running;      // flush thread keeps polling
+    atomic_ullong unclaimed;  // records from threads past TELEMETRY_MAX_THREADS
+
+    pthread_t thread;
+    TelemetryRecord *block;   // TELEMETRY_BLOCK_RECORDS staging for write(2)
+    u64 session;
+    u64 rotate_bytes;
+    u64 file_bytes;
+    u64 file_index;
+    i32 fd;
+    char prefix[240];
+} Telemetry;
+
+static Telemetry *telemetry;
+static _Thread_local TelemetryRing *telemetry_ring;
+static _Thread_local Telemetry *telemetry_ring_owner;
+
+
+static u64 telemetry_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+static bool write_all(i32 fd, const void *data, usize len)
+{
+    const u8 *p = (const u8 *)data;
+    while (len) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (usize)n;
+    }
+    return true;
+}
+
+// One past the highest prefix.NNNNNN.bgtl already on disk, so a new run never reuses the
+// files of an earlier one
+static u64 telemetry_next_index(const char *prefix)
+{
+    char dir[240];
+    const char *slash = strrchr(prefix, '/');
+    const char *base = slash ? slash + 1 : prefix;
+    if (slash) snprintf(dir, sizeof(dir), "%.*s", (int)(slash - prefix), prefix);
+    else snprintf(dir, sizeof(dir), ".");
+    if (!dir[0]) snprintf(dir, sizeof(dir), "/");
+
+    DIR *d = opendir(dir);
+    if (!d) return 0;
+
+    usize base_len = strlen(base);
+    u64 next = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        const char *name = entry->d_name;
+        if (strncmp(name, base, base_len) != 0 || name[base_len] != '.') continue;
+
+        char *end;
+        unsigned long long index = strtoull(name + base_len + 1, &end, 10);
+        if (end == name + base_len + 1 || strcmp(end, ".bgtl") != 0) continue;
+        if (index + 1 > next) next = index + 1;
+    }
+    closedir(d);
+    return next;
+}
+
+static bool telemetry_open_file(Telemetry *t)
+{
+    char path[300];
+
+    // O_EXCL: a file that showed up since the scan (another instance) is skipped, never truncated
+    for (u32 attempt = 0;; attempt++) {
+        snprintf(path, sizeof(path), "%s.%06llu.bgtl", t->prefix, (unsigned long long)t->file_index);
+        t->fd = open(path, O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0644);
+        if (t->fd >= 0) break;
+        if (errno != EEXIST || attempt == 1000) return false;
+        t->file_index++;
+    }
+
+    TelemetryFileHeader header = {
+        .magic = TELEMETRY_MAGIC,
+        .version = TELEMETRY_VERSION,
+        .record_size = sizeof(TelemetryRecord),
+        .created_ns = telemetry_now(),
+        .file_index = t->file_index};
+    t->file_bytes = sizeof(header);
+    return write_all(t->fd, &header, sizeof(header));
+}
+
+static void telemetry_write_block(Telemetry *t, u32 count)
+{
+    usize bytes = (usize)count * sizeof(TelemetryRecord);
+
+    if (t->fd >= 0 && t->file_bytes + bytes > t->rotate_bytes) {
+        close(t->fd);
+        t->fd = -1;
+        t->file_index++;
+    }
+    if (t->fd < 0 && !telemetry_open_file(t)) return;
+
+    if (write_all(t->fd, t->block, bytes)) t->file_bytes += bytes;
+}
+
+static void *telemetry_flush_run(void *arg)
+{
+    Telemetry *t = (Telemetry *)arg;
+
+    for (;;) {
+        // Read running before draining: once it is false, one more full pass empties the rings
+        bool running = atomic_load_explicit(&t->running, memory_order_acquire);
+        u32 staged = 0;
+        u32 rings = atomic_load_explicit(&t->ring_count, memory_order_acquire);
+        if (rings > TELEMETRY_MAX_THREADS) rings = TELEMETRY_MAX_THREADS;
+
+        for (u32 r = 0; r < rings; r++) {
+            TelemetryRing *ring = &t->rings[r];
+            u32 head = atomic_load_explicit(&ring->head, memory_order_acquire);
+            u32 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+            while (tail != head) {
+                if (staged == TELEMETRY_BLOCK_RECORDS) {
+                    telemetry_write_block(t, staged);
+                    staged = 0;
+                }
+                t->block[staged++] = ring->records[tail & (TELEMETRY_RING_RECORDS - 1)];
+                tail++;
+            }
+            atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        }
+
+        if (staged) telemetry_write_block(t, staged);
+        if (!running) break;
+
+        // Nothing waiting: a ring holds seconds of play, polling every 20ms is plenty
+        if (!staged) nanosleep(&(struct timespec){ 0, 20 * 1000 * 1000 }, NULL);
+    }
+
+    return NULL;
+}
+
+bool Telemetry_Start(Arena *arena, const char *path_prefix, u64 rotate_bytes)
+{
+    if (telemetry) return false;
+
+    Telemetry *t = (Telemetry *)Arena_PushZero(arena, sizeof(Telemetry), 64);
+    t->block = (TelemetryRecord *)Arena_Push(arena, TELEMETRY_BLOCK_RECORDS * sizeof(TelemetryRecord), 64);
+    t->session = telemetry_now() ^ ((u64)getpid() << 32);
+    t->rotate_bytes = rotate_bytes ? rotate_bytes : TELEMETRY_ROTATE_BYTES;
+    t->fd = -1;
+    snprintf(t->prefix, sizeof(t->prefix), "%s", path_prefix);
+    t->file_index = telemetry_next_index(t->prefix);
+
+    // Address space for every ring up front, pages only get touched by threads that emit
+    for (u32 r = 0; r < TELEMETRY_MAX_THREADS; r++) {
+        t->rings[r].records = (TelemetryRecord *)Arena_Push(arena, TELEMETRY_RING_RECORDS * sizeof(TelemetryRecord), 64);
+        t->rings[r].index = (u8)r;
+    }
+
+    atomic_store(&t->running, true);
+    atomic_store(&t->accepting, true);
+    if (pthread_create(&t->thread, NULL, telemetry_flush_run, t) != 0) return false;
+
+    telemetry = t;
+    return true;
+}
+
+void Telemetry_Stop(void)
+{
+    Telemetry *t = telemetry;
+    if (!t) return;
+
+    atomic_store_explicit(&t->accepting, false, memory_order_release);
+    atomic_store_explicit(&t->running, false, memory_order_release);
+    pthread_join(t->thread, NULL);
+
+    if (t->fd >= 0) close(t->fd);
+    telemetry = NULL;
+}
+
+u64 Telemetry_Dropped(void)
+{
+    Telemetry *t = telemetry;
+    if (!t) return 0;
+
+    u64 dropped = atomic_load(&t->unclaimed);
+    u32 rings = atomic_load(&t->ring_count);
+    for (u32 r = 0; r < rings && r < TELEMETRY_MAX_THREADS; r++) dropped += t->rings[r].dropped;
+    return dropped;
+}
+
+// The calling thread's ring, claimed on first use
+static TelemetryRing *telemetry_local(Telemetry *t)
+{
+    if (telemetry_ring_owner != t) {
+        u32 index = atomic_fetch_add_explicit(&t->ring_count, 1, memory_order_acq_rel);
+        telemetry_ring = index < TELEMETRY_MAX_THREADS ? &t->rings[index] : NULL;
+        telemetry_ring_owner = t;
+    }
+    return telemetry_ring;
+}
+
+void Telemetry_Emit(TelemetryRecord record)
+{
+    Telemetry *t = telemetry;
+    if (!t || !atomic_load_explicit(&t->accepting, memory_order_relaxed)) return;
+
+    TelemetryRing *ring = telemetry_local(t);
+    if (!ring) {
+        atomic_fetch_add_explicit(&t->unclaimed, 1, memory_order_relaxed);
+        return;
+    }
+
+    u32 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    u32 tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == TELEMETRY_RING_RECORDS) {
+        ring->dropped++;
+        return;
+    }
+
+    if (!record.time_ns) record.time_ns = telemetry_now();
+    record.session = t->session;
+    record.thread = ring->index;
+
+    ring->records[head & (TELEMETRY_RING_RECORDS - 1)] = record;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+
+static TelemetryRecord telemetry_record(const GameState *state, TelemetryType type)
+{
+    return (TelemetryRecord){
+        .time_ns = telemetry_now(),
+        .score = (u32)state->session.current_score,
+        .type = type};
+}
+
+void Telemetry_Session(const GameState *state, bool resumed)
+{
+    TelemetryRecord record = telemetry_record(state, TELEMETRY_SESSION_START);
+    record.value = resumed;
+    Telemetry_Emit(record);
+}
+
+void Telemetry_GameStart(const GameState *state)
+{
+    Telemetry *t = telemetry;
+    if (!t) return;
+
+    TelemetryRing *ring = telemetry_local(t);
+    TelemetryRecord record = telemetry_record(state, TELEMETRY_GAME_START);
+    if (ring) {
+        ring->last_place_ns = record.time_ns;
+        ring->moves = 0;
+        ring->combo = 0;
+    }
+    Telemetry_Emit(record);
+}
+
+void Telemetry_Place(const GameState *state, u8 slot, u8 composite, int gx, int gy, const MoveResult *result)
+{
+    Telemetry *t = telemetry;
+    if (!t) return;
+
+    TelemetryRing *ring = telemetry_local(t);
+    TelemetryRecord record = telemetry_record(state, TELEMETRY_PLACE);
+    record.slot = slot;
+    record.composite = composite;
+    record.gx = (i8)gx;
+    record.gy = (i8)gy;
+    record.lines = result->lines;
+
+    if (ring) {
+        // First placement of a resumed session has no start to measure from
+        if (ring->last_place_ns) record.value = (u32)((record.time_ns - ring->last_place_ns) / 1000000ull);
+        ring->last_place_ns = record.time_ns;
+        ring->moves++;
+        ring->combo = result->lines ? (u8)(ring->combo < 255 ? ring->combo + 1 : 255) : 0;
+        record.combo = ring->combo;
+    }
+    Telemetry_Emit(record);
+}
+
+void Telemetry_Reject(const GameState *state, u8 slot, u8 composite, int gx, int gy)
+{
+    TelemetryRecord record = telemetry_record(state, TELEMETRY_REJECT);
+    record.slot = slot;
+    record.composite = composite;
+    record.gx = (i8)gx;
+    record.gy = (i8)gy;
+    Telemetry_Emit(record);
+}
+
+void Telemetry_GameEnd(const GameState *state, bool abandoned)
+{
+    Telemetry *t = telemetry;
+    if (!t) return;
+
+    TelemetryRing *ring = telemetry_local(t);
+    TelemetryRecord record = telemetry_record(state, abandoned ? TELEMETRY_ABANDON : TELEMETRY_GAME_OVER);
+    record.value = ring ? ring->moves : 0;
+    Telemetry_Emit(record);
+}
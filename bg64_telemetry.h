@@ -0,0 +1,79 @@
+#ifndef BG64_TELEMETRY_H_
+#define BG64_TELEMETRY_H_
+
+
+#include "bg64.h"
+
+
+// TELEMETRY
+// Fixed size binary records of what players do on the board. The frame loop only ever
+// copies a record into its thread's single producer ring (no locks, no stdio, no
+// syscalls); a background thread drains every ring in large blocks with write(2) into
+// numbered files that rotate at a size limit. A full ring drops records and counts them.
+//
+// File: one TelemetryFileHeader, then records back to back until the file rotates.
+// prefix.000000.bgtl, prefix.000001.bgtl, ... A run starts one past the highest index
+// already on disk and never overwrites a file.
+typedef enum : u8 {
+    TELEMETRY_SESSION_START = 0, // value: 1 when a save was resumed
+    TELEMETRY_PLACE,             // accepted placement, value: ms since the previous placement or game start
+    TELEMETRY_REJECT,            // drop on an illegal cell
+    TELEMETRY_GAME_START,
+    TELEMETRY_GAME_OVER,         // value: placements this game
+    TELEMETRY_ABANDON,           // left with moves still available, value: placements this game
+    TELEMETRY_TYPE_COUNT
+} TelemetryType;
+
+typedef struct
+{
+    u64 time_ns;    // CLOCK_REALTIME
+    u64 session;    // id of the process run that wrote it
+    u32 score;      // score after the event
+    u32 value;      // see TelemetryType
+    u8 type;        // TelemetryType
+    u8 slot;
+    u8 composite;   // piece placed, composite byte
+    i8 gx;
+    i8 gy;
+    u8 lines;       // rows + columns cleared
+    u8 combo;       // consecutive clearing placements, this one included
+    u8 thread;      // producer ring index
+} TelemetryRecord; // 32 bytes
+
+typedef struct
+{
+    u32 magic;
+    u16 version;
+    u16 record_size;
+    u64 created_ns;
+    u64 file_index;
+    u64 _reserved;
+} TelemetryFileHeader; // 32 bytes, keeps records 32 byte aligned in the file
+
+_Static_assert(sizeof(TelemetryRecord) == 32, "TelemetryRecord is 32 bytes on disk");
+_Static_assert(sizeof(TelemetryFileHeader) == 32, "TelemetryFileHeader is 32 bytes on disk");
+
+#define TELEMETRY_MAGIC 0x4C544742 // "BGTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_THREADS 64
+#define TELEMETRY_RING_RECORDS 16384      // per producer thread, power of two
+#define TELEMETRY_BLOCK_RECORDS 8192      // records per write(2)
+#define TELEMETRY_ROTATE_BYTES ((u64)256 * 1024 * 1024)
+
+// Starts the flush thread, rings and staging come from the arena. rotate_bytes 0 uses
+// TELEMETRY_ROTATE_BYTES. Emitting before Start or after Stop is a no-op.
+bool Telemetry_Start(Arena *arena, const char *path_prefix, u64 rotate_bytes);
+void Telemetry_Stop(void); // drains everything still queued, then joins the thread
+u64 Telemetry_Dropped(void);
+
+void Telemetry_Emit(TelemetryRecord record);
+
+// Game level helpers: fill in time, session, combo and timing state for the caller
+void Telemetry_Session(const GameState *state, bool resumed);
+void Telemetry_GameStart(const GameState *state);
+void Telemetry_Place(const GameState *state, u8 slot, u8 composite, int gx, int gy, const MoveResult *result);
+void Telemetry_Reject(const GameState *state, u8 slot, u8 composite, int gx, int gy);
+void Telemetry_GameEnd(const GameState *state, bool abandoned);
+
+
+#endif /* BG64_TELEMETRY_H_ */
@@ -1,6 +1,11 @@
 #include <stdio.h>
 #include <math.h>
 #include "bg64.h"
+#include "bg64_history.h"
+#include "bg64_input.h"
+#include "bg64_preview.h"
+#include "bg64_particles.h"
+#include "bg64_telemetry.h"
 
 
 int main(void) 
@@ -11,8 +16,24 @@ int main(void)
     // load new seed each session for block gen uniqueness
     Arena game_arena = GameArena_Allocation(ARENA_SIZE);
     GameState *state = GameState_Allocation(&game_arena);
+
+    // Analytics run for the whole session, the frame loop only ever copies records into a ring
+    Telemetry_Start(&game_arena, "telemetry", 0);
     GameState_Initialization(state);
 
+    // Undo history lives next to the state, streamed since it is rarely read back
+    SnapshotRing history = SnapshotRing_Allocation(&game_arena, HISTORY_CAPACITY, true);
+
+    // Input sampled per frame, consumed per logic tick
+    InputQueue *input = (InputQueue *)Arena_PushZero(&game_arena, sizeof(InputQueue), 64);
+
+    // Drop preview, recomputed only when the snapped cell or the board changes
+    PlacementPreview preview = { 0 };
+    Preview_Invalidate(&preview);
+
+    // Effects pool, the last allocation that happens outside the per frame scratch
+    ParticlePool fx = Particles_Allocation(&game_arena, PARTICLE_CAPACITY, state->utility.rng_seed);
+
 
     const i32 virtual_width = 360;
     const i32 virtual_height = 780;
@@ -31,9 +52,27 @@ int main(void)
     RenderTexture2D target = LoadRenderTexture(virtual_width, virtual_height);
     SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR); // bilinear filter does
 
+    // Fixed timestep clock: logic advances in LOGIC_TICK_DT steps, the accumulator holds
+    // the simulated time not yet covered by a tick
+    u64 tick = 0;
+    f64 accumulator = 0.0;
+    f64 previous_time = GetTime();
+
     ring_buffer_consume_batch(state, state->session.deck_shape_color_bits, 3);
     while(!WindowShouldClose()) {
 
+        // Per frame scratch, everything pushed this frame is dropped at the end of it
+        ArenaMark frame_scratch = Arena_Save(&game_arena);
+
+        // Input polled this frame happened somewhere in the frame that just ended: stamp it
+        // with that frame's start so the first tick run below already consumes it
+        f64 input_time = (f64)tick * LOGIC_TICK_DT + accumulator;
+
+        f64 now = GetTime();
+        f64 frame_time = now - previous_time;
+        previous_time = now;
+        accumulator += (frame_time > LOGIC_MAX_FRAME) ? LOGIC_MAX_FRAME : frame_time;
+
         // 1: GETTING USER IO; Input + Coordinates
         Vector2 mouse = GetMousePosition();
         Vector2 virtualMouse = {
@@ -52,9 +91,10 @@ int main(void)
         switch (state->utility.current_screen) {
             case 0: // Main screen
                 UpdateMenus(state, virtualMouse);
+                InputQueue_Clear(input);
                 break;
             case 1: // Game screen
-                UpdateGameLogic(state, virtualMouse, offsetX, offsetY, cellSize);
+                InputQueue_Sample(input, input_time, virtualMouse);
                 break;
             case 2: // Game lost
             
@@ -68,6 +108,24 @@ int main(void)
         }
 
 
+        // Logic ticks, as many as the elapsed time covers (none on a fast frame, several after a slow one)
+        while (accumulator >= LOGIC_TICK_DT) {
+            tick++;
+            accumulator -= LOGIC_TICK_DT;
+            if (state->utility.current_screen == SCREEN_GAMEPLAY) {
+                UpdateGameLogic(state, &history, input, &fx, (f64)tick * LOGIC_TICK_DT, offsetX, offsetY, cellSize);
+            }
+        }
+
+        Preview_Update(&preview, state, offsetX, offsetY, cellSize);
+
+        // Effects are cosmetic, they follow the render clock rather than the logic ticks
+        Particles_Update(&fx, (f32)frame_time);
+
+        // Fraction of a tick the present is ahead of the logic, for interpolation
+        f32 alpha = (f32)(accumulator / LOGIC_TICK_DT);
+
+
         // Render to 
         BeginTextureMode(target);
             ClearBackground(DARKGRAY);
@@ -79,7 +137,8 @@ int main(void)
                     break;
 
                 case 1:
-                    RenderGameScreen(state, offsetX, offsetY, cellSize, virtual_width);
+                    RenderGameScreen(state, &preview, offsetX, offsetY, cellSize, virtual_width, alpha);
+                    Particles_Draw(&fx);
                     break;
 
                 case 2: 
@@ -117,9 +176,15 @@ int main(void)
             (Vector2){ 0, 0 }, 0.0f, WHITE);
         EndDrawing();
 
+        Arena_Restore(frame_scratch);
     }
 
+    // Quitting mid game counts as abandoning it
+    if (state->utility.current_screen == SCREEN_GAMEPLAY && GameState_HasMove(state)) Telemetry_GameEnd(state, true);
+    Telemetry_Stop();
+
     CloseWindow();
+    Arena_Release(&game_arena);
     return 0;
 
 
@@ -0,0 +1,223 @@
+// BG64 ADVERSARY
+// Searches how fast an adversarial piece generator forces a perfect player into game over
+// (bg64_adversary) on a set of boards, and prints the shortest forcing sequences and the
+// boards that are most fragile: forced soonest, then by the most decks that end the game
+// at once. Boards come from greedy games stopped after a random number of moves, or --grid
+// searches a single board. Worker threads pull boards from a shared counter, each with its
+// own transposition table.
+//
+// usage: adversary [--grid HEX] [--boards N] [--seed S] [--decks D] [--nodes N]
+//                  [--threads T] [--table-bits B] [--top K]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+#include "bg64_adversary.h"
+
+typedef struct
+{
+    u64 grid;
+    u32 moves;            // greedy moves that led to the board
+    AdversaryResult result;
+} AdversaryJob;
+
+typedef struct
+{
+    AdversaryJob *jobs;
+    u32 job_count;
+    u32 decks;
+    u64 nodes;
+    atomic_uint next_job;
+} AdversaryWork;
+
+typedef struct
+{
+    AdversaryWork *work;
+    Adversary adversary;
+} AdversaryWorker;
+
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static void *worker_run(void *arg)
+{
+    AdversaryWorker *worker = (AdversaryWorker *)arg;
+    AdversaryWork *work = worker->work;
+
+    for (;;) {
+        u32 j = atomic_fetch_add_explicit(&work->next_job, 1, memory_order_relaxed);
+        if (j >= work->job_count) break;
+
+        AdversaryJob *job = &work->jobs[j];
+        Adversary_Search(&worker->adversary, job->grid, work->decks, work->nodes, true, &job->result);
+    }
+    return NULL;
+}
+
+// A greedy game stopped after 8 to 71 moves, or where it got stuck
+static AdversaryJob sample_board(u64 seed)
+{
+    GameState state;
+    GameState_Reset(&state, seed);
+    u64 rng = seed * 0x9E3779B97F4A7C15ull | 1;
+    u32 moves = 8 + (u32)(xorshift(&rng) % 64);
+
+    AdversaryJob job = { 0 };
+    EvalMove move;
+    while (job.moves < moves && Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &state, &move)) {
+        ApplyMove(&state, move.slot, move.gx, move.gy, NULL);
+        job.moves++;
+    }
+    job.grid = state.grid.game_grid;
+    return job;
+}
+
+// Forced soonest first, then the most decks that end the game at once, unsolved last
+static int compare_fragile(const void *a, const void *b)
+{
+    const AdversaryResult *x = &((const AdversaryJob *)a)->result;
+    const AdversaryResult *y = &((const AdversaryJob *)b)->result;
+    u32 kx = x->forced ? x->value : ADVERSARY_MAX_DECKS + (u32)!x->complete;
+    u32 ky = y->forced ? y->value : ADVERSARY_MAX_DECKS + (u32)!y->complete;
+    if (kx != ky) return kx < ky ? -1 : 1;
+    if (x->forcing_decks != y->forcing_decks) return x->forcing_decks > y->forcing_decks ? -1 : 1;
+    return 0;
+}
+
+static void print_grid(u64 before, u64 after)
+{
+    for (u32 y = 0; y < 8; y++) {
+        printf("      ");
+        for (u32 x = 0; x < 8; x++) printf("%c ", ((before >> (63 - (y * 8 + x))) & 1) ? '#' : '.');
+        printf("   ");
+        for (u32 x = 0; x < 8; x++) printf("%c ", ((after >> (63 - (y * 8 + x))) & 1) ? '#' : '.');
+        printf("\n");
+    }
+}
+
+static void print_job(u32 rank, const AdversaryJob *job)
+{
+    const AdversaryResult *r = &job->result;
+    printf("%3u. grid %016llx after %u moves: ", rank, (unsigned long long)job->grid, job->moves);
+    if (r->forced) printf("forced within %u deck%s", r->value + 1, r->value ? "s" : "");
+    else if (r->complete) printf("survives %u decks", r->horizon);
+    else printf("unsolved past %u decks", r->horizon);
+    printf(", %u of %u decks end the game at once (%llu nodes)\n", r->forcing_decks, ADVERSARY_DECKS,
+           (unsigned long long)r->nodes);
+
+    u64 grid = job->grid;
+    for (u32 d = 0; d < r->line_decks; d++) {
+        const AdversaryStep *step = &r->line[d];
+        printf("    deck %u: %s %s %s, ", d + 1, SHAPE_INFO[step->shapes[0]].name, SHAPE_INFO[step->shapes[1]].name,
+               SHAPE_INFO[step->shapes[2]].name);
+        for (u32 k = 0; k < step->placed; k++) {
+            printf("%s at %u,%u%s", SHAPE_INFO[step->order[k]].name, step->cells[k] % 8, step->cells[k] / 8,
+                   k + 1 < step->placed ? ", " : "");
+        }
+        printf("%s%s\n", step->placed ? ", " : "", step->placed == 3 ? "all placed" : "stuck");
+        print_grid(grid, step->grid_after);
+        grid = step->grid_after;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    u64 grid = 0;
+    bool grid_set = false;
+    u32 boards = 64;
+    u64 seed = 0xB664;
+    u32 decks = 3;
+    u64 nodes = 20000000;
+    u32 threads = (u32)sysconf(_SC_NPROCESSORS_ONLN);
+    u32 table_bits = 20;
+    u32 top = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = strtoull(argv[++i], NULL, 16);
+            grid_set = true;
+        }
+        else if (strcmp(argv[i], "--boards") == 0 && i + 1 < argc) boards = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) decks = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) nodes = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--table-bits") == 0 && i + 1 < argc) table_bits = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) top = (u32)strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [--grid HEX] [--boards N] [--seed S] [--decks D] [--nodes N]\n"
+                            "          [--threads T] [--table-bits B] [--top K]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (grid_set) boards = 1;
+    if (boards == 0) boards = 1;
+    if (decks < 1 || decks > ADVERSARY_MAX_DECKS) decks = 3;
+    if (table_bits < 10 || table_bits > 26) table_bits = 20;
+    if (threads == 0) threads = 1;
+    if (threads > 256) threads = 256;
+    if (threads > boards) threads = boards;
+
+    // One transposition table per thread, probed at random: huge pages save the TLB misses
+    Arena arena = Arena_Reserve(ARENA_SIZE, ARENA_HUGE_PAGES);
+    AdversaryJob *jobs = (AdversaryJob *)Arena_PushZero(&arena, (u64)boards * sizeof(AdversaryJob), 64);
+    for (u32 b = 0; b < boards; b++) {
+        if (grid_set) jobs[b] = (AdversaryJob){ .grid = grid };
+        else jobs[b] = sample_board(seed + b);
+    }
+
+    AdversaryWork work = {
+        .jobs = jobs,
+        .job_count = boards,
+        .decks = decks,
+        .nodes = nodes};
+    atomic_init(&work.next_job, 0);
+
+    AdversaryWorker workers[256];
+    pthread_t handles[256];
+    for (u32 t = 0; t < threads; t++) workers[t] = (AdversaryWorker){ &work, Adversary_Allocation(&arena, table_bits) };
+
+    f64 start = now_seconds();
+    for (u32 t = 0; t < threads; t++) pthread_create(&handles[t], NULL, worker_run, &workers[t]);
+    for (u32 t = 0; t < threads; t++) pthread_join(handles[t], NULL);
+    f64 elapsed = now_seconds() - start;
+
+    // Forcing distance histogram, then the most fragile boards with their lines
+    u32 forced[ADVERSARY_MAX_DECKS] = { 0 };
+    u32 survived = 0, unsolved = 0;
+    u64 total_nodes = 0;
+    for (u32 b = 0; b < boards; b++) {
+        const AdversaryResult *r = &jobs[b].result;
+        if (r->forced) forced[r->value]++;
+        else if (r->complete) survived++;
+        else unsolved++;
+        total_nodes += r->nodes;
+    }
+
+    printf("adversary: %u boards, %u decks deep, %u threads, %.2fs (%.2f M nodes/s)\n", boards, decks, threads, elapsed,
+           total_nodes / (elapsed > 0 ? elapsed : 1e-9) / 1e6);
+    for (u32 d = 0; d < decks; d++) {
+        if (forced[d]) printf("  forced within %u deck%s: %u\n", d + 1, d ? "s" : "", forced[d]);
+    }
+    printf("  survive %u decks: %u\n", decks, survived);
+    if (unsolved) printf("  node budget ran out: %u\n", unsolved);
+
+    qsort(jobs, boards, sizeof(AdversaryJob), compare_fragile);
+    if (top > boards) top = boards;
+    for (u32 b = 0; b < top; b++) print_job(b + 1, &jobs[b]);
+
+    Arena_Release(&arena);
+    return 0;
+}
@@ -0,0 +1,273 @@
+// BG64 LOAD TEST CLIENT
+// Drives a bg64_server with batched random legal moves from several connections and
+// reports throughput. Each connection owns a disjoint range of sessions and mirrors the
+// board/deck from the replies so every request it sends is a legal placement.
+//
+// usage: bg64_client [--socket PATH] [--sessions N] [--connections C] [--batch B] [--seconds T]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "bg64.h"
+#include "bg64_protocol.h"
+
+typedef struct
+{
+    const char *socket_path;
+    u32 first_session;
+    u32 session_count;
+    u32 batch;
+    f64 seconds;
+    u64 seed;
+
+    // results
+    u64 moves;
+    u64 accepted;
+    u64 games;
+    u64 batches;
+    f64 elapsed;
+} Worker;
+
+typedef struct
+{
+    u64 game_grid;
+    u8 deck[3];
+    u8 flags;
+} SessionMirror;
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static bool send_all(i32 fd, const void *data, usize len)
+{
+    const u8 *p = (const u8 *)data;
+    while (len) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (usize)n;
+    }
+    return true;
+}
+
+static bool recv_all(i32 fd, void *data, usize len)
+{
+    u8 *p = (u8 *)data;
+    while (len) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (usize)n;
+    }
+    return true;
+}
+
+// Random legal move from the mirrored board, false when nothing fits
+static bool pick_move(const SessionMirror *mirror, u64 *rng, MoveRequest *req)
+{
+    u64 r = xorshift(rng);
+    u8 start = (u8)(r % 3);
+
+    for (u8 k = 0; k < 3; k++) {
+        u8 slot = (u8)((start + k) % 3);
+        if (mirror->flags & (1u << (REPLY_ACTIVE_SHIFT + slot))) continue;
+
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(mirror->deck[slot])];
+
+        // Legal anchors: in bounds and collision free
+        u64 legal = 0;
+        u64 anchors = shape->anchors;
+        while (anchors) {
+            u32 bit = 63 - (u32)__builtin_ctzll(anchors);
+            anchors &= anchors - 1;
+            if (!(mirror->game_grid & (shape->mask >> bit))) legal |= 1ull << (63 - bit);
+        }
+        if (!legal) continue;
+
+        // Pick the n-th legal anchor
+        u32 n = (u32)((r >> 8) % (u64)__builtin_popcountll(legal));
+        while (n--) legal &= legal - 1;
+        u32 bit = 63 - (u32)__builtin_ctzll(legal);
+
+        req->op = OP_MOVE;
+        req->slot = slot;
+        req->gx = (i8)(bit & 7);
+        req->gy = (i8)(bit >> 3);
+        return true;
+    }
+
+    return false;
+}
+
+static void *worker_run(void *arg)
+{
+    Worker *w = (Worker *)arg;
+
+    i32 fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", w->socket_path);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bg64_client: connect");
+        return NULL;
+    }
+
+    usize req_size = sizeof(BatchHeader) + w->batch * sizeof(MoveRequest);
+    usize rep_size = sizeof(BatchHeader) + w->batch * sizeof(MoveReply);
+    u8 *req_buf = (u8 *)aligned_alloc(64, (req_size + 63) & ~(usize)63);
+    u8 *rep_buf = (u8 *)aligned_alloc(64, (rep_size + 63) & ~(usize)63);
+    SessionMirror *mirrors = (SessionMirror *)calloc(w->session_count, sizeof(SessionMirror));
+
+    BatchHeader *req_header = (BatchHeader *)req_buf;
+    MoveRequest *requests = (MoveRequest *)(req_buf + sizeof(BatchHeader));
+    MoveReply *replies = (MoveReply *)(rep_buf + sizeof(BatchHeader));
+    u64 rng = w->seed ? w->seed : 0xFEED;
+
+    // Start every owned session from a fresh game
+    for (u32 base = 0; base < w->session_count; base += w->batch) {
+        u32 count = w->session_count - base < w->batch ? w->session_count - base : w->batch;
+        *req_header = (BatchHeader){ BG64_PROTOCOL_MAGIC, count };
+        for (u32 i = 0; i < count; i++) requests[i] = (MoveRequest){ .session = w->first_session + base + i, .op = OP_RESET };
+
+        if (!send_all(fd, req_buf, sizeof(BatchHeader) + count * sizeof(MoveRequest)) ||
+            !recv_all(fd, rep_buf, sizeof(BatchHeader) + count * sizeof(MoveReply))) goto done;
+
+        for (u32 i = 0; i < count; i++) {
+            SessionMirror *m = &mirrors[base + i];
+            m->game_grid = replies[i].game_grid;
+            memcpy(m->deck, replies[i].deck, 3);
+            m->flags = replies[i].flags;
+        }
+    }
+
+    u32 cursor = 0;
+    f64 start = now_seconds();
+    f64 end = start + w->seconds;
+
+    while (now_seconds() < end) {
+        // Round robin over owned sessions, one request per session per batch
+        u32 count = w->batch < w->session_count ? w->batch : w->session_count;
+        for (u32 i = 0; i < count; i++) {
+            u32 local = cursor;
+            cursor = (cursor + 1 == w->session_count) ? 0 : cursor + 1;
+
+            MoveRequest *req = &requests[i];
+            *req = (MoveRequest){ .session = w->first_session + local };
+
+            if ((mirrors[local].flags & REPLY_GAME_OVER) || !pick_move(&mirrors[local], &rng, req)) {
+                req->op = OP_RESET;
+                w->games++;
+            }
+        }
+
+        *req_header = (BatchHeader){ BG64_PROTOCOL_MAGIC, count };
+        if (!send_all(fd, req_buf, sizeof(BatchHeader) + count * sizeof(MoveRequest)) ||
+            !recv_all(fd, rep_buf, sizeof(BatchHeader) + count * sizeof(MoveReply))) break;
+
+        for (u32 i = 0; i < count; i++) {
+            const MoveReply *rep = &replies[i];
+            SessionMirror *m = &mirrors[rep->session - w->first_session];
+            m->game_grid = rep->game_grid;
+            memcpy(m->deck, rep->deck, 3);
+            m->flags = rep->flags;
+
+            if (requests[i].op == OP_MOVE) {
+                w->moves++;
+                if (rep->flags & REPLY_ACCEPTED) w->accepted++;
+            }
+        }
+        w->batches++;
+    }
+
+    w->elapsed = now_seconds() - start;
+
+done:
+    close(fd);
+    free(mirrors);
+    free(req_buf);
+    free(rep_buf);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *socket_path = BG64_SOCKET_PATH;
+    u32 sessions = 4096;
+    u32 connections = 1;
+    u32 batch = 1024;
+    f64 seconds = 5.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socket_path = argv[++i];
+        else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) sessions = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) connections = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batch = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = strtod(argv[++i], NULL);
+        else {
+            fprintf(stderr, "usage: %s [--socket PATH] [--sessions N] [--connections C] [--batch B] [--seconds T]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (connections == 0) connections = 1;
+    if (batch == 0 || batch > BG64_MAX_BATCH) batch = BG64_MAX_BATCH;
+    if (sessions < connections) sessions = connections;
+
+    Worker *workers = (Worker *)calloc(connections, sizeof(Worker));
+    pthread_t *threads = (pthread_t *)calloc(connections, sizeof(pthread_t));
+
+    // Sessions must exist on the server: keep --sessions at or below the server's count
+    u32 per = sessions / connections;
+    for (u32 i = 0; i < connections; i++) {
+        workers[i] = (Worker){
+            .socket_path = socket_path,
+            .first_session = i * per,
+            .session_count = (i + 1 == connections) ? sessions - i * per : per,
+            .batch = batch,
+            .seconds = seconds,
+            .seed = 0x9E3779B97F4A7C15ull * (i + 1)};
+        pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+    }
+
+    u64 moves = 0, accepted = 0, games = 0, batches = 0;
+    f64 elapsed = 0;
+    for (u32 i = 0; i < connections; i++) {
+        pthread_join(threads[i], NULL);
+        moves += workers[i].moves;
+        accepted += workers[i].accepted;
+        games += workers[i].games;
+        batches += workers[i].batches;
+        if (workers[i].elapsed > elapsed) elapsed = workers[i].elapsed;
+    }
+
+    if (elapsed <= 0) {
+        fprintf(stderr, "bg64_client: no batches completed\n");
+        return 1;
+    }
+
+    printf("bg64_client: %u connections, %u sessions, batch %u\n", connections, sessions, batch);
+    printf("  moves     %llu (%llu accepted, %llu games restarted)\n",
+           (unsigned long long)moves, (unsigned long long)accepted, (unsigned long long)games);
+    printf("  rate      %.0f moves/s\n", (f64)moves / elapsed);
+    printf("  round trip %.1f us per batch\n", elapsed * 1e6 * connections / (f64)(batches ? batches : 1));
+
+    free(workers);
+    free(threads);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef BG64_PROTOCOL_H_
+#define BG64_PROTOCOL_H_
+
+
+#include "bg64.h"
+
+
+// BG64 SESSION SERVER WIRE FORMAT
+// Local only (Unix domain socket), so records are native endian fixed size structs.
+// A frame is a BatchHeader followed by count records; every request frame gets exactly
+// one reply frame with the same count, records in request order.
+
+#define BG64_SOCKET_PATH "/tmp/bg64.sock"
+#define BG64_PROTOCOL_MAGIC 0x42473634 // "BG64"
+#define BG64_MAX_BATCH 4096
+
+typedef struct
+{
+    u32 magic;
+    u32 count;
+} BatchHeader; // 8 bytes
+
+typedef enum : u8 {
+    OP_MOVE = 0,   // place deck slot at (gx, gy)
+    OP_RESET,      // start a new game, seed taken from the session id and server seed
+    OP_QUERY       // no change, just report
+} SessionOp;
+
+typedef struct
+{
+    u32 session;   // index into the server's GameState array
+    u8 op;         // SessionOp
+    u8 slot;
+    i8 gx;
+    i8 gy;
+} MoveRequest; // 8 bytes
+
+#define REPLY_ACCEPTED  (1u << 0)  // the move was legal and committed
+#define REPLY_GAME_OVER (1u << 1)  // no deck piece fits anywhere
+#define REPLY_BAD_SESSION (1u << 2)
+#define REPLY_ACTIVE_SHIFT 4       // bits 4..6: deck slot i already placed
+
+typedef struct
+{
+    u64 game_grid;
+    u64 score;
+    u32 session;
+    u8 deck[3];    // composite bytes
+    u8 flags;      // REPLY_* bits
+} MoveReply; // 24 bytes
+
+_Static_assert(sizeof(MoveRequest) == 8, "MoveRequest is 8 bytes on the wire");
+_Static_assert(sizeof(MoveReply) == 24, "MoveReply is 24 bytes on the wire");
+
+
+#endif /* BG64_PROTOCOL_H_ */
@@ -0,0 +1,352 @@
+// BG64 SESSION SERVER
+// Headless daemon hosting many games in one process. Every session is a GameState in
+// one contiguous, 64 byte aligned array carved from the Arena; clients send batches of
+// moves over a Unix domain socket and get the resulting board, score and deck back.
+//
+// usage: bg64_server [--socket PATH] [--sessions N] [--seed S]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "bg64.h"
+#include "bg64_protocol.h"
+
+#define MAX_CLIENTS 64
+#define IN_BUFFER_SIZE (sizeof(BatchHeader) + BG64_MAX_BATCH * sizeof(MoveRequest))
+#define OUT_BUFFER_SIZE (sizeof(BatchHeader) + BG64_MAX_BATCH * sizeof(MoveReply))
+
+typedef struct
+{
+    i32 fd;          // -1 when the slot is free
+    usize in_len;    // bytes buffered from the socket
+    usize out_len;   // reply bytes still to send
+    usize out_sent;
+    bool parked;     // waiting on EPOLLOUT for the rest of a reply
+    u8 *in;
+    u8 *out;
+} Client;
+
+typedef struct
+{
+    GameState *sessions;
+    u32 session_count;
+    u64 seed;
+
+    Client clients[MAX_CLIENTS];
+
+    u64 moves;       // requests applied
+    u64 accepted;    // legal moves committed
+    u64 batches;
+} Server;
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    running = 0;
+}
+
+static u64 now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+static u64 session_seed(const Server *server, u32 session)
+{
+    // Distinct non zero xorshift seed per session, stable across restarts
+    u64 seed = server->seed ^ ((u64)(session + 1) * 0x9E3779B97F4A7C15ull);
+    return seed ? seed : 0xFEED;
+}
+
+static void fill_reply(const GameState *state, u32 session, u8 flags, MoveReply *reply)
+{
+    reply->game_grid = state->grid.game_grid;
+    reply->score = state->session.current_score;
+    reply->session = session;
+    memcpy(reply->deck, state->session.deck_shape_color_bits, 3);
+
+    for (u8 i = 0; i < 3; i++) {
+        if (state->session.is_active[i]) flags |= (u8)(1u << (REPLY_ACTIVE_SHIFT + i));
+    }
+    if (!GameState_HasMove(state)) flags |= REPLY_GAME_OVER;
+
+    reply->flags = flags;
+}
+
+// Apply one batch in place: requests in, replies out
+static void process_batch(Server *server, const MoveRequest *requests, u32 count, MoveReply *replies)
+{
+    for (u32 i = 0; i < count; i++) {
+        const MoveRequest *req = &requests[i];
+
+        // Pull the next request's session in while this one is applied
+        if (i + 1 < count && requests[i + 1].session < server->session_count) {
+            __builtin_prefetch(&server->sessions[requests[i + 1].session], 1);
+        }
+
+        if (req->session >= server->session_count) {
+            memset(&replies[i], 0, sizeof(MoveReply));
+            replies[i].session = req->session;
+            replies[i].flags = REPLY_BAD_SESSION;
+            continue;
+        }
+
+        GameState *state = &server->sessions[req->session];
+        u8 flags = 0;
+
+        switch (req->op) {
+            case OP_MOVE:
+                if (ApplyMove(state, req->slot, req->gx, req->gy, NULL)) {
+                    flags |= REPLY_ACCEPTED;
+                    server->accepted++;
+                }
+                server->moves++;
+                break;
+
+            case OP_RESET:
+                GameState_Reset(state, session_seed(server, req->session) ^ state->utility.rng_seed);
+                state->utility.current_screen = SCREEN_GAMEPLAY;
+                flags |= REPLY_ACCEPTED;
+                break;
+
+            case OP_QUERY:
+            default:
+                break;
+        }
+
+        fill_reply(state, req->session, flags, &replies[i]);
+    }
+}
+
+static void client_close(i32 epoll_fd, Client *client)
+{
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->fd = -1;
+    client->in_len = client->out_len = client->out_sent = 0;
+    client->parked = false;
+}
+
+// Returns false when the connection has to be dropped
+static bool client_flush(i32 epoll_fd, Client *client)
+{
+    while (client->out_sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_sent, client->out_len - client->out_sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Park the client on writability, reading resumes once the reply is out
+                if (!client->parked) {
+                    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = client };
+                    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+                    client->parked = true;
+                }
+                return true;
+            }
+            return false;
+        }
+        client->out_sent += (usize)n;
+    }
+
+    client->out_len = client->out_sent = 0;
+    if (client->parked) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = client };
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+        client->parked = false;
+    }
+    return true;
+}
+
+// Handles the complete frame at the front of the input buffer.
+// Returns 1 when a frame was answered, 0 when more bytes are needed, -1 on a bad frame.
+static i32 client_process_frame(Server *server, i32 epoll_fd, Client *client)
+{
+    if (client->in_len < sizeof(BatchHeader)) return 0;
+
+    BatchHeader header;
+    memcpy(&header, client->in, sizeof(header));
+    if (header.magic != BG64_PROTOCOL_MAGIC || header.count > BG64_MAX_BATCH) {
+        fprintf(stderr, "bg64_server: bad frame header, dropping client\n");
+        return -1;
+    }
+
+    usize frame = sizeof(BatchHeader) + header.count * sizeof(MoveRequest);
+    if (client->in_len < frame) return 0;
+
+    BatchHeader *reply_header = (BatchHeader *)client->out;
+    reply_header->magic = BG64_PROTOCOL_MAGIC;
+    reply_header->count = header.count;
+
+    process_batch(server, (const MoveRequest *)(client->in + sizeof(BatchHeader)), header.count,
+                  (MoveReply *)(client->out + sizeof(BatchHeader)));
+    server->batches++;
+
+    // Keep any pipelined bytes of the next frame
+    memmove(client->in, client->in + frame, client->in_len - frame);
+    client->in_len -= frame;
+
+    client->out_len = sizeof(BatchHeader) + header.count * sizeof(MoveReply);
+    client->out_sent = 0;
+    return client_flush(epoll_fd, client) ? 1 : -1;
+}
+
+// Returns false when the connection has to be dropped
+static bool client_read(Server *server, i32 epoll_fd, Client *client)
+{
+    for (;;) {
+        // Only one reply frame is buffered per client, wait for it to drain
+        if (client->out_len) return true;
+
+        // Frames already buffered go first, then pull more bytes
+        i32 handled = client_process_frame(server, epoll_fd, client);
+        if (handled < 0) return false;
+        if (handled > 0) continue;
+
+        ssize_t n = recv(client->fd, client->in + client->in_len, IN_BUFFER_SIZE - client->in_len, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client->in_len += (usize)n;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *socket_path = BG64_SOCKET_PATH;
+    u32 session_count = 4096;
+    u64 seed = (u64)time(NULL);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socket_path = argv[++i];
+        else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) session_count = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else {
+            fprintf(stderr, "usage: %s [--socket PATH] [--sessions N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (session_count == 0) session_count = 1;
+
+    // Every session back to back: session i is exactly 4 cache lines at sessions + i
+    Arena arena = GameArena_Allocation(ARENA_SIZE);
+    Server *server = (Server *)Arena_PushZero(&arena, sizeof(Server), 64);
+    server->sessions = (GameState *)Arena_Push(&arena, (usize)session_count * sizeof(GameState), 64);
+    server->session_count = session_count;
+    server->seed = seed;
+
+    for (u32 i = 0; i < session_count; i++) {
+        GameState_Reset(&server->sessions[i], session_seed(server, i));
+        server->sessions[i].utility.current_screen = SCREEN_GAMEPLAY;
+    }
+
+    for (u32 i = 0; i < MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+        server->clients[i].in = (u8 *)Arena_Push(&arena, IN_BUFFER_SIZE, 64);
+        server->clients[i].out = (u8 *)Arena_Push(&arena, OUT_BUFFER_SIZE, 64);
+    }
+
+    i32 listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    unlink(socket_path);
+
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, MAX_CLIENTS) < 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    i32 epoll_fd = epoll_create1(0);
+    struct epoll_event listen_ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &listen_ev);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("bg64_server: %u sessions (%zu KB) on %s\n", session_count,
+           (usize)session_count * sizeof(GameState) / 1024, socket_path);
+
+    u64 report_at = now_ns() + 1000000000ull;
+    u64 last_moves = 0;
+
+    struct epoll_event events[MAX_CLIENTS + 1];
+    while (running) {
+        i32 ready = epoll_wait(epoll_fd, events, MAX_CLIENTS + 1, 250);
+        if (ready < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+
+        for (i32 e = 0; e < ready; e++) {
+            Client *client = (Client *)events[e].data.ptr;
+
+            if (!client) {
+                // New connections, take every free slot we have
+                i32 fd;
+                while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+                    Client *slot = NULL;
+                    for (u32 i = 0; i < MAX_CLIENTS && !slot; i++) {
+                        if (server->clients[i].fd < 0) slot = &server->clients[i];
+                    }
+                    if (!slot) {
+                        close(fd);
+                        continue;
+                    }
+
+                    slot->fd = fd;
+                    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = slot };
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+                }
+                continue;
+            }
+
+            bool ok = true;
+            if (events[e].events & (EPOLLHUP | EPOLLERR)) ok = false;
+            if (ok && (events[e].events & EPOLLOUT)) ok = client_flush(epoll_fd, client);
+            if (ok && !client->out_len) ok = client_read(server, epoll_fd, client);
+            if (!ok) client_close(epoll_fd, client);
+        }
+
+        u64 now = now_ns();
+        if (now >= report_at) {
+            if (server->moves != last_moves) {
+                printf("bg64_server: %llu moves/s, %llu total, %llu accepted, %llu batches\n",
+                       (unsigned long long)(server->moves - last_moves), (unsigned long long)server->moves,
+                       (unsigned long long)server->accepted, (unsigned long long)server->batches);
+            }
+            last_moves = server->moves;
+            report_at = now + 1000000000ull;
+        }
+    }
+
+    for (u32 i = 0; i < MAX_CLIENTS; i++) {
+        if (server->clients[i].fd >= 0) client_close(epoll_fd, &server->clients[i]);
+    }
+    close(epoll_fd);
+    close(listen_fd);
+    unlink(socket_path);
+
+    printf("bg64_server: shut down after %llu moves\n", (unsigned long long)server->moves);
+    Arena_Release(&arena);
+    return 0;
+}
@@ -0,0 +1,185 @@
+// BG64 EVALUATION BENCHMARK
+// Times the two board evaluations, the shift-and feature kernel (Eval_ScoreBatch) and
+// the 256 entry line tables (Eval_LineScore), on the same random boards, then plays the
+// same fixed-seed games with the greedy player on each to compare their strength.
+// The transposed section expands every child of each board for three random pieces and
+// line scores it, once transposing every child on the fly and once keeping a Board8T.
+// Which one wins depends on the host and the build: kept transposed measured 1.03-1.07x
+// at -O2 on an AVX-512 Xeon (-march=native or x86-64-v2) but 0.93-0.96x there at the
+// Makefile's -Og, and 0.90x on another host. The line says which ISA it was built for
+// and which side won on the host it ran on.
+//
+// usage: eval_bench [--boards N] [--games G] [--max-moves M] [--seed S]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+#include "bg64_board.h"
+
+#if defined(__AVX512F__)
+#define BENCH_ISA "AVX-512"
+#elif defined(__AVX2__)
+#define BENCH_ISA "AVX2"
+#else
+#define BENCH_ISA "SSE2"
+#endif
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+typedef struct
+{
+    u64 score;
+    u64 moves;
+} GameTotals;
+
+static GameTotals play_games(const EvalWeights *weights, const EvalLineTable *table, u32 games, u32 max_moves, u64 seed)
+{
+    GameTotals totals = { 0 };
+    for (u32 g = 0; g < games; g++) {
+        GameState state;
+        GameState_Reset(&state, seed + g);
+
+        EvalMove move;
+        for (u32 m = 0; m < max_moves; m++) {
+            bool found = table ? Eval_LineBestMove(table, &state, &move) : Eval_BestMove(weights, &state, &move);
+            if (!found) break;
+            ApplyMove(&state, move.slot, move.gx, move.gy, NULL);
+            totals.moves++;
+        }
+        totals.score += state.session.current_score;
+    }
+    return totals;
+}
+
+// Children of grid for the three shapes, each transposed on the fly for its column lookups
+static f32 expand_on_the_fly(const EvalLineTable *table, u64 grid, const ShapeInfo *const *shapes, u32 *children)
+{
+    f32 sum = 0;
+    for (u32 s = 0; s < 3; s++) {
+        for (u64 a = shapes[s]->anchors; a; a &= a - 1) {
+            u64 placed = shapes[s]->mask >> (63 - u64_ctz(a));
+            if (grid & placed) continue;
+
+            u64 child = grid | placed;
+            child &= ~board8_full_lines(child, NULL);
+            sum += Eval_LineScore(table, child);
+            (*children)++;
+        }
+    }
+    return sum;
+}
+
+// The same children with the transposed copy carried through placement and clears
+static f32 expand_transposed(const EvalLineTable *table, Board8T board, const ShapeInfo *const *shapes, u32 *children)
+{
+    f32 sum = 0;
+    for (u32 s = 0; s < 3; s++) {
+        for (u64 a = shapes[s]->anchors; a; a &= a - 1) {
+            u32 bit = 63 - u64_ctz(a);
+            Board8T placed = { shapes[s]->mask >> bit, shapes[s]->transposed >> ((bit & 7) * 8 + (bit >> 3)) };
+            if (board.grid & placed.grid) continue;
+
+            Board8T child = board;
+            board8t_place_and_clear(&child, placed);
+            sum += Eval_LineScoreTransposed(table, child.grid, child.transposed);
+            (*children)++;
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    u32 board_count = 1u << 20;
+    u32 games = 200;
+    u32 max_moves = 2000;
+    u64 seed = 0xB664;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--boards") == 0 && i + 1 < argc) board_count = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) games = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--max-moves") == 0 && i + 1 < argc) max_moves = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else {
+            fprintf(stderr, "usage: %s [--boards N] [--games G] [--max-moves M] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (board_count == 0) board_count = 1;
+
+    Arena arena = GameArena_Allocation(ARENA_SIZE);
+    u64 *boards = (u64 *)Arena_Push(&arena, (usize)board_count * sizeof(u64), 64);
+    f32 *scores = (f32 *)Arena_Push(&arena, (usize)board_count * sizeof(f32), 64);
+
+    // Half full boards on average, the density mid game positions have
+    u64 rng = seed;
+    for (u32 i = 0; i < board_count; i++) boards[i] = (xorshift(&rng) & xorshift(&rng)) | (xorshift(&rng) & xorshift(&rng));
+
+    EvalLineTable table;
+    f64 start = now_seconds();
+    EvalLineTable_Build(&EVAL_LINE_DEFAULT_WEIGHTS, &table);
+    f64 build = now_seconds() - start;
+
+    start = now_seconds();
+    Eval_ScoreBatch(&EVAL_DEFAULT_WEIGHTS, boards, board_count, scores);
+    f64 features = now_seconds() - start;
+    f32 check = 0;
+    for (u32 i = 0; i < board_count; i++) check += scores[i];
+
+    start = now_seconds();
+    for (u32 i = 0; i < board_count; i++) scores[i] = Eval_LineScore(&table, boards[i]);
+    f64 lines = now_seconds() - start;
+    for (u32 i = 0; i < board_count; i++) check += scores[i];
+
+    printf("eval_bench: %u boards, features %.2f ns/board, line tables %.2f ns/board (tables built in %.1f us) [%g]\n",
+           board_count, features * 1e9 / board_count, lines * 1e9 / board_count, build * 1e6, check);
+
+    // Expansion, one random deck per board; the Board8T is built once per parent
+    const ShapeInfo *(*decks)[3] = (const ShapeInfo *(*)[3])Arena_Push(&arena, (usize)board_count * sizeof(*decks), 64);
+    for (u32 i = 0; i < board_count; i++) {
+        for (u32 k = 0; k < 3; k++) decks[i][k] = &SHAPE_INFO[GET_SHAPE(generate_composite_byte(&rng))];
+    }
+
+    // Best of three runs each, alternating, so clock noise hits both sides alike
+    u32 children = 0;
+    f32 sum_fly = 0, sum_kept = 0;
+    f64 fly = 1e30, kept = 1e30;
+    for (u32 run = 0; run < 3; run++) {
+        children = 0;
+        sum_fly = sum_kept = 0;
+
+        start = now_seconds();
+        for (u32 i = 0; i < board_count; i++) sum_fly += expand_on_the_fly(&table, boards[i], decks[i], &children);
+        f64 elapsed = now_seconds() - start;
+        fly = elapsed < fly ? elapsed : fly;
+
+        start = now_seconds();
+        for (u32 i = 0; i < board_count; i++) sum_kept += expand_transposed(&table, board8t_from_grid(boards[i]), decks[i], &children);
+        elapsed = now_seconds() - start;
+        kept = elapsed < kept ? elapsed : kept;
+    }
+    children /= 2;
+
+    printf("eval_bench: %u children, transposed on the fly %.2f ns/child, kept transposed %.2f ns/child (%.2fx, "
+           "%s wins on this host, " BENCH_ISA " build)%s\n",
+           children, fly * 1e9 / children, kept * 1e9 / children, fly / kept, kept < fly ? "kept" : "on the fly",
+           sum_fly == sum_kept ? "" : " SCORES DIFFER");
+
+    GameTotals by_features = play_games(&EVAL_DEFAULT_WEIGHTS, NULL, games, max_moves, seed);
+    GameTotals by_lines = play_games(NULL, &table, games, max_moves, seed);
+    printf("eval_bench: %u greedy games, features mean score %.1f (%.1f moves), line tables mean score %.1f (%.1f moves)\n",
+           games, (f64)by_features.score / games, (f64)by_features.moves / games, (f64)by_lines.score / games,
+           (f64)by_lines.moves / games);
+
+    Arena_Release(&arena);
+    return 0;
+}
@@ -0,0 +1,154 @@
+// BG64 MCTS
+// Runs the Monte Carlo tree search player (bg64_mcts), which only looks at the current
+// deck and treats every later piece as unknown.
+//   default   searches one position and prints the chosen placement
+//   --bench   times the rollout kernel alone on one core, both rollout policies
+//   --play N  plays up to N pieces with MCTS choosing every move, then gives the greedy
+//             player the same game for comparison
+//
+// usage: mcts [--seed S] [--grid HEX] [--after M] [--rollouts R] [--seconds T] [--threads N]
+//             [--policy random|lines] [--decks D] [--nodes N] [--bench] [--play N]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+#include "bg64_mcts.h"
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static int bench(Mcts *mcts, const GameState *state)
+{
+    static const char *names[] = { "random", "lines" };
+    for (u32 p = 0; p < 2; p++) {
+        mcts->rollout = (MctsRollout)p;
+
+        u64 rollouts = 200000, lines;
+        f64 start = now_seconds();
+        u64 moves = Mcts_RolloutBench(mcts, state, rollouts, &lines);
+        f64 elapsed = now_seconds() - start;
+
+        printf("mcts: %-6s rollouts %.2f M moves/s, %.1f moves and %.2f lines per rollout (%.3fs)\n", names[p],
+               moves / elapsed / 1e6, (f64)moves / rollouts, (f64)lines / rollouts, elapsed);
+    }
+    return 0;
+}
+
+static int play(Mcts *mcts, u64 seed, u32 pieces, u32 threads, u64 rollouts, f64 seconds)
+{
+    GameState searched, greedy;
+    GameState_Reset(&searched, seed);
+    GameState_Reset(&greedy, seed);
+
+    u32 searched_pieces = 0, greedy_pieces = 0;
+    u64 total_rollouts = 0, total_moves = 0;
+    f64 total_seconds = 0;
+
+    MctsResult result;
+    while (searched_pieces < pieces && Mcts_Search(mcts, &searched, threads, rollouts, seconds, &result)) {
+        ApplyMove(&searched, result.slot, result.gx, result.gy, NULL);
+        searched_pieces++;
+        total_rollouts += result.rollouts;
+        total_moves += result.rollout_moves;
+        total_seconds += result.seconds;
+    }
+
+    // Greedy gets as many pieces, unless it gets stuck first
+    EvalMove move;
+    while (greedy_pieces < searched_pieces && Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &greedy, &move)) {
+        ApplyMove(&greedy, move.slot, move.gx, move.gy, NULL);
+        greedy_pieces++;
+    }
+
+    printf("mcts: mcts %u pieces, score %llu (%.1f M rollouts, %.2f M moves/s, %.2fs); greedy %u pieces, score %llu\n",
+           searched_pieces, (unsigned long long)searched.session.current_score, total_rollouts / 1e6,
+           total_moves / (total_seconds > 0 ? total_seconds : 1e-9) / 1e6, total_seconds, greedy_pieces,
+           (unsigned long long)greedy.session.current_score);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    u64 seed = 0xB664;
+    u64 grid = 0;
+    bool grid_set = false;
+    u32 after = 0;
+    u64 rollouts = 0;
+    f64 seconds = 1.0;
+    u32 threads = 0;
+    u32 capacity = 1u << 22;
+    bool run_bench = false;
+    u32 play_pieces = 0;
+
+    MctsRollout policy = MCTS_ROLLOUT_LINES;
+    u32 decks = 4;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = strtoull(argv[++i], NULL, 16);
+            grid_set = true;
+        }
+        else if (strcmp(argv[i], "--after") == 0 && i + 1 < argc) after = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--rollouts") == 0 && i + 1 < argc) rollouts = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) policy = strcmp(argv[++i], "random") == 0 ? MCTS_ROLLOUT_RANDOM : MCTS_ROLLOUT_LINES;
+        else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) decks = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) capacity = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bench") == 0) run_bench = true;
+        else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) play_pieces = (u32)strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [--seed S] [--grid HEX] [--after M] [--rollouts R] [--seconds T] [--threads N]\n"
+                            "          [--policy random|lines] [--decks D] [--nodes N] [--bench] [--play N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (capacity < 1024) capacity = 1024;
+    if (rollouts == 0 && seconds <= 0) rollouts = 100000;
+
+    // Selection walks the node pool all over, huge pages save the TLB misses
+    Arena arena = Arena_Reserve(ARENA_SIZE, ARENA_HUGE_PAGES);
+    Mcts mcts = Mcts_Allocation(&arena, capacity);
+    mcts.rollout = policy;
+    mcts.rollout_decks = decks;
+
+    GameState state;
+    GameState_Reset(&state, seed);
+    if (grid_set) state.grid.game_grid = grid;
+
+    EvalMove move;
+    for (u32 m = 0; m < after && Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &state, &move); m++) {
+        ApplyMove(&state, move.slot, move.gx, move.gy, NULL);
+    }
+
+    int status = 0;
+    if (run_bench) {
+        status = bench(&mcts, &state);
+    } else if (play_pieces) {
+        status = play(&mcts, seed, play_pieces, threads, rollouts, seconds);
+    } else {
+        MctsResult result;
+        if (!Mcts_Search(&mcts, &state, threads, rollouts, seconds, &result)) {
+            printf("mcts: no deck piece fits\n");
+            status = 1;
+        } else {
+            printf("mcts: slot %u at %d,%d (%u lines), %u visits, value %.3f\n", result.slot, result.gx, result.gy,
+                   result.lines, result.visits, result.value);
+            printf("  %llu rollouts, %llu rollout moves, %u nodes, %.3fs (%.2f M rollout moves/s)\n",
+                   (unsigned long long)result.rollouts, (unsigned long long)result.rollout_moves, result.nodes,
+                   result.seconds, result.rollout_moves / (result.seconds > 0 ? result.seconds : 1e-9) / 1e6);
+        }
+    }
+
+    Arena_Release(&arena);
+    return status;
+}
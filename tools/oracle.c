@@ -0,0 +1,1128 @@
+// BG64 DIFFERENTIAL ORACLE
+// Runs seeded random boards and moves through the optimized engine and through the cell
+// by cell reference engine (bg64_reference) and demands identical results:
+//  - ApplyMove (TryPlace, BakeColorsIntoGrid, ClearLinesAndColors): the return value, the
+//    MoveResult and all 256 bytes of the GameState after every step
+//  - Batch_Step: grid, colors, score, deck and active slots of every lane after every step
+//    Games start in every piece mode, so refills are checked against the game's own stream.
+//  - the 10x10 and 16x16 boards (bg64_board), both the AVX2 and the scalar board16 path:
+//    try_place, full_lines and clear_lines against cells in a plain array, one random
+//    board and placement per case
+//  - MoveGen_Successors and MoveGen_Count (bg64_movegen): every child, its masks, lines and
+//    points, and the anchor sets, against trying every slot and cell on the reference
+//  - the 8 symmetries (bg64_symmetry): GameState_ApplySymmetry and colors_symmetry against
+//    the coordinate maps, undo by symmetry_inverse, composition staying in the group and
+//    grid_canonical agreeing across the orbit
+//  - the evaluation features (bg64_eval) through every Eval_ScoreBatch path and Eval_Features
+//    against counting cells, and the weighted scores against the counted features
+// A failing case is minimized before it is printed: trailing moves are cut, earlier moves
+// dropped one at a time, then board cells, colors, score and active slots are stripped
+// while the divergence still reproduces.
+//
+// --mutate swaps in a deliberately broken ApplyMove to exercise the minimizer.
+// Exit status is 0 only when every case agrees.
+//
+// usage: oracle [--cases N] [--moves M] [--seed S] [--mutate]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "bg64.h"
+#include "bg64_batch.h"
+#include "bg64_board.h"
+#include "bg64_eval.h"
+#include "bg64_movegen.h"
+#include "bg64_pieces.h"
+#include "bg64_reference.h"
+#include "bg64_symmetry.h"
+
+#define ORACLE_MAX_MOVES 256
+#define ORACLE_BLOCK 1024 // cases stepped together through Batch_Step
+
+typedef struct
+{
+    GameState start;
+    BatchMove moves[ORACLE_MAX_MOVES];
+    u32 count;
+} OracleCase;
+
+typedef bool (*ApplyFn)(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result);
+
+// Returns the first step where the implementation under test disagrees with the reference
+// (-1: none) and describes the difference in why
+typedef i32 (*DivergeFn)(const OracleCase *c, char *why, usize why_size);
+
+static ApplyFn engine_apply = ApplyMove;
+static BatchGames single_lane;
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+// Scores one point too many on multi line clears
+static bool mutated_apply(GameState *state, u8 slot_idx, int gx, int gy, MoveResult *out_result)
+{
+    MoveResult result;
+    if (!ApplyMove(state, slot_idx, gx, gy, &result)) return false;
+    if (result.lines >= 2) {
+        state->session.current_score++;
+        result.score_delta++;
+    }
+    if (out_result) *out_result = result;
+    return true;
+}
+
+
+// Case generation
+
+// Every piece mode, custom ones from a few weight sets so a batch holds few distributions
+static void random_state(u64 *rng, GameState *state)
+{
+    u64 seed = xorshift(rng) | 1;
+    u64 pieces = xorshift(rng);
+    u8 weights[16];
+    u64 weight_rng = 0x9E3779B97F4A7C15ull * (1 + (pieces >> 8) % 4);
+    for (u32 k = 0; k < 16; k++) weights[k] = (u8)xorshift(&weight_rng);
+    GameState_ResetPieces(state, seed, (u8)(pieces % PIECE_MODE_COUNT), weights);
+    state->utility.current_screen = SCREEN_GAMEPLAY;
+    state->session.current_score = xorshift(rng) % 100000;
+
+    // Mix sparse, dense and almost full lines so clears of every size come up
+    u64 grid;
+    switch (xorshift(rng) & 3) {
+        case 0:  grid = xorshift(rng) & xorshift(rng) & xorshift(rng); break;
+        case 1:  grid = xorshift(rng) & xorshift(rng); break;
+        case 2:  grid = xorshift(rng); break;
+        default: {
+            grid = xorshift(rng) & xorshift(rng);
+            u64 r = xorshift(rng);
+            for (u32 k = 0; k < 8; k++) {
+                if ((r >> k) & 1) grid |= ROW_MASKS[k];
+                if ((r >> (8 + k)) & 1) grid |= COL_MASKS[k];
+            }
+            grid &= ~(1ULL << (xorshift(rng) & 63));
+            grid &= ~(1ULL << (xorshift(rng) & 63));
+        } break;
+    }
+    state->grid.game_grid = grid;
+
+    // Colors under the occupied cells, now and then garbage under empty ones too
+    bool junk = (xorshift(rng) & 7) == 0;
+    for (u32 cell = 0; cell < 64; cell++) {
+        u8 color = 0;
+        if (junk || ((grid >> (63 - cell)) & 1)) color = (u8)(xorshift(rng) % 8);
+        u8 shift = (cell & 1) ? 0 : 4;
+        state->grid.grid_color[cell >> 1] = (u8)((state->grid.grid_color[cell >> 1] & ~(0x0F << shift)) | (color << shift));
+    }
+
+    // Now and then a hand made deck, shape 0 (void) and color 0 included
+    if ((xorshift(rng) & 3) == 0) {
+        for (u8 k = 0; k < 3; k++) {
+            u64 r = xorshift(rng);
+            state->session.deck_shape_color_bits[k] = MAKE_COMPOSITE((u8)(r % (SHAPE_OPTIONS + 1)), (u8)((r >> 32) % 8));
+        }
+    }
+    u64 active = xorshift(rng);
+    for (u8 k = 0; k < 3; k++) state->session.is_active[k] = ((active >> k) & 3) == 0;
+}
+
+// Mostly a uniformly chosen legal move, otherwise anything at all
+static BatchMove random_move(u64 *rng, const GameState *state)
+{
+    u64 r = xorshift(rng);
+    if ((r & 3) != 0) {
+        BatchMove legal[3 * 64];
+        u32 count = 0;
+        for (u8 slot = 0; slot < 3; slot++) {
+            if (state->session.is_active[slot]) continue;
+
+            const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(state->session.deck_shape_color_bits[slot])];
+            for (u64 a = shape->anchors; a; a &= a - 1) {
+                u32 bit = 63 - (u32)__builtin_ctzll(a);
+                if (state->grid.game_grid & (shape->mask >> bit)) continue;
+                legal[count++] = (BatchMove){ slot, (i8)(bit % 8), (i8)(bit / 8), 0 };
+            }
+        }
+        if (count) return legal[xorshift(rng) % count];
+    }
+
+    return (BatchMove){ (u8)((r >> 8) % 4), (i8)((r >> 16) % 14) - 3, (i8)((r >> 24) % 14) - 3, 0 };
+}
+
+
+// Comparisons
+
+static bool describe_state_difference(const GameState *got, const GameState *want, char *why, usize why_size)
+{
+    if (memcmp(got, want, sizeof(GameState)) == 0) return false;
+
+    if (got->grid.game_grid != want->grid.game_grid) {
+        snprintf(why, why_size, "game_grid %016llx, reference %016llx", (unsigned long long)got->grid.game_grid,
+                 (unsigned long long)want->grid.game_grid);
+    } else if (memcmp(got->grid.grid_color, want->grid.grid_color, 32) != 0) {
+        u32 i = 0;
+        while (got->grid.grid_color[i] == want->grid.grid_color[i]) i++;
+        snprintf(why, why_size, "grid_color byte %u (cells %u, %u) %02x, reference %02x", i, 2 * i, 2 * i + 1,
+                 got->grid.grid_color[i], want->grid.grid_color[i]);
+    } else if (got->session.current_score != want->session.current_score) {
+        snprintf(why, why_size, "score %llu, reference %llu", (unsigned long long)got->session.current_score,
+                 (unsigned long long)want->session.current_score);
+    } else if (memcmp(got->session.deck_shape_color_bits, want->session.deck_shape_color_bits, 3) != 0 ||
+               memcmp(got->session.is_active, want->session.is_active, 3) != 0) {
+        snprintf(why, why_size, "deck %02x %02x %02x active %u%u%u, reference deck %02x %02x %02x active %u%u%u",
+                 got->session.deck_shape_color_bits[0], got->session.deck_shape_color_bits[1],
+                 got->session.deck_shape_color_bits[2], got->session.is_active[0], got->session.is_active[1],
+                 got->session.is_active[2], want->session.deck_shape_color_bits[0],
+                 want->session.deck_shape_color_bits[1], want->session.deck_shape_color_bits[2],
+                 want->session.is_active[0], want->session.is_active[1], want->session.is_active[2]);
+    } else {
+        const u8 *a = (const u8 *)got;
+        const u8 *b = (const u8 *)want;
+        u32 i = 0;
+        while (a[i] == b[i]) i++;
+        snprintf(why, why_size, "GameState byte %u %02x, reference %02x", i, a[i], b[i]);
+    }
+    return true;
+}
+
+static bool describe_move_difference(bool got_ok, const MoveResult *got, bool want_ok, const MoveResult *want,
+                                     char *why, usize why_size)
+{
+    if (got_ok != want_ok) {
+        snprintf(why, why_size, "move %s, reference %s", got_ok ? "accepted" : "rejected", want_ok ? "accepted" : "rejected");
+        return true;
+    }
+    if (!got_ok) return false;
+
+    if (got->placed_mask != want->placed_mask || got->clear_mask != want->clear_mask ||
+        got->score_delta != want->score_delta || got->lines != want->lines || got->slot != want->slot ||
+        got->deck_refilled != want->deck_refilled) {
+        snprintf(why, why_size, "MoveResult placed %016llx clear %016llx +%u lines %u refill %u, reference placed %016llx "
+                 "clear %016llx +%u lines %u refill %u", (unsigned long long)got->placed_mask,
+                 (unsigned long long)got->clear_mask, got->score_delta, got->lines, got->deck_refilled,
+                 (unsigned long long)want->placed_mask, (unsigned long long)want->clear_mask, want->score_delta,
+                 want->lines, want->deck_refilled);
+        return true;
+    }
+    return false;
+}
+
+// One engine step against one reference step, states advance in place
+static bool engine_step(GameState *engine, GameState *reference, BatchMove move, char *why, usize why_size)
+{
+    MoveResult got, want;
+    bool got_ok = engine_apply(engine, move.slot, move.gx, move.gy, &got);
+    bool want_ok = Reference_ApplyMove(reference, move.slot, move.gx, move.gy, &want);
+
+    return describe_move_difference(got_ok, &got, want_ok, &want, why, why_size) ||
+           describe_state_difference(engine, reference, why, why_size);
+}
+
+// The game fields a batch lane carries, against a reference GameState
+static bool batch_lane_differs(const BatchGames *games, u32 lane, u8 lines, bool want_ok, const MoveResult *want,
+                               const GameState *reference, char *why, usize why_size)
+{
+    u8 want_lines = want_ok ? want->lines : BATCH_MOVE_ILLEGAL;
+    u8 active = 0;
+    for (u8 k = 0; k < 3; k++) active |= (u8)(reference->session.is_active[k] << k);
+
+    if (lines != want_lines) {
+        snprintf(why, why_size, "batch lines %u, reference %u", lines, want_lines);
+    } else if (games->grids[lane] != reference->grid.game_grid) {
+        snprintf(why, why_size, "batch grid %016llx, reference %016llx", (unsigned long long)games->grids[lane],
+                 (unsigned long long)reference->grid.game_grid);
+    } else if (memcmp(games->colors[lane], reference->grid.grid_color, 32) != 0) {
+        snprintf(why, why_size, "batch colors differ");
+    } else if (games->scores[lane] != reference->session.current_score) {
+        snprintf(why, why_size, "batch score %llu, reference %llu", (unsigned long long)games->scores[lane],
+                 (unsigned long long)reference->session.current_score);
+    } else if (memcmp(games->decks[lane], reference->session.deck_shape_color_bits, 3) != 0 || games->active[lane] != active) {
+        snprintf(why, why_size, "batch deck %02x %02x %02x active %x, reference deck %02x %02x %02x active %x",
+                 games->decks[lane][0], games->decks[lane][1], games->decks[lane][2], games->active[lane],
+                 reference->session.deck_shape_color_bits[0], reference->session.deck_shape_color_bits[1],
+                 reference->session.deck_shape_color_bits[2], active);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+
+// Single case predicates for the minimizer
+
+static i32 engine_diverges(const OracleCase *c, char *why, usize why_size)
+{
+    GameState engine = c->start;
+    GameState reference = c->start;
+
+    for (u32 i = 0; i < c->count; i++) {
+        if (engine_step(&engine, &reference, c->moves[i], why, why_size)) return (i32)i;
+    }
+    return -1;
+}
+
+static i32 batch_diverges(const OracleCase *c, char *why, usize why_size)
+{
+    GameState reference = c->start;
+    Batch_Load(&single_lane, 0, &c->start);
+
+    BatchMove moves[8] = { 0 };
+    for (u32 k = 1; k < 8; k++) moves[k].slot = 0xFF;
+
+    for (u32 i = 0; i < c->count; i++) {
+        u8 lines[8];
+        moves[0] = c->moves[i];
+        Batch_Step(&single_lane, moves, lines);
+
+        MoveResult want;
+        bool want_ok = Reference_ApplyMove(&reference, c->moves[i].slot, c->moves[i].gx, c->moves[i].gy, &want);
+        if (batch_lane_differs(&single_lane, 0, lines[0], want_ok, &want, &reference, why, why_size)) return (i32)i;
+    }
+    return -1;
+}
+
+
+// Minimization
+
+static bool still_fails(DivergeFn diverges, OracleCase *c)
+{
+    char why[256];
+    i32 step = diverges(c, why, sizeof(why));
+    if (step < 0) return false;
+    c->count = (u32)step + 1;
+    return true;
+}
+
+static void set_color(GameState *state, u32 cell, u8 color)
+{
+    u8 shift = (cell & 1) ? 0 : 4;
+    state->grid.grid_color[cell >> 1] = (u8)((state->grid.grid_color[cell >> 1] & ~(0x0F << shift)) | (color << shift));
+}
+
+static void minimize(DivergeFn diverges, OracleCase *c)
+{
+    still_fails(diverges, c);
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        // Drop earlier moves one at a time
+        for (i32 i = (i32)c->count - 2; i >= 0; i--) {
+            OracleCase trial = *c;
+            memmove(&trial.moves[i], &trial.moves[i + 1], (trial.count - (u32)i - 1) * sizeof(BatchMove));
+            trial.count--;
+            if (still_fails(diverges, &trial)) {
+                *c = trial;
+                progress = true;
+            }
+        }
+
+        // Strip board cells with their colors, failing that just the colors
+        for (u32 cell = 0; cell < 64; cell++) {
+            u64 bit = 1ULL << (63 - cell);
+            if (c->start.grid.game_grid & bit) {
+                OracleCase trial = *c;
+                trial.start.grid.game_grid &= ~bit;
+                set_color(&trial.start, cell, 0);
+                if (still_fails(diverges, &trial)) {
+                    *c = trial;
+                    progress = true;
+                    continue;
+                }
+            }
+
+            OracleCase trial = *c;
+            u8 before = trial.start.grid.grid_color[cell >> 1];
+            set_color(&trial.start, cell, 0);
+            if (trial.start.grid.grid_color[cell >> 1] != before && still_fails(diverges, &trial)) {
+                *c = trial;
+                progress = true;
+            }
+        }
+
+        if (c->start.session.current_score) {
+            OracleCase trial = *c;
+            trial.start.session.current_score = 0;
+            if (still_fails(diverges, &trial)) {
+                *c = trial;
+                progress = true;
+            }
+        }
+
+        for (u8 k = 0; k < 3; k++) {
+            if (!c->start.session.is_active[k]) continue;
+            OracleCase trial = *c;
+            trial.start.session.is_active[k] = false;
+            if (still_fails(diverges, &trial)) {
+                *c = trial;
+                progress = true;
+            }
+        }
+    }
+}
+
+static void print_case(const char *name, DivergeFn diverges, const OracleCase *c)
+{
+    char why[256];
+    i32 step = diverges(c, why, sizeof(why));
+    const GameState *s = &c->start;
+
+    printf("oracle: %s diverges from the reference at step %d: %s\n", name, step, why);
+    printf("  start: score %llu, rng_seed %016llx, deck %02x %02x %02x, active %u%u%u\n",
+           (unsigned long long)s->session.current_score, (unsigned long long)s->utility.rng_seed,
+           s->session.deck_shape_color_bits[0], s->session.deck_shape_color_bits[1], s->session.deck_shape_color_bits[2],
+           s->session.is_active[0], s->session.is_active[1], s->session.is_active[2]);
+    printf("  game_grid %016llx, grid_color ", (unsigned long long)s->grid.game_grid);
+    for (u32 i = 0; i < 32; i++) printf("%02x", s->grid.grid_color[i]);
+    printf("\n");
+    for (u32 y = 0; y < 8; y++) {
+        printf("   ");
+        for (u32 x = 0; x < 8; x++) {
+            u32 cell = y * 8 + x;
+            u8 color = (cell & 1) ? (s->grid.grid_color[cell >> 1] & 0x0F) : (s->grid.grid_color[cell >> 1] >> 4);
+            if ((s->grid.game_grid >> (63 - cell)) & 1) printf(" %u", color);
+            else printf(" %c", color ? '?' : '.');
+        }
+        printf("\n");
+    }
+    printf("  moves (slot gx gy):");
+    for (u32 i = 0; i < c->count; i++) printf(" (%u %d %d)", c->moves[i].slot, c->moves[i].gx, c->moves[i].gy);
+    printf("\n");
+}
+
+
+// Other board sizes: Board10 and both Board16 paths against cells in a plain array
+
+typedef struct
+{
+    u32 dim;
+    bool filled[16][16];
+    u8 color[16][16];
+} CellBoard;
+
+static void random_cells(u64 *rng, u32 dim, CellBoard *b)
+{
+    memset(b, 0, sizeof(*b));
+    b->dim = dim;
+
+    // Same mix as random_state: sparse, dense, half full, and boards with full lines
+    u32 kind = (u32)(xorshift(rng) & 3);
+    bool junk = (xorshift(rng) & 7) == 0;
+    for (u32 y = 0; y < dim; y++) {
+        for (u32 x = 0; x < dim; x++) {
+            u64 r = xorshift(rng);
+            b->filled[y][x] = kind == 0 ? (r & 7) == 0 : kind == 2 ? (r & 1) : (r & 3) == 0;
+            if (b->filled[y][x] || junk) b->color[y][x] = (u8)((r >> 8) % 8);
+        }
+    }
+    if (kind == 3) {
+        u64 r = xorshift(rng);
+        for (u32 k = 0; k < dim; k++) {
+            for (u32 i = 0; i < dim; i++) {
+                if (((r >> (2 * k)) & 3) == 0) b->filled[k][i] = true;
+                if (((r >> (32 + 2 * k)) & 3) == 0) b->filled[i][k] = true;
+            }
+        }
+        for (u32 n = 0; n < 2; n++) {
+            u64 c = xorshift(rng);
+            b->filled[c % dim][(c >> 8) % dim] = false;
+        }
+    }
+}
+
+static bool ref_try_place(const CellBoard *b, const ShapeInfo *shape, int gx, int gy, CellBoard *out_mask)
+{
+    if (shape->cells == 0) return false;
+
+    CellBoard mask = { .dim = b->dim };
+    for (int sy = 0; sy < 8; sy++) {
+        for (int sx = 0; sx < 8; sx++) {
+            if (!((shape->mask >> (63 - (sy * 8 + sx))) & 1)) continue;
+
+            int x = gx + sx;
+            int y = gy + sy;
+            if (x < 0 || x >= (int)b->dim || y < 0 || y >= (int)b->dim) return false;
+            if (b->filled[y][x]) return false;
+            mask.filled[y][x] = true;
+        }
+    }
+    *out_mask = mask;
+    return true;
+}
+
+// Rows and columns judged before anything is removed, cleared cells lose their color
+static u32 ref_clear_lines(CellBoard *b, CellBoard *out_clear)
+{
+    u32 dim = b->dim;
+    u32 lines = 0;
+    CellBoard clear = { .dim = dim };
+    for (u32 k = 0; k < dim; k++) {
+        bool row = true, col = true;
+        for (u32 i = 0; i < dim; i++) {
+            row = row && b->filled[k][i];
+            col = col && b->filled[i][k];
+        }
+        lines += row + col;
+        for (u32 i = 0; i < dim; i++) {
+            if (row) clear.filled[k][i] = true;
+            if (col) clear.filled[i][k] = true;
+        }
+    }
+    for (u32 y = 0; y < dim; y++) {
+        for (u32 x = 0; x < dim; x++) {
+            if (!clear.filled[y][x]) continue;
+            b->filled[y][x] = false;
+            b->color[y][x] = 0;
+        }
+    }
+    *out_clear = clear;
+    return lines;
+}
+
+static Board10 to_board10(const CellBoard *b)
+{
+    Board10 out = 0;
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            if (b->filled[y][x]) out |= board10_bit(x, y);
+        }
+    }
+    return out;
+}
+
+static Board16 to_board16(const CellBoard *b)
+{
+    Board16 out = { 0 };
+    for (u32 y = 0; y < 16; y++) {
+        for (u32 x = 0; x < 16; x++) {
+            if (b->filled[y][x]) out.row[y] |= (u16)(0x8000 >> x);
+        }
+    }
+    return out;
+}
+
+static void to_colors(const CellBoard *b, u8 *colors)
+{
+    for (u32 y = 0; y < b->dim; y++) {
+        for (u32 x = 0; x < b->dim; x++) color_nibble_set(colors, y * b->dim + x, b->color[y][x]);
+    }
+}
+
+static void print_cells(const char *name, const CellBoard *b, const ShapeInfo *shape, int gx, int gy, const char *why)
+{
+    printf("oracle: %s diverges on a %ux%u board: %s\n", name, b->dim, b->dim, why);
+    printf("  %s at %d,%d on\n", shape->name, gx, gy);
+    for (u32 y = 0; y < b->dim; y++) {
+        printf("    ");
+        for (u32 x = 0; x < b->dim; x++) printf("%c", b->filled[y][x] ? '#' : '.');
+        printf("\n");
+    }
+}
+
+typedef bool (*Board16PlaceFn)(const Board16 *board, const ShapeInfo *shape, int gx, int gy, Board16 *out_mask);
+typedef u32 (*Board16LinesFn)(const Board16 *board, Board16 *out_clear_mask);
+typedef u32 (*Board16ClearFn)(Board16 *board, u8 *colors, Board16 *out_clear_mask);
+
+typedef struct
+{
+    const char *name;
+    Board16PlaceFn try_place;
+    Board16LinesFn full_lines;
+    Board16ClearFn clear_lines;
+} Board16Path;
+
+#if defined(__AVX2__)
+#define BOARD16_PATHS_CHECKED "AVX2 and scalar board16"
+#else
+#define BOARD16_PATHS_CHECKED "scalar board16"
+#endif
+
+static const Board16Path BOARD16_PATHS[] = {
+    { "board16", board16_try_place, board16_full_lines, board16_clear_lines },
+    { "board16 scalar", board16_try_place_scalar, board16_full_lines_scalar, board16_clear_lines_scalar },
+};
+
+// One placement, then the line clear it leads to (or a clear of the untouched board when
+// it does not fit), through the kernels of the board's size and the reference
+static bool board_case_differs(const CellBoard *board, const ShapeInfo *shape, int gx, int gy, const char **out_name,
+                               char *why, usize why_size)
+{
+    u32 dim = board->dim;
+    CellBoard want = *board, want_mask, want_clear;
+    bool want_ok = ref_try_place(board, shape, gx, gy, &want_mask);
+    if (want_ok) {
+        for (u32 y = 0; y < dim; y++) {
+            for (u32 x = 0; x < dim; x++) want.filled[y][x] |= want_mask.filled[y][x];
+        }
+    }
+    CellBoard placed = want;
+    u32 want_lines = ref_clear_lines(&want, &want_clear);
+
+    u8 colors[128], want_colors[128];
+    memset(colors, 0, sizeof(colors));
+    memset(want_colors, 0, sizeof(want_colors));
+    to_colors(&placed, colors);
+    to_colors(&want, want_colors);
+
+    if (dim == 10) {
+        *out_name = "board10";
+        Board10 grid = to_board10(board), mask = 0;
+        bool ok = board10_try_place(grid, shape, gx, gy, &mask);
+        if (ok != want_ok || (ok && mask != to_board10(&want_mask))) {
+            snprintf(why, why_size, "try_place %s", ok != want_ok ? (ok ? "fits" : "does not fit") : "mask");
+            return true;
+        }
+        grid |= mask;
+
+        u32 lines;
+        Board10 full = board10_full_lines(grid, &lines);
+        if (lines != want_lines || full != to_board10(&want_clear)) {
+            snprintf(why, why_size, "full_lines %u lines, want %u", lines, want_lines);
+            return true;
+        }
+
+        Board10 clear;
+        lines = board10_clear_lines(&grid, colors, &clear);
+        if (lines != want_lines || clear != full || grid != to_board10(&want) || memcmp(colors, want_colors, 50) != 0) {
+            snprintf(why, why_size, "clear_lines %u lines, want %u", lines, want_lines);
+            return true;
+        }
+        return false;
+    }
+
+    for (u32 p = 0; p < sizeof(BOARD16_PATHS) / sizeof(BOARD16_PATHS[0]); p++) {
+        const Board16Path *path = &BOARD16_PATHS[p];
+        *out_name = path->name;
+
+        Board16 grid = to_board16(board), mask;
+        Board16 want_grid = to_board16(&want), want_full = to_board16(&want_clear), want_placed = to_board16(&want_mask);
+        bool ok = path->try_place(&grid, shape, gx, gy, &mask);
+        if (ok != want_ok || (ok && memcmp(&mask, &want_placed, sizeof(Board16)) != 0)) {
+            snprintf(why, why_size, "try_place %s", ok != want_ok ? (ok ? "fits" : "does not fit") : "mask");
+            return true;
+        }
+        if (ok) board16_place(&grid, &mask);
+
+        Board16 full;
+        u32 lines = path->full_lines(&grid, &full);
+        if (lines != want_lines || memcmp(&full, &want_full, sizeof(Board16)) != 0) {
+            snprintf(why, why_size, "full_lines %u lines, want %u", lines, want_lines);
+            return true;
+        }
+
+        u8 path_colors[128];
+        memcpy(path_colors, colors, sizeof(colors));
+        Board16 clear;
+        lines = path->clear_lines(&grid, path_colors, &clear);
+        if (lines != want_lines || memcmp(&clear, &want_full, sizeof(Board16)) != 0 ||
+            memcmp(&grid, &want_grid, sizeof(Board16)) != 0 || memcmp(path_colors, want_colors, 128) != 0) {
+            snprintf(why, why_size, "clear_lines %u lines, want %u", lines, want_lines);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool boards_agree(u64 cases, u64 *rng)
+{
+    for (u64 i = 0; i < cases; i++) {
+        for (u32 dim = 10; dim <= 16; dim += 6) {
+            CellBoard board;
+            random_cells(rng, dim, &board);
+            u64 r = xorshift(rng);
+            const ShapeInfo *shape = &SHAPE_INFO[r % (SHAPE_OPTIONS + 1)];
+            int gx = (int)((r >> 8) % (dim + 4)) - 2;
+            int gy = (int)((r >> 16) % (dim + 4)) - 2;
+
+            char why[256];
+            const char *name;
+            if (board_case_differs(&board, shape, gx, gy, &name, why, sizeof(why))) {
+                print_cells(name, &board, shape, gx, gy, why);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Move generation: MoveGen_Successors and MoveGen_Count against every (slot, anchor) move
+// tried through the reference engine, in the generator's slot then cell order
+
+static bool movegen_case_differs(const GameState *state, char *why, usize why_size)
+{
+    Successor want[MOVEGEN_MAX_SUCCESSORS];
+    u64 want_legal[3] = { 0 };
+    u32 want_count = 0;
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (state->session.is_active[slot]) continue;
+        for (u32 cell = 64; cell-- > 0;) {
+            GameState child = *state;
+            MoveResult result;
+            if (!Reference_ApplyMove(&child, slot, (int)(cell & 7), (int)(cell >> 3), &result)) continue;
+
+            want_legal[slot] |= 1ULL << (63 - cell);
+            want[want_count++] = (Successor){
+                .grid = child.grid.game_grid,
+                .placed_mask = result.placed_mask,
+                .clear_mask = result.clear_mask,
+                .score_delta = result.score_delta,
+                .slot = slot,
+                .cell = (u8)cell,
+                .lines = result.lines};
+        }
+    }
+
+    Successor got[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = MoveGen_Successors(state, got);
+    for (u32 i = 0; i < count && i < want_count; i++) {
+        const Successor *g = &got[i], *w = &want[i];
+        if (g->slot != w->slot || g->cell != w->cell || g->grid != w->grid || g->placed_mask != w->placed_mask ||
+            g->clear_mask != w->clear_mask || g->score_delta != w->score_delta || g->lines != w->lines) {
+            snprintf(why, why_size,
+                     "MoveGen_Successors child %u: slot %u cell %u grid %016llx %u lines %u points, reference slot %u "
+                     "cell %u grid %016llx %u lines %u points", i, g->slot, g->cell, (unsigned long long)g->grid,
+                     g->lines, g->score_delta, w->slot, w->cell, (unsigned long long)w->grid, w->lines, w->score_delta);
+            return true;
+        }
+    }
+    if (count != want_count) {
+        snprintf(why, why_size, "MoveGen_Successors %u children, reference %u", count, want_count);
+        return true;
+    }
+
+    u64 legal[3];
+    u32 legal_count = MoveGen_Count(state, legal);
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (legal[slot] != want_legal[slot]) {
+            snprintf(why, why_size, "MoveGen_Count slot %u anchors %016llx, reference %016llx", slot,
+                     (unsigned long long)legal[slot], (unsigned long long)want_legal[slot]);
+            return true;
+        }
+    }
+    if (legal_count != want_count) {
+        snprintf(why, why_size, "MoveGen_Count %u moves, reference %u", legal_count, want_count);
+        return true;
+    }
+    return false;
+}
+
+static bool movegens_agree(u64 cases, u64 *rng)
+{
+    for (u64 i = 0; i < cases; i++) {
+        GameState state;
+        random_state(rng, &state);
+
+        char why[320];
+        if (movegen_case_differs(&state, why, sizeof(why))) {
+            printf("oracle: move generation case %llu, grid %016llx deck %02x %02x %02x active %u%u%u: %s\n",
+                   (unsigned long long)i, (unsigned long long)state.grid.game_grid,
+                   state.session.deck_shape_color_bits[0], state.session.deck_shape_color_bits[1],
+                   state.session.deck_shape_color_bits[2], state.session.is_active[0], state.session.is_active[1],
+                   state.session.is_active[2], why);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Symmetries: the bitboard transforms against the coordinate maps in bg64_symmetry.h
+
+static const char *SYMMETRY_NAMES[SYM_COUNT] = {
+    "identity", "rot90", "rot180", "rot270", "mirror", "flip", "transpose", "anti_transpose",
+};
+
+static u32 ref_symmetry_cell(u32 cell, Symmetry sym)
+{
+    u32 x = cell & 7, y = cell >> 3;
+    u32 nx = x, ny = y;
+    switch (sym) {
+        case SYM_ROT90:          nx = 7 - y; ny = x;     break;
+        case SYM_ROT180:         nx = 7 - x; ny = 7 - y; break;
+        case SYM_ROT270:         nx = y;     ny = 7 - x; break;
+        case SYM_MIRROR:         nx = 7 - x;             break;
+        case SYM_FLIP:                       ny = 7 - y; break;
+        case SYM_TRANSPOSE:      nx = y;     ny = x;     break;
+        case SYM_ANTI_TRANSPOSE: nx = 7 - y; ny = 7 - x; break;
+        default: break;
+    }
+    return ny * 8 + nx;
+}
+
+// compose[a][b]: the one symmetry equal to a followed by b, from the coordinate maps alone
+static bool ref_symmetry_table(Symmetry compose[SYM_COUNT][SYM_COUNT])
+{
+    for (u32 a = 0; a < SYM_COUNT; a++) {
+        for (u32 b = 0; b < SYM_COUNT; b++) {
+            u32 found = SYM_COUNT;
+            for (u32 c = 0; c < SYM_COUNT && found == SYM_COUNT; c++) {
+                u32 cell = 0;
+                while (cell < 64 && ref_symmetry_cell(ref_symmetry_cell(cell, (Symmetry)a), (Symmetry)b) ==
+                                        ref_symmetry_cell(cell, (Symmetry)c))
+                    cell++;
+                if (cell == 64) found = c;
+            }
+            if (found == SYM_COUNT) return false;
+            compose[a][b] = (Symmetry)found;
+        }
+    }
+    return true;
+}
+
+// Every symmetry moves cells and colors where the map says and nothing else, undoes with
+// its inverse and composes inside the group; the canonical image is the same for the
+// whole orbit
+static bool symmetry_case_differs(const GameState *state, Symmetry compose[SYM_COUNT][SYM_COUNT], char *why,
+                                  usize why_size)
+{
+    u64 grid = state->grid.game_grid;
+    char diff[192];
+
+    for (u32 s = 0; s < SYM_COUNT; s++) {
+        GameState moved = *state;
+        GameState_ApplySymmetry(&moved, (Symmetry)s);
+
+        GameState want = *state;
+        want.grid.game_grid = 0;
+        for (u32 cell = 0; cell < 64; cell++) {
+            u32 to = ref_symmetry_cell(cell, (Symmetry)s);
+            if ((grid >> (63 - cell)) & 1) want.grid.game_grid |= 1ULL << (63 - to);
+            u8 color = (cell & 1) ? state->grid.grid_color[cell >> 1] & 0x0F : state->grid.grid_color[cell >> 1] >> 4;
+            set_color(&want, to, color);
+        }
+        if (describe_state_difference(&moved, &want, diff, sizeof(diff))) {
+            snprintf(why, why_size, "GameState_ApplySymmetry %s: %s", SYMMETRY_NAMES[s], diff);
+            return true;
+        }
+
+        GameState back = moved;
+        GameState_ApplySymmetry(&back, symmetry_inverse((Symmetry)s));
+        if (describe_state_difference(&back, state, diff, sizeof(diff))) {
+            snprintf(why, why_size, "%s then its inverse %s: %s", SYMMETRY_NAMES[s],
+                     SYMMETRY_NAMES[symmetry_inverse((Symmetry)s)], diff);
+            return true;
+        }
+
+        for (u32 t = 0; t < SYM_COUNT; t++) {
+            u64 twice = grid_symmetry(moved.grid.game_grid, (Symmetry)t);
+            u64 once = grid_symmetry(grid, compose[s][t]);
+            if (twice != once) {
+                snprintf(why, why_size, "%s then %s gives %016llx, %s gives %016llx", SYMMETRY_NAMES[s],
+                         SYMMETRY_NAMES[t], (unsigned long long)twice, SYMMETRY_NAMES[compose[s][t]],
+                         (unsigned long long)once);
+                return true;
+            }
+        }
+    }
+
+    Symmetry sym;
+    u64 canonical = grid_canonical(grid, &sym);
+    u64 least = grid;
+    for (u32 s = 1; s < SYM_COUNT; s++) {
+        u64 image = grid_symmetry(grid, (Symmetry)s);
+        if (image < least) least = image;
+        u64 again = grid_canonical(image, NULL);
+        if (again != canonical) {
+            snprintf(why, why_size, "grid_canonical of the %s image %016llx, of the board %016llx", SYMMETRY_NAMES[s],
+                     (unsigned long long)again, (unsigned long long)canonical);
+            return true;
+        }
+    }
+    if (canonical != least || grid_symmetry(grid, sym) != canonical) {
+        snprintf(why, why_size, "grid_canonical %016llx by %s, least image %016llx", (unsigned long long)canonical,
+                 SYMMETRY_NAMES[sym], (unsigned long long)least);
+        return true;
+    }
+    return false;
+}
+
+static bool symmetries_agree(u64 cases, u64 *rng)
+{
+    Symmetry compose[SYM_COUNT][SYM_COUNT];
+    if (!ref_symmetry_table(compose)) {
+        printf("oracle: the coordinate maps of bg64_symmetry.h are not closed under composition\n");
+        return false;
+    }
+
+    for (u64 i = 0; i < cases; i++) {
+        GameState state;
+        random_state(rng, &state);
+        // Sparse boards are often symmetric themselves, which ties images in grid_canonical
+        if ((i & 7) == 0) state.grid.game_grid &= xorshift(rng) & xorshift(rng) & xorshift(rng);
+
+        char why[256];
+        if (symmetry_case_differs(&state, compose, why, sizeof(why))) {
+            printf("oracle: symmetry case %llu, grid %016llx: %s\n", (unsigned long long)i,
+                   (unsigned long long)state.grid.game_grid, why);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Evaluation: every feature of every Eval_ScoreBatch path against counting cells
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define EVAL_PATHS_CHECKED "AVX-512, AVX2 and scalar"
+#elif defined(__AVX2__)
+#define EVAL_PATHS_CHECKED "AVX2 and scalar"
+#else
+#define EVAL_PATHS_CHECKED "scalar"
+#endif
+
+#define EVAL_GROUP 8 // one AVX-512 batch, its first half is one AVX2 batch
+
+static bool filled_at(u64 grid, i32 x, i32 y)
+{
+    // Walls count as filled, like the holes feature has it
+    if (x < 0 || x > 7 || y < 0 || y > 7) return true;
+    return (grid >> (63 - (y * 8 + x))) & 1;
+}
+
+static void ref_eval_features(u64 grid, EvalFeatures *out)
+{
+    *out = (EvalFeatures){ 0 };
+    u32 row_filled[8] = { 0 }, col_filled[8] = { 0 };
+    u32 filled_above[9][9] = { 0 }; // filled cells in [0, x) x [0, y), for rectangle sums
+
+    for (i32 y = 0; y < 8; y++) {
+        for (i32 x = 0; x < 8; x++) {
+            bool filled = filled_at(grid, x, y);
+            row_filled[y] += filled;
+            col_filled[x] += filled;
+            filled_above[y + 1][x + 1] = filled + filled_above[y][x + 1] + filled_above[y + 1][x] - filled_above[y][x];
+
+            if (!filled) {
+                out->f[EVAL_EMPTY]++;
+                if (filled_at(grid, x - 1, y) && filled_at(grid, x + 1, y) && filled_at(grid, x, y - 1) &&
+                    filled_at(grid, x, y + 1))
+                    out->f[EVAL_HOLES]++;
+            }
+            if (x < 7 && filled != filled_at(grid, x + 1, y)) out->f[EVAL_PERIMETER]++;
+            if (y < 7 && filled != filled_at(grid, x, y + 1)) out->f[EVAL_PERIMETER]++;
+        }
+    }
+
+    for (u32 k = 0; k < 8; k++) {
+        out->f[EVAL_NEAR_ROWS] += row_filled[k] == 7;
+        out->f[EVAL_NEAR_COLS] += col_filled[k] == 7;
+    }
+
+    u32 best = 0;
+    for (u32 y0 = 0; y0 < 8; y0++)
+        for (u32 y1 = y0 + 1; y1 <= 8; y1++)
+            for (u32 x0 = 0; x0 < 8; x0++)
+                for (u32 x1 = x0 + 1; x1 <= 8; x1++) {
+                    u32 filled = filled_above[y1][x1] - filled_above[y0][x1] - filled_above[y1][x0] + filled_above[y0][x0];
+                    u32 area = (y1 - y0) * (x1 - x0);
+                    if (filled == 0 && area > best) best = area;
+                }
+    out->f[EVAL_MAX_RECT] = (f32)best;
+}
+
+// Scoring with one unit weight reads a single feature back exactly from any path: the
+// full group goes through the widest kernel, its first half through AVX2, one board
+// through Eval_Features
+static bool eval_group_differs(const u64 *grids, const EvalWeights *weights, char *why, usize why_size)
+{
+    EvalFeatures want[EVAL_GROUP];
+    for (u32 i = 0; i < EVAL_GROUP; i++) ref_eval_features(grids[i], &want[i]);
+
+    for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) {
+        EvalWeights unit = { 0 };
+        unit.w[f] = 1.0f;
+
+        f32 wide[EVAL_GROUP], half[EVAL_GROUP / 2];
+        Eval_ScoreBatch(&unit, grids, EVAL_GROUP, wide);
+        Eval_ScoreBatch(&unit, grids, EVAL_GROUP / 2, half);
+        for (u32 i = 0; i < EVAL_GROUP; i++) {
+            EvalFeatures scalar;
+            Eval_Features(grids[i], &scalar);
+            f32 got[3] = { wide[i], i < EVAL_GROUP / 2 ? half[i] : wide[i], scalar.f[f] };
+            const char *path[3] = { "batch of 8", "batch of 4", "Eval_Features" };
+            for (u32 p = 0; p < 3; p++) {
+                if (got[p] != want[i].f[f]) {
+                    snprintf(why, why_size, "grid %016llx %s %s %g, counted %g", (unsigned long long)grids[i],
+                             path[p], EVAL_FEATURE_NAMES[f], got[p], want[i].f[f]);
+                    return true;
+                }
+            }
+        }
+    }
+
+    // And the weighted sum, up to rounding in the order of the adds
+    f32 scores[EVAL_GROUP];
+    Eval_ScoreBatch(weights, grids, EVAL_GROUP, scores);
+    for (u32 i = 0; i < EVAL_GROUP; i++) {
+        f32 sum = 0, size = 0;
+        for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) {
+            sum += weights->w[f] * want[i].f[f];
+            size += fabsf(weights->w[f] * want[i].f[f]);
+        }
+        f32 tolerance = 1e-5f * (1.0f + size);
+        if (fabsf(scores[i] - sum) > tolerance || fabsf(Eval_Score(weights, grids[i]) - sum) > tolerance) {
+            snprintf(why, why_size, "grid %016llx Eval_ScoreBatch %.9g, Eval_Score %.9g, counted %.9g",
+                     (unsigned long long)grids[i], scores[i], Eval_Score(weights, grids[i]), sum);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool evals_agree(u64 cases, u64 *rng)
+{
+    for (u64 base = 0; base < cases; base += EVAL_GROUP) {
+        u64 grids[EVAL_GROUP];
+        for (u32 i = 0; i < EVAL_GROUP; i++) {
+            GameState state;
+            random_state(rng, &state);
+            grids[i] = state.grid.game_grid;
+        }
+        EvalWeights weights = { 0 };
+        for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) weights.w[f] = (f32)((i64)(xorshift(rng) % 2001) - 1000) / 250.0f;
+
+        char why[256];
+        if (eval_group_differs(grids, &weights, why, sizeof(why))) {
+            printf("oracle: evaluation group at case %llu: %s\n", (unsigned long long)base, why);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    u64 cases = 100000;
+    u32 moves = 32;
+    u64 seed = 0xB664;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cases") == 0 && i + 1 < argc) cases = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--moves") == 0 && i + 1 < argc) moves = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--mutate") == 0) engine_apply = mutated_apply;
+        else {
+            fprintf(stderr, "usage: %s [--cases N] [--moves M] [--seed S] [--mutate]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (moves == 0 || moves > ORACLE_MAX_MOVES) moves = ORACLE_MAX_MOVES;
+    if (!seed) seed = 0xB664;
+
+    Arena arena = GameArena_Allocation(ARENA_SIZE);
+    BatchGames games = Batch_Allocation(&arena, ORACLE_BLOCK, true);
+    single_lane = Batch_Allocation(&arena, 1, true);
+
+    OracleCase *block = (OracleCase *)Arena_Push(&arena, ORACLE_BLOCK * sizeof(OracleCase), 64);
+    GameState *engine = (GameState *)Arena_Push(&arena, ORACLE_BLOCK * sizeof(GameState), 64);
+    GameState *reference = (GameState *)Arena_Push(&arena, ORACLE_BLOCK * sizeof(GameState), 64);
+    BatchMove *step_moves = (BatchMove *)Arena_Push(&arena, games.capacity * sizeof(BatchMove), 64);
+    u8 *lines = (u8 *)Arena_Push(&arena, games.capacity, 64);
+    for (u32 i = 0; i < games.capacity; i++) step_moves[i].slot = 0xFF;
+
+    u64 steps = 0, accepted = 0, cleared = 0;
+    u64 rng = seed;
+    f64 start = now_seconds();
+
+    for (u64 base = 0; base < cases; base += ORACLE_BLOCK) {
+        u32 lanes = (cases - base) < ORACLE_BLOCK ? (u32)(cases - base) : ORACLE_BLOCK;
+        games.count = lanes;
+
+        for (u32 i = 0; i < lanes; i++) {
+            random_state(&rng, &block[i].start);
+            block[i].count = 0;
+            engine[i] = reference[i] = block[i].start;
+            Batch_Load(&games, i, &block[i].start);
+        }
+
+        for (u32 m = 0; m < moves; m++) {
+            for (u32 i = 0; i < lanes; i++) {
+                BatchMove move = random_move(&rng, &reference[i]);
+                block[i].moves[block[i].count++] = move;
+                step_moves[i] = move;
+            }
+            Batch_Step(&games, step_moves, lines);
+
+            for (u32 i = 0; i < lanes; i++) {
+                char why[256];
+                BatchMove move = step_moves[i];
+
+                MoveResult got, want;
+                bool got_ok = engine_apply(&engine[i], move.slot, move.gx, move.gy, &got);
+                bool want_ok = Reference_ApplyMove(&reference[i], move.slot, move.gx, move.gy, &want);
+
+                DivergeFn failed = NULL;
+                const char *name = NULL;
+                if (describe_move_difference(got_ok, &got, want_ok, &want, why, sizeof(why)) ||
+                    describe_state_difference(&engine[i], &reference[i], why, sizeof(why))) {
+                    failed = engine_diverges;
+                    name = "ApplyMove";
+                } else if (batch_lane_differs(&games, i, lines[i], want_ok, &want, &reference[i], why, sizeof(why))) {
+                    failed = batch_diverges;
+                    name = "Batch_Step";
+                }
+
+                if (failed) {
+                    printf("oracle: case %llu step %u: %s (minimizing)\n", (unsigned long long)(base + i), m, why);
+                    minimize(failed, &block[i]);
+                    print_case(name, failed, &block[i]);
+                    Arena_Release(&arena);
+                    return 1;
+                }
+
+                accepted += want_ok;
+                cleared += want_ok && want.lines;
+            }
+            steps += lanes;
+        }
+    }
+
+    f64 elapsed = now_seconds() - start;
+    printf("oracle: %llu cases, %llu steps (%llu placements, %llu clearing) agree, %.2fs (%.1f M steps/s)\n",
+           (unsigned long long)cases, (unsigned long long)steps, (unsigned long long)accepted,
+           (unsigned long long)cleared, elapsed, steps / elapsed / 1e6);
+
+    start = now_seconds();
+    if (!boards_agree(cases, &rng)) {
+        Arena_Release(&arena);
+        return 1;
+    }
+    printf("oracle: %llu 10x10 and 16x16 boards (" BOARD16_PATHS_CHECKED ") agree, %.2fs\n", (unsigned long long)cases,
+           now_seconds() - start);
+
+    start = now_seconds();
+    if (!movegens_agree(cases, &rng)) {
+        Arena_Release(&arena);
+        return 1;
+    }
+    printf("oracle: %llu positions through MoveGen_Successors and MoveGen_Count agree, %.2fs\n", (unsigned long long)cases,
+           now_seconds() - start);
+
+    start = now_seconds();
+    if (!symmetries_agree(cases, &rng)) {
+        Arena_Release(&arena);
+        return 1;
+    }
+    printf("oracle: %llu boards under all %u symmetries (cells, colors, inverse, composition, canonical) agree, %.2fs\n",
+           (unsigned long long)cases, (u32)SYM_COUNT, now_seconds() - start);
+
+    start = now_seconds();
+    if (!evals_agree(cases, &rng)) {
+        Arena_Release(&arena);
+        return 1;
+    }
+    printf("oracle: %llu boards through Eval_ScoreBatch (" EVAL_PATHS_CHECKED ") agree with counted features, %.2fs\n",
+           (unsigned long long)cases, now_seconds() - start);
+
+    Arena_Release(&arena);
+    return 0;
+}
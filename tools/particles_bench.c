@@ -0,0 +1,155 @@
+// BG64 PARTICLE BENCHMARK
+// Frame cost of the effects pool at a steady particle count: every frame integrates and
+// compacts the pool, then tops it back up with fresh bursts so the count never drops.
+// The allocator is interposed and every call during the frame loop is counted, the exit
+// status is non zero unless there were none.
+// With --window the quads are also submitted to raylib inside a real frame.
+//
+// usage: particles_bench [--particles N] [--frames F] [--window]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include "bg64.h"
+#include "bg64_particles.h"
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+// The executable's allocator entry points win over libc's for every library, raylib
+// included; they count the call and forward to glibc's own implementation
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+
+static _Atomic u64 heap_calls;
+
+static inline void count_heap_call(void)
+{
+    atomic_fetch_add_explicit(&heap_calls, 1, memory_order_relaxed);
+}
+
+void *malloc(size_t size)
+{
+    count_heap_call();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    count_heap_call();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    count_heap_call();
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t align, size_t size)
+{
+    count_heap_call();
+    return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+    count_heap_call();
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **out_ptr, size_t align, size_t size)
+{
+    count_heap_call();
+    void *ptr = __libc_memalign(align, size);
+    if (!ptr) return ENOMEM;
+    *out_ptr = ptr;
+    return 0;
+}
+
+static void top_up(ParticlePool *pool, u32 target)
+{
+    Color colors[3] = { RED, SKYBLUE, GOLD };
+    u32 k = 0;
+    while (pool->count < target) {
+        Vector2 pos = { 40.0f + (f32)(k * 37 % 320), 40.0f + (f32)(k * 53 % 320) };
+        u32 want = target - pool->count < 16 ? target - pool->count : 16;
+        Particles_Burst(pool, pos, want, 260.0f, 0.6f, colors[k % 3]);
+        k++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    u32 particles = 10000;
+    u32 frames = 2000;
+    bool window = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc) particles = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--window") == 0) window = true;
+        else {
+            fprintf(stderr, "usage: %s [--particles N] [--frames F] [--window]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Arena arena = GameArena_Allocation(ARENA_SIZE);
+    ParticlePool pool = Particles_Allocation(&arena, particles, 0xB664);
+    particles = pool.capacity;
+
+    if (window) {
+        InitWindow(360, 780, "particles_bench");
+        SetTargetFPS(0);
+    }
+
+    const f32 dt = 1.0f / 60.0f;
+    f64 update_time = 0, emit_time = 0, draw_time = 0;
+
+    top_up(&pool, particles);
+    u64 calls_before = atomic_load(&heap_calls);
+
+    for (u32 f = 0; f < frames; f++) {
+        f64 t0 = now_seconds();
+        Particles_Update(&pool, dt);
+        f64 t1 = now_seconds();
+        top_up(&pool, particles);
+        f64 t2 = now_seconds();
+
+        update_time += t1 - t0;
+        emit_time += t2 - t1;
+
+        if (window) {
+            BeginDrawing();
+            ClearBackground(DARKGRAY);
+            f64 t3 = now_seconds();
+            Particles_Draw(&pool);
+            draw_time += now_seconds() - t3;
+            EndDrawing();
+        }
+    }
+
+    u64 calls = atomic_load(&heap_calls) - calls_before;
+
+    printf("particles_bench: %u particles, %u frames\n", particles, frames);
+    printf("  update    %8.2f us/frame  (%.2f ns/particle)\n", update_time * 1e6 / frames, update_time * 1e9 / ((f64)frames * particles));
+    printf("  emit      %8.2f us/frame\n", emit_time * 1e6 / frames);
+    if (window) printf("  draw      %8.2f us/frame  (quad submission)\n", draw_time * 1e6 / frames);
+    printf("  heap      %llu allocator calls during the frame loop\n", (unsigned long long)calls);
+
+    if (window) CloseWindow();
+    Arena_Release(&arena);
+    return calls ? 1 : 0;
+}
@@ -0,0 +1,446 @@
+// BG64 PERFT
+// Counts every distinct placement sequence of exactly N moves from a position, the way
+// chess engines count move paths to validate and time move generation. A move is a deck
+// slot and an anchor cell; full lines clear after each move and the deck refills from the
+// real upcoming pieces (the ring buffer, then the seed's stream) once all three are placed.
+//
+// Kernels, all of which must give the same counts:
+//   board      bitboard recursion on the anchor tables and SWAR line clears, the last ply
+//              is counted in bulk without being played (default)
+//   apply      every move through ApplyMove on a live GameState, taken back with
+//              SnapshotRing_Make / SnapshotRing_Unmake
+//   reference  the same through the cell by cell Reference_ApplyMove
+//   movegen    every node expanded through MoveGen_Board, successor boards and clears
+//              included, the last ply too
+//
+// The root is split into depth 2 prefixes that worker threads pull from a shared counter.
+// --verify runs the built in reference positions and checks the known counts up to depth 4
+// (--depth 5 adds the 1 billion sequence empty board run).
+//
+// usage: perft [--depth N] [--seed S] [--grid HEX] [--threads T] [--kernel K] [--divide]
+//        perft --verify [--depth N] [--threads T] [--kernel K]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bg64.h"
+#include "bg64_board.h"
+#include "bg64_reference.h"
+#include "bg64_movegen.h"
+#include "bg64_history.h"
+#include "bg64_pieces.h"
+
+#define PERFT_MAX_DEPTH 12
+#define PERFT_PIECES (3 + PERFT_MAX_DEPTH) // current deck plus every piece a refill can reach
+
+typedef enum : u8 {
+    KERNEL_BOARD = 0,
+    KERNEL_APPLY,
+    KERNEL_REFERENCE,
+    KERNEL_MOVEGEN,
+    KERNEL_COUNT
+} PerftKernel;
+
+static const char *KERNEL_NAMES[KERNEL_COUNT] = { "board", "apply", "reference", "movegen" };
+
+// Bitboard node: colors and score never change the move count, so they are left out
+typedef struct
+{
+    u64 grid;
+    u8 deck[3];
+    u8 active;  // bit i set: slot i already placed
+    u8 next;    // index in pieces of the next deck
+} PerftNode;
+
+typedef struct
+{
+    PerftNode node;     // position after the prefix
+    GameState state;    // same position for the GameState kernels
+    u8 slot[2];
+    u8 cell[2];
+    u32 plies;          // moves in the prefix, 0 to 2
+    u64 count;
+} PerftJob;
+
+typedef struct
+{
+    const u8 *pieces;
+    PerftJob *jobs;
+    u32 job_count;
+    u32 depth;         // remaining after each job's prefix is depth - plies
+    PerftKernel kernel;
+    atomic_uint next_job;
+} PerftWork;
+
+typedef struct
+{
+    PerftWork *work;
+    SnapshotRing stack;  // make / unmake for the GameState kernels, deeper than any perft
+} PerftWorker;
+
+// Reference positions: the counts were produced by all the kernels and must never change
+typedef struct
+{
+    const char *name;
+    u64 seed;
+    u64 grid;
+    u64 counts[5]; // depth 1..5
+} PerftPosition;
+
+static const PerftPosition PERFT_POSITIONS[] = {
+    { "empty",   0xB664,  0x0000000000000000ULL, { 147, 12584, 459576, 31598430, 1046691828 } },
+    { "midgame", 0x5EED,  0x81C3E70000183C7EULL, { 50, 1222, 10486, 85692, 402496 } },
+    { "clears",  0xC1EA2, 0xFEFEFEFE00FEFEFEULL, { 7, 212, 2606, 99850, 2395582 } },
+    { "checker", 0xD00D,  0xF0F0F0F00F0F0F0FULL, { 32, 368, 502, 8376, 92368 } },
+};
+
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static void position_state(GameState *state, u64 seed, u64 grid)
+{
+    GameState_Reset(state, seed);
+    state->utility.current_screen = SCREEN_GAMEPLAY;
+    state->grid.game_grid = grid;
+}
+
+// Deck, then the queue in consumption order, then the stream the queue refills from
+static void position_pieces(const GameState *state, u8 *pieces)
+{
+    for (u8 k = 0; k < 3; k++) pieces[k] = state->session.deck_shape_color_bits[k];
+
+    u32 n = 3;
+    for (u8 k = 0; k < state->utility.ring_buffer_counter && n < PERFT_PIECES; k++) {
+        pieces[n++] = state->ring_buffer[(state->utility.ring_buffer_read_index + k) & 63];
+    }
+
+    u64 seed = state->utility.rng_seed;
+    Pieces_Fill(Pieces_StateDistribution(state), &seed, &pieces[n], PERFT_PIECES - n);
+}
+
+static PerftNode position_node(const GameState *state)
+{
+    PerftNode node = { .grid = state->grid.game_grid, .next = 3 };
+    for (u8 k = 0; k < 3; k++) {
+        node.deck[k] = state->session.deck_shape_color_bits[k];
+        node.active |= (u8)(state->session.is_active[k] << k);
+    }
+    return node;
+}
+
+
+// Board kernel
+
+static inline PerftNode node_play(const PerftNode *node, const u8 *pieces, u8 slot, u64 mask)
+{
+    PerftNode child = *node;
+
+    u64 grid = node->grid | mask;
+    grid &= ~board8_full_lines(grid, NULL);
+    child.grid = grid;
+    child.active |= (u8)(1u << slot);
+
+    if (child.active == 7) {
+        memcpy(child.deck, &pieces[child.next], 3);
+        child.active = 0;
+        child.next += 3;
+    }
+    return child;
+}
+
+static u64 perft_board(const PerftNode *node, const u8 *pieces, u32 depth)
+{
+    if (depth == 0) return 1;
+
+    u64 nodes = 0;
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (node->active & (1u << slot)) continue;
+
+        const ShapeInfo *shape = &SHAPE_INFO[GET_SHAPE(node->deck[slot])];
+        for (u64 anchors = shape->anchors; anchors; anchors &= anchors - 1) {
+            u64 mask = shape->mask >> (63 - (u32)__builtin_ctzll(anchors));
+            if (node->grid & mask) continue;
+
+            // Bulk count: the last ply only needs to know the move is legal
+            if (depth == 1) {
+                nodes++;
+                continue;
+            }
+
+            PerftNode child = node_play(node, pieces, slot, mask);
+            nodes += perft_board(&child, pieces, depth - 1);
+        }
+    }
+    return nodes;
+}
+
+
+// Movegen kernel: the children come out of one bulk call with their clears applied
+
+static u64 perft_movegen(const PerftNode *node, const u8 *pieces, u32 depth)
+{
+    if (depth == 0) return 1;
+
+    Successor successors[MOVEGEN_MAX_SUCCESSORS];
+    u32 count = MoveGen_Board(node->grid, node->deck, node->active, successors);
+    if (depth == 1) return count;
+
+    u64 nodes = 0;
+    for (u32 i = 0; i < count; i++) {
+        PerftNode child = *node;
+        child.grid = successors[i].grid;
+        child.active |= (u8)(1u << successors[i].slot);
+        if (child.active == 7) {
+            memcpy(child.deck, &pieces[child.next], 3);
+            child.active = 0;
+            child.next += 3;
+        }
+        nodes += perft_movegen(&child, pieces, depth - 1);
+    }
+    return nodes;
+}
+
+
+// GameState kernels, every cell of every slot goes through the real move function. Moves
+// are played on one live state per worker and taken back through its SnapshotRing, the
+// same make / unmake a search over whole GameStates uses.
+
+static u64 perft_state(GameState *state, SnapshotRing *stack, u32 depth, PerftKernel kernel)
+{
+    if (depth == 0) return 1;
+
+    bool (*apply)(GameState *, u8, int, int, MoveResult *) = kernel == KERNEL_APPLY ? ApplyMove : Reference_ApplyMove;
+
+    // A rejected move leaves the state untouched, only played ones are unmade
+    u64 nodes = 0;
+    SnapshotRing_Make(stack, state);
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (state->session.is_active[slot]) continue;
+
+        for (int gy = 0; gy < 8; gy++) {
+            for (int gx = 0; gx < 8; gx++) {
+                if (!apply(state, slot, gx, gy, NULL)) continue;
+
+                nodes += perft_state(state, stack, depth - 1, kernel);
+                SnapshotRing_Unmake(stack, state);
+                SnapshotRing_Make(stack, state);
+            }
+        }
+    }
+    SnapshotRing_Unmake(stack, state);
+    return nodes;
+}
+
+
+// Root split
+
+static void push_job(PerftJob *jobs, u32 *count, const PerftJob *job)
+{
+    jobs[(*count)++] = *job;
+}
+
+// Every prefix of min(2, depth - 1) moves becomes a job, in move order so --divide can
+// regroup them by first move. Prefixes are played with the kernel's own move function.
+static u32 split_root(const GameState *state, const u8 *pieces, u32 depth, PerftKernel kernel, PerftJob *jobs)
+{
+    bool (*apply)(GameState *, u8, int, int, MoveResult *) = kernel == KERNEL_REFERENCE ? Reference_ApplyMove : ApplyMove;
+
+    u32 count = 0;
+    PerftJob root = { .node = position_node(state), .state = *state };
+    u32 plies = depth > 2 ? 2 : depth - 1;
+
+    if (plies == 0) {
+        push_job(jobs, &count, &root);
+        return count;
+    }
+
+    for (u8 s0 = 0; s0 < 3; s0++) {
+        for (u8 c0 = 0; c0 < 64; c0++) {
+            PerftJob first = root;
+            MoveResult result;
+            if (!apply(&first.state, s0, c0 % 8, c0 / 8, &result)) continue;
+            first.node = node_play(&root.node, pieces, s0, result.placed_mask);
+            first.slot[0] = s0;
+            first.cell[0] = c0;
+            first.plies = 1;
+
+            if (plies == 1) {
+                push_job(jobs, &count, &first);
+                continue;
+            }
+
+            for (u8 s1 = 0; s1 < 3; s1++) {
+                for (u8 c1 = 0; c1 < 64; c1++) {
+                    PerftJob second = first;
+                    if (!apply(&second.state, s1, c1 % 8, c1 / 8, &result)) continue;
+                    second.node = node_play(&first.node, pieces, s1, result.placed_mask);
+                    second.slot[1] = s1;
+                    second.cell[1] = c1;
+                    second.plies = 2;
+                    push_job(jobs, &count, &second);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+static void *worker_run(void *arg)
+{
+    PerftWorker *worker = (PerftWorker *)arg;
+    PerftWork *work = worker->work;
+
+    for (;;) {
+        u32 j = atomic_fetch_add_explicit(&work->next_job, 1, memory_order_relaxed);
+        if (j >= work->job_count) break;
+
+        PerftJob *job = &work->jobs[j];
+        u32 remaining = work->depth - job->plies;
+        if (work->kernel == KERNEL_BOARD) job->count = perft_board(&job->node, work->pieces, remaining);
+        else if (work->kernel == KERNEL_MOVEGEN) job->count = perft_movegen(&job->node, work->pieces, remaining);
+        else job->count = perft_state(&job->state, &worker->stack, remaining, work->kernel);
+    }
+    return NULL;
+}
+
+// Returns the move count, jobs stay filled in for --divide
+static u64 perft_run(const GameState *state, u32 depth, u32 threads, PerftKernel kernel, PerftJob *jobs, u32 *out_jobs)
+{
+    u8 pieces[PERFT_PIECES];
+    position_pieces(state, pieces);
+
+    PerftWork work = {
+        .pieces = pieces,
+        .jobs = jobs,
+        .job_count = split_root(state, pieces, depth, kernel, jobs),
+        .depth = depth,
+        .kernel = kernel};
+    atomic_init(&work.next_job, 0);
+
+    if (threads > 256) threads = 256;
+    Arena arena = Arena_Reserve((usize)threads * PERFT_STACK_CAPACITY * sizeof(GameState) + 64, 0);
+    PerftWorker workers[256];
+    pthread_t handles[256];
+    for (u32 t = 0; t < threads; t++) workers[t] = (PerftWorker){ &work, SnapshotRing_Allocation(&arena, PERFT_STACK_CAPACITY, false) };
+    for (u32 t = 0; t < threads; t++) pthread_create(&handles[t], NULL, worker_run, &workers[t]);
+    for (u32 t = 0; t < threads; t++) pthread_join(handles[t], NULL);
+    Arena_Release(&arena);
+
+    u64 total = 0;
+    for (u32 j = 0; j < work.job_count; j++) total += jobs[j].count;
+    if (out_jobs) *out_jobs = work.job_count;
+    return total;
+}
+
+static void print_divide(const PerftJob *jobs, u32 count)
+{
+    // Jobs are sorted by first move, sum each run
+    for (u32 j = 0; j < count;) {
+        u64 sum = 0;
+        u32 k = j;
+        while (k < count && jobs[k].slot[0] == jobs[j].slot[0] && jobs[k].cell[0] == jobs[j].cell[0]) sum += jobs[k++].count;
+        printf("  slot %u at %u,%u: %llu\n", jobs[j].slot[0], jobs[j].cell[0] % 8, jobs[j].cell[0] / 8, (unsigned long long)sum);
+        j = k;
+    }
+}
+
+static int verify(u32 max_depth, u32 threads, PerftKernel kernel, PerftJob *jobs)
+{
+    u32 failures = 0;
+    u64 nodes = 0;
+    f64 start = now_seconds();
+
+    for (u32 p = 0; p < sizeof(PERFT_POSITIONS) / sizeof(PERFT_POSITIONS[0]); p++) {
+        const PerftPosition *pos = &PERFT_POSITIONS[p];
+        GameState state;
+        position_state(&state, pos->seed, pos->grid);
+
+        printf("%-8s", pos->name);
+        for (u32 d = 1; d <= 5 && d <= max_depth; d++) {
+            u64 count = perft_run(&state, d, threads, kernel, jobs, NULL);
+            bool ok = count == pos->counts[d - 1];
+            failures += !ok;
+            nodes += count;
+            printf("  d%u %llu%s", d, (unsigned long long)count, ok ? "" : " MISMATCH");
+        }
+        printf("\n");
+    }
+
+    f64 elapsed = now_seconds() - start;
+    printf("perft: %s, %llu nodes in %.2fs (%.1f M nodes/s, %u threads)\n", failures ? "FAILED" : "all counts match",
+           (unsigned long long)nodes, elapsed, nodes / elapsed / 1e6, threads);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    u32 depth = 3;
+    u64 seed = 0xB664;
+    u64 grid = 0;
+    u32 threads = (u32)sysconf(_SC_NPROCESSORS_ONLN);
+    PerftKernel kernel = KERNEL_BOARD;
+    bool divide = false, run_verify = false, depth_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = (u32)strtoul(argv[++i], NULL, 10);
+            depth_set = true;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) grid = strtoull(argv[++i], NULL, 16);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--divide") == 0) divide = true;
+        else if (strcmp(argv[i], "--verify") == 0) run_verify = true;
+        else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            i++;
+            kernel = KERNEL_COUNT;
+            for (u8 k = 0; k < KERNEL_COUNT; k++) if (strcmp(argv[i], KERNEL_NAMES[k]) == 0) kernel = (PerftKernel)k;
+            if (kernel == KERNEL_COUNT) {
+                fprintf(stderr, "perft: unknown kernel %s (board, apply, reference, movegen)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [--depth N] [--seed S] [--grid HEX] [--threads T] [--kernel K] [--divide]\n"
+                            "       %s --verify [--depth N] [--threads T] [--kernel K]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (threads == 0) threads = 1;
+    if (depth == 0 || depth > PERFT_MAX_DEPTH) {
+        fprintf(stderr, "perft: depth must be 1..%u\n", PERFT_MAX_DEPTH);
+        return 1;
+    }
+
+    // At most 3 * 64 first moves times 3 * 64 second moves, GameState wants 64 byte alignment
+    PerftJob *jobs = (PerftJob *)aligned_alloc(64, 3 * 64 * 3 * 64 * sizeof(PerftJob));
+
+    int result = 0;
+    if (run_verify) {
+        result = verify(depth_set ? depth : 4, threads, kernel, jobs);
+    } else {
+        GameState state;
+        position_state(&state, seed, grid);
+
+        u32 job_count;
+        f64 start = now_seconds();
+        u64 count = perft_run(&state, depth, threads, kernel, jobs, &job_count);
+        f64 elapsed = now_seconds() - start;
+
+        if (divide) print_divide(jobs, job_count);
+        printf("perft %u: %llu sequences, %.3fs, %.1f M nodes/s (%s, %u threads)\n", depth, (unsigned long long)count,
+               elapsed, count / elapsed / 1e6, KERNEL_NAMES[kernel], threads);
+    }
+
+    free(jobs);
+    return result;
+}
@@ -0,0 +1,241 @@
+// BG64 PIECE STREAM
+// Prints the pieces a seed deals from any position in the stream without stepping the
+// generator up to it (bg64_rng jump ahead), in any piece mode (bg64_pieces). --check
+// compares jumps against plain stepping for random distances, round trips them through
+// xorshift_jump_back and times a jump. --modes checks every mode's bulk fill against
+// single draws and jumps, compares dealt frequencies with the weights, checks a replayed
+// new game keeps the mode and custom weights, times queue refills against Pieces_Draw one
+// piece at a time in the same mode (failing when the bulk fill is slower) and times an
+// alias table rebuild.
+//
+// usage: pieces SEED INDEX [COUNT] [MODE]
+//        pieces --check
+//        pieces --modes
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "bg64.h"
+#include "bg64_rng.h"
+#include "bg64_pieces.h"
+#include "bg64_replay.h"
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static int check(void)
+{
+    u64 rng = 0xB664;
+    u32 failures = 0;
+
+    // Against stepping, distances up to a million
+    for (u32 t = 0; t < 64; t++) {
+        u64 seed = xorshift(&rng) | 1;
+        u64 n = xorshift(&rng) % 1000000;
+
+        u64 stepped = seed;
+        for (u64 i = 0; i < n; i++) xorshift(&stepped);
+
+        u64 jumped = seed;
+        xorshift_jump(&jumped, n);
+        if (jumped != stepped) {
+            fprintf(stderr, "pieces: seed %016llx jump %llu gives %016llx, stepping gives %016llx\n",
+                    (unsigned long long)seed, (unsigned long long)n, (unsigned long long)jumped, (unsigned long long)stepped);
+            failures++;
+        }
+    }
+
+    // Full range distances: jump back must undo, and a jump composes with single steps
+    for (u32 t = 0; t < 1024; t++) {
+        u64 seed = xorshift(&rng) | 1;
+        u64 n = xorshift(&rng);
+
+        u64 x = seed;
+        xorshift_jump(&x, n);
+        u64 next = x;
+        xorshift(&next);
+        u64 y = seed;
+        xorshift_jump(&y, n + 1);
+        xorshift_jump_back(&x, n);
+
+        if (x != seed || (n + 1 != 0 && y != next)) failures++;
+    }
+
+    // The period really is 2^64 - 1
+    u64 seed = 0xB664;
+    u64 x = seed;
+    xorshift_jump(&x, XORSHIFT_PERIOD);
+    if (x != seed) failures++;
+
+    const u32 jumps = 200000;
+    f64 start = now_seconds();
+    u64 sink = 0;
+    for (u32 i = 0; i < jumps; i++) {
+        u64 s = seed;
+        sink ^= xorshift_jump(&s, xorshift(&rng));
+    }
+    f64 elapsed = now_seconds() - start;
+
+    printf("pieces: %s, %.0f ns per full range jump (%016llx)\n", failures ? "FAILED" : "jumps match stepping",
+           elapsed * 1e9 / jumps, (unsigned long long)sink);
+    return failures ? 1 : 0;
+}
+
+static const char *MODE_NAMES[PIECE_MODE_COUNT] = { "classic", "relaxed", "hard", "custom" };
+
+// fill_queue one piece at a time: one Pieces_Draw and one produce per piece, same mode
+static void fill_queue_single(GameState *state)
+{
+    const PieceDistribution *distribution = Pieces_StateDistribution(state);
+    u8 slots_to_fill = 64 - ring_buffer_data_available(state);
+    for (u8 i = 0; i < slots_to_fill; i++) ring_buffer_produce(state, Pieces_Draw(distribution, &state->utility.rng_seed));
+}
+
+// Pieces per second through refills of a drained queue
+static f64 time_refills(GameState *state, bool single, u64 *sink)
+{
+    const u32 refills = 400000;
+    u8 batch[64];
+    f64 start = now_seconds();
+    for (u32 i = 0; i < refills; i++) {
+        ring_buffer_consume_batch(state, batch, 64);
+        *sink += batch[i & 63];
+        if (single) fill_queue_single(state);
+        else fill_queue(state);
+    }
+    return refills * 64.0 / (now_seconds() - start);
+}
+
+static int modes(void)
+{
+    u32 failures = 0;
+    u64 rng = 0xB664;
+    u64 sink = 0;
+
+    // Custom mode: weights from a mid game board, shapes that fit it favored
+    f32 base[SHAPE_OPTIONS], custom[SHAPE_OPTIONS];
+    for (u32 s = 0; s < SHAPE_OPTIONS; s++) base[s] = 1.0f;
+    Pieces_BoardWeights(base, 0x81C3E70000183C7EULL, 1.0f, custom);
+
+    for (u32 m = 0; m < PIECE_MODE_COUNT; m++) {
+        GameState state;
+        GameState_ResetMode(&state, xorshift(&rng) | 1, (u8)m);
+        if (m == PIECE_MODE_CUSTOM) Pieces_SetCustomWeights(&state, custom, NULL);
+        const PieceDistribution *d = Pieces_StateDistribution(&state);
+
+        // Bulk fill, single draws and jumps must deal the same stream
+        u64 seed = xorshift(&rng) | 1;
+        u8 filled[256];
+        u64 fill_seed = seed, draw_seed = seed, classic_seed = seed;
+        Pieces_Fill(d, &fill_seed, filled, 256);
+        for (u32 i = 0; i < 256; i++) {
+            u8 drawn = Pieces_Draw(d, &draw_seed);
+            u8 classic = generate_composite_byte(&classic_seed);
+            if (drawn != filled[i] || Pieces_At(d, seed, i) != filled[i] || (m == PIECE_MODE_CLASSIC && classic != drawn)) {
+                failures++;
+                break;
+            }
+        }
+        if (fill_seed != draw_seed) failures++;
+
+        // Dealt frequencies against the weights the state holds, total variation distance
+        u32 counts[SHAPE_COUNT] = { 0 }, color_counts[8] = { 0 };
+        const u32 draws = 1 << 24;
+        u8 block[4096];
+        for (u32 i = 0; i < draws; i += 4096) {
+            Pieces_Fill(d, &seed, block, 4096);
+            for (u32 k = 0; k < 4096; k++) {
+                counts[GET_SHAPE(block[k])]++;
+                color_counts[GET_COLOR(block[k])]++;
+            }
+        }
+        f64 weights[SHAPE_COUNT], sum = 0;
+        for (u32 s = 1; s <= SHAPE_OPTIONS; s++) {
+            f64 w = 1.0;
+            if (m == PIECE_MODE_RELAXED) w = 1.0 / SHAPE_INFO[s].cells;
+            else if (m == PIECE_MODE_HARD) w = SHAPE_INFO[s].cells;
+            else if (m == PIECE_MODE_CUSTOM) w = Pieces_WeightLevel(state.grid.piece_weights, s - 1);
+            weights[s] = w;
+            sum += w;
+        }
+        f64 distance = 0, color_distance = 0;
+        for (u32 s = 1; s <= SHAPE_OPTIONS; s++) distance += fabs((f64)counts[s] / draws - weights[s] / sum) / 2;
+        for (u32 c = 1; c <= COLOR_OPTIONS; c++) color_distance += fabs((f64)color_counts[c] / draws - 1.0 / COLOR_OPTIONS) / 2;
+        if (counts[0] || distance > 0.002 || color_distance > 0.002) failures++;
+
+        // A new game in a replay keeps dealing the same weights
+        GameState next = state;
+        Replay_ApplyMove(&next, (ReplayMove){ .slot = REPLAY_NEW_GAME });
+        if (next.session.piece_mode != m || memcmp(next.grid.piece_weights, state.grid.piece_weights, 16) != 0) failures++;
+
+        // Refills against the same mode one piece at a time, the bulk fill must not lose
+        f64 bulk = 0, single = 0;
+        for (u32 rep = 0; rep < 5; rep++) {
+            f64 b = time_refills(&state, false, &sink), o = time_refills(&state, true, &sink);
+            if (b > bulk) bulk = b;
+            if (o > single) single = o;
+        }
+        bool slower = bulk < single;
+        failures += slower;
+
+        printf("  %-8s shapes %.5f colors %.5f off the weights, fill_queue %.0f M pieces/s (one at a time %.0f M)%s\n",
+               MODE_NAMES[m], distance, color_distance, bulk / 1e6, single / 1e6, slower ? " SLOWER" : "");
+    }
+
+    // Board dependent rebuild: weights into the state and both tables
+    GameState state;
+    GameState_ResetMode(&state, 1, PIECE_MODE_CUSTOM);
+    PieceDistribution rebuilt;
+    const u32 rebuilds = 100000;
+    f64 start = now_seconds();
+    for (u32 i = 0; i < rebuilds; i++) {
+        Pieces_BoardWeights(base, xorshift(&rng) & xorshift(&rng), 1.0f, custom);
+        Pieces_SetCustomWeights(&state, custom, NULL);
+        Pieces_BuildCustom(state.grid.piece_weights, &rebuilt);
+        sink += rebuilt.shapes.alias[i % SHAPE_OPTIONS];
+    }
+    f64 elapsed = now_seconds() - start;
+
+    printf("pieces: %s, %.0f ns per board dependent rebuild (%016llx)\n", failures ? "FAILED" : "modes deal their weights",
+           elapsed * 1e9 / rebuilds, (unsigned long long)sink);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--check") == 0) return check();
+    if (argc == 2 && strcmp(argv[1], "--modes") == 0) return modes();
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s SEED INDEX [COUNT] [MODE]\n       %s --check\n       %s --modes\n", argv[0], argv[0],
+                argv[0]);
+        return 1;
+    }
+
+    u64 seed = strtoull(argv[1], NULL, 0);
+    u64 index = strtoull(argv[2], NULL, 0);
+    u64 count = argc > 3 ? strtoull(argv[3], NULL, 0) : 16;
+    const PieceDistribution *distribution = Pieces_Distribution(argc > 4 ? (u8)strtoul(argv[4], NULL, 10) : PIECE_MODE_CLASSIC);
+    if (!seed) {
+        fprintf(stderr, "pieces: the seed must be non zero\n");
+        return 1;
+    }
+
+    f64 start = now_seconds();
+    xorshift_jump(&seed, index);
+    f64 elapsed = now_seconds() - start;
+
+    printf("seed after %llu pieces: %016llx (%.1f us)\n", (unsigned long long)index, (unsigned long long)seed, elapsed * 1e6);
+    for (u64 i = 0; i < count; i++) {
+        u8 composite = Pieces_Draw(distribution, &seed);
+        printf("  %llu: shape %2u color %u (0x%02x)\n", (unsigned long long)(index + i), GET_SHAPE(composite),
+               GET_COLOR(composite), composite);
+    }
+    return 0;
+}
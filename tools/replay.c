@@ -0,0 +1,338 @@
+// BG64 REPLAY TOOL
+// record: plays a long greedy bot session (new games chain off the piece stream) into a
+//         keyframed replay file
+// info:   header, footer and chunk layout
+// seek:   board and score after move M, and how long the seek took
+// verify: replays every move from the start and checks each keyframe against the result,
+//         then times random seeks
+// compress: range codes the moves into a move log (bg64_movelog), decodes it back against
+//         the replay and compares its size with raw (slot, gx, gy) records
+// expand: writes a move log back out as a seekable replay
+// check:  the whole round trip on a fresh recording: verify, compress with both models,
+//         decode against the replay, expand and demand the expanded replay is the same
+//         file byte for byte; the scratch files are removed afterwards
+//
+// usage: replay record FILE [--moves N] [--seed S] [--interval K]
+//        replay info FILE
+//        replay seek FILE MOVE
+//        replay verify FILE [--seeks N]
+//        replay compress FILE LOG [--model index|ranked]
+//        replay expand LOG FILE [--interval K]
+//        replay check FILE [--moves N]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+#include "bg64_replay.h"
+#include "bg64_movelog.h"
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static void print_board(const GameState *state)
+{
+    for (u32 y = 0; y < 8; y++) {
+        printf("  ");
+        for (u32 x = 0; x < 8; x++) printf("%c ", ((state->grid.game_grid >> (63 - (y * 8 + x))) & 1) ? '#' : '.');
+        printf("\n");
+    }
+    printf("  score %llu, deck %u %u %u\n", (unsigned long long)state->session.current_score,
+           state->session.deck_shape_color_bits[0], state->session.deck_shape_color_bits[1],
+           state->session.deck_shape_color_bits[2]);
+}
+
+static int cmd_record(const char *path, u64 moves, u64 seed, u32 interval)
+{
+    GameState state;
+    GameState_Reset(&state, seed);
+    state.utility.current_screen = SCREEN_GAMEPLAY;
+
+    ReplayWriter writer;
+    if (!ReplayWriter_Create(&writer, path, &state, interval)) {
+        perror(path);
+        return 1;
+    }
+
+    u64 games = 1;
+    f64 start = now_seconds();
+    for (u64 m = 0; m < moves; m++) {
+        EvalMove best;
+        ReplayMove move = { .slot = REPLAY_NEW_GAME };
+        if (Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &state, &best)) {
+            move = (ReplayMove){ best.slot, best.gx, best.gy, 0 };
+        } else {
+            games++;
+        }
+
+        ReplayWriter_Append(&writer, move);
+        Replay_ApplyMove(&state, move);
+    }
+
+    if (!ReplayWriter_Finish(&writer)) {
+        fprintf(stderr, "replay: failed writing %s\n", path);
+        return 1;
+    }
+
+    printf("replay: %llu moves over %llu games, %llu keyframes, %.2fs\n", (unsigned long long)writer.move_count,
+           (unsigned long long)games, (unsigned long long)writer.keyframe_count, now_seconds() - start);
+    return 0;
+}
+
+static int cmd_info(const Replay *replay)
+{
+    printf("moves      %llu\n", (unsigned long long)replay->move_count);
+    printf("keyframes  %llu, every %u moves\n", (unsigned long long)replay->keyframe_count, replay->keyframe_interval);
+    printf("file       %zu bytes, %.2f bytes per move\n", replay->size,
+           replay->move_count ? (f64)replay->size / replay->move_count : 0.0);
+    return 0;
+}
+
+static int cmd_seek(const Replay *replay, u64 move)
+{
+    GameState state;
+    f64 start = now_seconds();
+    if (!Replay_Seek(replay, move, &state)) {
+        fprintf(stderr, "replay: move %llu is past the end (%llu)\n", (unsigned long long)move,
+                (unsigned long long)replay->move_count);
+        return 1;
+    }
+    f64 elapsed = now_seconds() - start;
+
+    printf("after move %llu (%.1f us):\n", (unsigned long long)move, elapsed * 1e6);
+    print_board(&state);
+    return 0;
+}
+
+static int cmd_verify(const Replay *replay, u32 seeks)
+{
+    GameState state;
+    memcpy(&state, Replay_Keyframe(replay, 0), sizeof(GameState));
+
+    // Sequential pass: every keyframe must equal the state reached by playing up to it
+    u64 played = 0;
+    for (u64 k = 0; k < replay->keyframe_count; k++) {
+        if (memcmp(&state, Replay_Keyframe(replay, k), sizeof(GameState)) != 0) {
+            fprintf(stderr, "replay: keyframe %llu does not match move %llu\n", (unsigned long long)k, (unsigned long long)played);
+            return 1;
+        }
+
+        u32 count;
+        const ReplayMove *moves = Replay_ChunkMoves(replay, k, &count);
+        for (u32 i = 0; i < count; i++, played++) {
+            if (!Replay_ApplyMove(&state, moves[i])) {
+                fprintf(stderr, "replay: move %llu is illegal\n", (unsigned long long)played);
+                return 1;
+            }
+        }
+    }
+    printf("replay: %llu keyframes and %llu moves consistent\n", (unsigned long long)replay->keyframe_count,
+           (unsigned long long)played);
+
+    // Random seeks against the sequential result of the end state
+    u64 rng = 0xB664;
+    f64 start = now_seconds();
+    u64 checksum = 0;
+    for (u32 i = 0; i < seeks; i++) {
+        u64 target = xorshift(&rng) % (replay->move_count + 1);
+        GameState seeked;
+        Replay_Seek(replay, target, &seeked);
+        checksum ^= seeked.grid.game_grid;
+    }
+    f64 elapsed = now_seconds() - start;
+
+    GameState end;
+    Replay_Seek(replay, replay->move_count, &end);
+    if (memcmp(&end, &state, sizeof(GameState)) != 0) {
+        fprintf(stderr, "replay: seek to the end disagrees with the sequential replay\n");
+        return 1;
+    }
+
+    printf("replay: %u random seeks, %.2f us each (checksum %016llx)\n", seeks, elapsed * 1e6 / (seeks ? seeks : 1),
+           (unsigned long long)checksum);
+    return 0;
+}
+
+static int cmd_compress(const Replay *replay, const char *log_path, MoveLogModel model)
+{
+    f64 start = now_seconds();
+    u64 moves;
+    if (!MoveLog_Compress(replay, log_path, model, &moves)) {
+        fprintf(stderr, "replay: failed compressing into %s\n", log_path);
+        return 1;
+    }
+    f64 encode_seconds = now_seconds() - start;
+
+    // Decode against the replay move for move
+    MoveLogReader reader;
+    if (!MoveLogReader_Open(&reader, log_path)) {
+        fprintf(stderr, "replay: %s is not a move log\n", log_path);
+        return 1;
+    }
+    u64 payload = reader.size - sizeof(MoveLogHeader) - sizeof(GameState);
+    usize log_size = reader.size;
+
+    start = now_seconds();
+    u64 matched = 0;
+    ReplayMove move;
+    for (u64 k = 0; k < replay->keyframe_count; k++) {
+        u32 count;
+        const ReplayMove *recorded = Replay_ChunkMoves(replay, k, &count);
+        for (u32 i = 0; i < count; i++) {
+            if (!MoveLogReader_Next(&reader, &move) || memcmp(&move, &recorded[i], sizeof(move)) != 0) break;
+            matched++;
+        }
+    }
+    f64 decode_seconds = now_seconds() - start;
+    MoveLogReader_Close(&reader);
+
+    if (matched != replay->move_count) {
+        fprintf(stderr, "replay: move log diverges from the replay at move %llu\n", (unsigned long long)matched);
+        return 1;
+    }
+
+    u64 raw = moves * 3; // (slot, gx, gy), a byte each
+    printf("replay: %llu moves, %s model: %llu payload bytes, %.3f bits per move\n", (unsigned long long)moves,
+           model == MOVELOG_MODEL_RANKED ? "ranked" : "index", (unsigned long long)payload,
+           moves ? payload * 8.0 / moves : 0.0);
+    printf("  raw (slot, gx, gy) %llu bytes: %.1fx smaller; replay file %zu bytes, log file %zu bytes\n",
+           (unsigned long long)raw, payload ? (f64)raw / payload : 0.0, replay->size, log_size);
+    printf("  encode %.2fs, decode %.2fs (%.2f M moves/s), decoded moves match the replay\n", encode_seconds,
+           decode_seconds, moves / (decode_seconds > 0 ? decode_seconds : 1e-9) / 1e6);
+    return 0;
+}
+
+static bool same_file(const char *a_path, const char *b_path)
+{
+    FILE *a = fopen(a_path, "rb");
+    FILE *b = fopen(b_path, "rb");
+    bool same = a && b;
+    u8 a_buf[4096], b_buf[4096];
+    while (same) {
+        usize a_len = fread(a_buf, 1, sizeof(a_buf), a);
+        usize b_len = fread(b_buf, 1, sizeof(b_buf), b);
+        same = a_len == b_len && memcmp(a_buf, b_buf, a_len) == 0;
+        if (a_len < sizeof(a_buf)) break;
+    }
+    if (a) fclose(a);
+    if (b) fclose(b);
+    return same;
+}
+
+static int cmd_check(const char *path, u64 moves)
+{
+    char log_path[4096], expanded_path[4096];
+    snprintf(log_path, sizeof(log_path), "%s.bgml", path);
+    snprintf(expanded_path, sizeof(expanded_path), "%s.expanded.bgr", path);
+
+    int result = cmd_record(path, moves, 0xB664, REPLAY_DEFAULT_INTERVAL);
+    Replay replay;
+    if (result == 0 && !Replay_Open(&replay, path)) {
+        fprintf(stderr, "replay: %s did not open after recording\n", path);
+        result = 1;
+    }
+    if (result == 0) {
+        result = cmd_verify(&replay, 1000);
+        for (u32 model = 0; model < MOVELOG_MODEL_COUNT && result == 0; model++) {
+            result = cmd_compress(&replay, log_path, (MoveLogModel)model);
+            if (result != 0) break;
+
+            u64 expanded;
+            if (!MoveLog_Expand(log_path, expanded_path, replay.keyframe_interval, &expanded) ||
+                !same_file(path, expanded_path)) {
+                fprintf(stderr, "replay: %s model, the expanded replay differs from %s\n",
+                        model == MOVELOG_MODEL_RANKED ? "ranked" : "index", path);
+                result = 1;
+            }
+        }
+        Replay_Close(&replay);
+    }
+
+    remove(log_path);
+    remove(expanded_path);
+    remove(path);
+    if (result == 0) printf("replay: record, compress, decode and expand round trip byte for byte\n");
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s record FILE [--moves N] [--seed S] [--interval K]\n"
+                        "       %s info FILE\n"
+                        "       %s seek FILE MOVE\n"
+                        "       %s verify FILE [--seeks N]\n"
+                        "       %s compress FILE LOG [--model index|ranked]\n"
+                        "       %s expand LOG FILE [--interval K]\n"
+                        "       %s check FILE [--moves N]\n", argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    const char *cmd = argv[1];
+    const char *path = argv[2];
+
+    if (strcmp(cmd, "record") == 0) {
+        u64 moves = 100000;
+        u64 seed = 0xB664;
+        u32 interval = REPLAY_DEFAULT_INTERVAL;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--moves") == 0) moves = strtoull(argv[i + 1], NULL, 10);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 0);
+            else if (strcmp(argv[i], "--interval") == 0) interval = (u32)strtoul(argv[i + 1], NULL, 10);
+        }
+        return cmd_record(path, moves, seed, interval);
+    }
+
+    if (strcmp(cmd, "check") == 0) {
+        u64 moves = 20000;
+        if (argc > 4 && strcmp(argv[3], "--moves") == 0) moves = strtoull(argv[4], NULL, 10);
+        return cmd_check(path, moves);
+    }
+
+    if (strcmp(cmd, "expand") == 0 && argc > 3) {
+        u32 interval = REPLAY_DEFAULT_INTERVAL;
+        if (argc > 5 && strcmp(argv[4], "--interval") == 0) interval = (u32)strtoul(argv[5], NULL, 10);
+
+        f64 start = now_seconds();
+        u64 moves;
+        if (!MoveLog_Expand(path, argv[3], interval, &moves)) {
+            fprintf(stderr, "replay: failed expanding %s into %s\n", path, argv[3]);
+            return 1;
+        }
+        printf("replay: %llu moves expanded, %.2fs\n", (unsigned long long)moves, now_seconds() - start);
+        return 0;
+    }
+
+    Replay replay;
+    if (!Replay_Open(&replay, path)) {
+        fprintf(stderr, "replay: %s is not a finished replay file\n", path);
+        return 1;
+    }
+
+    int result = 1;
+    if (strcmp(cmd, "info") == 0) {
+        result = cmd_info(&replay);
+    } else if (strcmp(cmd, "seek") == 0 && argc > 3) {
+        result = cmd_seek(&replay, strtoull(argv[3], NULL, 10));
+    } else if (strcmp(cmd, "verify") == 0) {
+        u32 seeks = 100000;
+        if (argc > 4 && strcmp(argv[3], "--seeks") == 0) seeks = (u32)strtoul(argv[4], NULL, 10);
+        result = cmd_verify(&replay, seeks);
+    } else if (strcmp(cmd, "compress") == 0 && argc > 3) {
+        MoveLogModel model = MOVELOG_MODEL_RANKED;
+        if (argc > 5 && strcmp(argv[4], "--model") == 0 && strcmp(argv[5], "index") == 0) model = MOVELOG_MODEL_INDEX;
+        result = cmd_compress(&replay, argv[3], model);
+    } else {
+        fprintf(stderr, "replay: unknown command %s\n", cmd);
+    }
+
+    Replay_Close(&replay);
+    return result;
+}
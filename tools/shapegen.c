@@ -0,0 +1,299 @@
+// SHAPE GENERATOR
+// Reads the ASCII art shape source and emits bg64_shapes.h: the SHAPE_LIBRARY masks plus
+// every piece of metadata the engine used to re-derive at runtime (bounding box, cell
+// count, row extents, legal anchors on an empty board, the transposed mask and deck render
+// offsets).
+//
+// usage: shapegen shapes.txt > bg64_shapes.h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+typedef uint8_t u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+#define MAX_SHAPES 31 // 5 shape bits in the composite byte, slot 0 is void
+#define MAX_SOURCE 64
+
+typedef struct
+{
+    char name[32];
+    u64 mask;
+    bool rotate;
+    bool reflect;
+} SourceShape;
+
+typedef struct
+{
+    char name[48];
+    u64 mask;
+} OutShape;
+
+
+static bool cell(u64 mask, int x, int y)
+{
+    return (mask >> (63 - (y * 8 + x))) & 1;
+}
+
+static u64 with_cell(u64 mask, int x, int y)
+{
+    return mask | (1ULL << (63 - (y * 8 + x)));
+}
+
+static void extent(u64 mask, int *w, int *h)
+{
+    *w = 0; *h = 0;
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            if (!cell(mask, x, y)) continue;
+            if (x + 1 > *w) *w = x + 1;
+            if (y + 1 > *h) *h = y + 1;
+        }
+    }
+}
+
+// Slide a mask up and left until it touches row 0 and column 0
+static u64 normalize(u64 mask)
+{
+    if (!mask) return 0;
+    while (!(mask & 0xFF00000000000000ULL)) mask <<= 8;
+    while (!(mask & 0x8080808080808080ULL)) mask = (mask << 1) & 0xFEFEFEFEFEFEFEFEULL;
+    return mask;
+}
+
+static u64 rotate90(u64 mask)
+{
+    int w, h;
+    extent(mask, &w, &h);
+
+    // clockwise: (x, y) -> (h - 1 - y, x)
+    u64 out = 0;
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            if (cell(mask, x, y)) out = with_cell(out, h - 1 - y, x);
+
+    return normalize(out);
+}
+
+static u64 mirror(u64 mask)
+{
+    int w, h;
+    extent(mask, &w, &h);
+
+    u64 out = 0;
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            if (cell(mask, x, y)) out = with_cell(out, w - 1 - x, y);
+
+    return normalize(out);
+}
+
+// Mirror over the main diagonal: (x, y) -> (y, x), stays anchored top left
+static u64 transpose(u64 mask)
+{
+    u64 out = 0;
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++)
+            if (cell(mask, x, y)) out = with_cell(out, y, x);
+
+    return out;
+}
+
+static int parse(FILE *f, SourceShape *shapes)
+{
+    char line[256];
+    int count = 0;
+    int row = -1;
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = 0;
+
+        if (line[0] == '#') continue;
+
+        if (strncmp(line, "shape ", 6) == 0) {
+            if (count == MAX_SOURCE) {
+                fprintf(stderr, "shapegen:%d: too many shapes\n", line_no);
+                exit(1);
+            }
+
+            SourceShape *s = &shapes[count++];
+            memset(s, 0, sizeof(*s));
+
+            char *tok = strtok(line + 6, " \t");
+            if (!tok) {
+                fprintf(stderr, "shapegen:%d: shape needs a name\n", line_no);
+                exit(1);
+            }
+            snprintf(s->name, sizeof(s->name), "%s", tok);
+
+            while ((tok = strtok(NULL, " \t"))) {
+                if (strcmp(tok, "rotate") == 0) s->rotate = true;
+                else if (strcmp(tok, "reflect") == 0) s->reflect = true;
+                else {
+                    fprintf(stderr, "shapegen:%d: unknown flag '%s'\n", line_no, tok);
+                    exit(1);
+                }
+            }
+
+            row = 0;
+            continue;
+        }
+
+        bool blank = true;
+        for (char *c = line; *c; c++) if (!isspace((unsigned char)*c)) blank = false;
+        if (blank) { row = -1; continue; }
+
+        if (row < 0 || count == 0) {
+            fprintf(stderr, "shapegen:%d: row outside of a shape\n", line_no);
+            exit(1);
+        }
+        if (row >= 8 || strlen(line) > 8) {
+            fprintf(stderr, "shapegen:%d: shapes are at most 8x8\n", line_no);
+            exit(1);
+        }
+
+        for (int x = 0; line[x]; x++) {
+            if (line[x] == 'X') shapes[count - 1].mask = with_cell(shapes[count - 1].mask, x, row);
+            else if (line[x] != '.') {
+                fprintf(stderr, "shapegen:%d: unexpected '%c'\n", line_no, line[x]);
+                exit(1);
+            }
+        }
+        row++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!shapes[i].mask) {
+            fprintf(stderr, "shapegen: shape '%s' is empty\n", shapes[i].name);
+            exit(1);
+        }
+        shapes[i].mask = normalize(shapes[i].mask);
+    }
+
+    return count;
+}
+
+static bool add(OutShape *out, int *count, const char *name, u64 mask)
+{
+    for (int i = 1; i < *count; i++) if (out[i].mask == mask) return false;
+
+    if (*count > MAX_SHAPES) {
+        fprintf(stderr, "shapegen: more than %d shapes, the composite byte has 5 shape bits\n", MAX_SHAPES);
+        exit(1);
+    }
+
+    snprintf(out[*count].name, sizeof(out[*count].name), "%s", name);
+    out[*count].mask = mask;
+    (*count)++;
+    return true;
+}
+
+static void emit(const OutShape *out, int count)
+{
+    printf("// GENERATED by tools/shapegen from shapes.txt. Do not edit, edit shapes.txt.\n");
+    printf("#ifndef BG64_SHAPES_H_\n#define BG64_SHAPES_H_\n\n\n");
+    printf("#define SHAPE_COUNT %d   // library slots including the void shape\n", count);
+    printf("#define SHAPE_OPTIONS %d // playable shapes, 1..SHAPE_OPTIONS\n\n\n", count - 1);
+
+    printf("static const u64 SHAPE_LIBRARY[SHAPE_COUNT] = {\n");
+    printf("    [0] = 0, // Void\n");
+    for (int i = 1; i < count; i++) {
+        int w, h;
+        extent(out[i].mask, &w, &h);
+
+        printf("\n");
+        for (int y = 0; y < h; y++) {
+            printf("    // ");
+            for (int x = 0; x < w; x++) printf(cell(out[i].mask, x, y) ? "[X]" : "[ ]");
+            printf("\n");
+        }
+        printf("    [%d] = 0x%016llXULL, // %s (%dx%d)\n", i, (unsigned long long)out[i].mask, out[i].name, w, h);
+    }
+    printf("};\n\n\n");
+
+    printf("static const ShapeInfo SHAPE_INFO[SHAPE_COUNT] = {\n");
+    printf("    [0] = { .name = \"void\" },\n");
+    for (int i = 1; i < count; i++) {
+        u64 m = out[i].mask;
+        int w, h;
+        extent(m, &w, &h);
+
+        // Every anchor whose bounding box stays on an empty 8x8 board
+        u64 anchors = 0;
+        for (int gy = 0; gy + h <= 8; gy++)
+            for (int gx = 0; gx + w <= 8; gx++)
+                anchors = with_cell(anchors, gx, gy);
+
+        printf("    [%d] = { .mask = 0x%016llXULL, .anchors = 0x%016llXULL,\n",
+               i, (unsigned long long)m, (unsigned long long)anchors);
+        printf("            .transposed = 0x%016llXULL,\n", (unsigned long long)transpose(m));
+        printf("            .width = %d, .height = %d, .cells = %d, .row_extent = { ",
+               w, h, __builtin_popcountll(m));
+        for (int y = 0; y < h; y++) {
+            u8 row = (u8)(m >> (56 - y * 8));
+            printf("%s%d", y ? ", " : "", 8 - __builtin_ctz(row));
+        }
+        // Offset in cells from a deck slot center to the top left cell center
+        printf(" },\n            .render_dx = %.1ff, .render_dy = %.1ff, .name = \"%s\" },\n",
+               -(w - 1) / 2.0, -(h - 1) / 2.0, out[i].name);
+    }
+    printf("};\n\n\n#endif /* BG64_SHAPES_H_ */\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s shapes.txt > bg64_shapes.h\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "r");
+    if (!f) {
+        fprintf(stderr, "shapegen: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    static SourceShape src[MAX_SOURCE];
+    int src_count = parse(f, src);
+    fclose(f);
+
+    static OutShape out[MAX_SHAPES + 1];
+    int count = 1; // slot 0 is void
+
+    // Pass 1: base shapes in listing order
+    for (int i = 0; i < src_count; i++) {
+        if (!add(out, &count, src[i].name, src[i].mask)) {
+            fprintf(stderr, "shapegen: shape '%s' duplicates an earlier shape\n", src[i].name);
+            return 1;
+        }
+    }
+
+    // Pass 2: derived orientations
+    for (int i = 0; i < src_count; i++) {
+        int variant = 1;
+        u64 base[2] = { src[i].mask, mirror(src[i].mask) };
+        int faces = src[i].reflect ? 2 : 1;
+
+        for (int f_idx = 0; f_idx < faces; f_idx++) {
+            u64 m = base[f_idx];
+            int turns = src[i].rotate ? 4 : 1;
+
+            for (int t = 0; t < turns; t++) {
+                char name[48];
+                snprintf(name, sizeof(name), "%.30s_%d", src[i].name, variant);
+                if (add(out, &count, name, m)) variant++;
+                m = rotate90(m);
+            }
+        }
+    }
+
+    emit(out, count);
+    return 0;
+}
@@ -0,0 +1,209 @@
+// BG64 SOLVER
+// Runs the exact lookahead solver (bg64_solver) on a position and prints the best
+// placement sequence over the next K decks, replayed through ApplyMove as a check.
+// --check compares the solver against a plain exhaustive search on random positions.
+// --after M first lets the greedy player make M moves, for a mid game position.
+// --play N plays N decks re-solving at every deck and compares with the greedy player.
+//
+// usage: solve [--seed S] [--grid HEX] [--after M] [--decks K] [--goal score|survival]
+//              [--nodes N] [--seconds T] [--table-bits B] [--check] [--play N]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+#include "bg64_solver.h"
+
+// Exhaustive reference: every sequence over the horizon, no table, no bound
+static u32 brute_force(const GameState *state, u32 decks_left, SolverGoal goal)
+{
+    if (decks_left == 0) return 0;
+
+    u32 best = 0;
+    for (u8 slot = 0; slot < 3; slot++) {
+        if (state->session.is_active[slot]) continue;
+        for (int cell = 0; cell < 64; cell++) {
+            GameState child = *state;
+            MoveResult result;
+            if (!ApplyMove(&child, slot, cell % 8, cell / 8, &result)) continue;
+
+            u32 v = result.score_delta + (goal == SOLVER_SURVIVAL ? 1u << 16 : 0);
+            v += brute_force(&child, decks_left - result.deck_refilled, goal);
+            if (v > best) best = v;
+        }
+    }
+    return best;
+}
+
+// Plays the line and returns the points it scored, 0xFFFFFFFF if a move is rejected
+static u32 replay_line(GameState *state, const SolverResult *result)
+{
+    u64 before = state->session.current_score;
+    for (u32 i = 0; i < result->move_count; i++) {
+        const SolverMove *m = &result->moves[i];
+        if (!ApplyMove(state, m->slot, m->gx, m->gy, NULL)) return 0xFFFFFFFF;
+    }
+    return (u32)(state->session.current_score - before);
+}
+
+static int check(Solver *solver)
+{
+    u64 rng = 0xB664;
+    u32 failures = 0, positions = 0;
+
+    for (u32 t = 0; t < 120; t++) {
+        GameState state;
+        GameState_Reset(&state, xorshift(&rng) | 1);
+        state.grid.game_grid = xorshift(&rng) | xorshift(&rng);
+        if (t & 1) state.grid.game_grid &= xorshift(&rng);
+        state.session.is_active[t % 3] = (t % 5) == 0;
+
+        u32 decks = (t % 4 == 3) ? 2 : 1;
+        SolverGoal goal = (t & 2) ? SOLVER_SURVIVAL : SOLVER_SCORE;
+
+        SolverResult result;
+        Solver_Solve(solver, &state, decks, goal, NULL, 0, 0, &result);
+        u32 expect = brute_force(&state, decks, goal);
+
+        // The line must achieve what the solver claims and the claim must be the optimum
+        u32 got = result.score + (goal == SOLVER_SURVIVAL ? result.move_count << 16 : 0);
+        GameState play = state;
+        u32 scored = replay_line(&play, &result);
+
+        if (got != expect || scored != result.score || !result.proven) {
+            printf("solve: position %u (%s, %u decks) solver %u, exhaustive %u, replayed %u\n", t,
+                   goal == SOLVER_SURVIVAL ? "survival" : "score", decks, got, expect, scored);
+            failures++;
+        }
+        positions++;
+    }
+
+    printf("solve: %u positions, %s\n", positions, failures ? "FAILED" : "solver matches exhaustive search");
+    return failures ? 1 : 0;
+}
+
+static int play(Solver *solver, u64 seed, u32 decks_to_play, u32 horizon, SolverGoal goal, u64 nodes, f64 seconds)
+{
+    GameState solved, greedy;
+    GameState_Reset(&solved, seed);
+    GameState_Reset(&greedy, seed);
+
+    u32 solved_pieces = 0, greedy_pieces = 0;
+    u64 total_nodes = 0;
+    f64 total_seconds = 0;
+
+    for (u32 d = 0; d < decks_to_play; d++) {
+        // Commit the first deck of the line, then look again from the new position
+        SolverResult result;
+        if (!Solver_Solve(solver, &solved, horizon, goal, NULL, nodes, seconds, &result) || result.move_count == 0) break;
+        total_nodes += result.nodes;
+        total_seconds += result.seconds;
+
+        bool refilled = false;
+        for (u32 i = 0; i < result.move_count && !refilled; i++) {
+            MoveResult move;
+            ApplyMove(&solved, result.moves[i].slot, result.moves[i].gx, result.moves[i].gy, &move);
+            solved_pieces++;
+            refilled = move.deck_refilled;
+        }
+        if (!refilled) break;
+    }
+
+    // Greedy gets the same number of pieces, unless it gets stuck first
+    EvalMove move;
+    while (greedy_pieces < solved_pieces && Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &greedy, &move)) {
+        ApplyMove(&greedy, move.slot, move.gx, move.gy, NULL);
+        greedy_pieces++;
+    }
+
+    printf("solve: solver %u pieces, score %llu (%.1f M nodes, %.2fs); greedy %u pieces, score %llu\n", solved_pieces,
+           (unsigned long long)solved.session.current_score, total_nodes / 1e6, total_seconds, greedy_pieces,
+           (unsigned long long)greedy.session.current_score);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    u64 seed = 0xB664;
+    u64 grid = 0;
+    bool grid_set = false;
+    u32 decks = 3;
+    SolverGoal goal = SOLVER_SCORE;
+    u64 nodes = 0;
+    f64 seconds = 10.0;
+    u32 table_bits = 22;
+    bool run_check = false;
+    u32 play_decks = 0;
+    u32 after = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = strtoull(argv[++i], NULL, 16);
+            grid_set = true;
+        }
+        else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) decks = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--goal") == 0 && i + 1 < argc) goal = strcmp(argv[++i], "survival") == 0 ? SOLVER_SURVIVAL : SOLVER_SCORE;
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) nodes = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--table-bits") == 0 && i + 1 < argc) table_bits = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--check") == 0) run_check = true;
+        else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) play_decks = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--after") == 0 && i + 1 < argc) after = (u32)strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [--seed S] [--grid HEX] [--after M] [--decks K] [--goal score|survival]\n"
+                            "          [--nodes N] [--seconds T] [--table-bits B] [--check] [--play N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (table_bits < 10 || table_bits > 30) table_bits = 22;
+
+    // The transposition table is probed at random, huge pages save the TLB misses
+    Arena arena = Arena_Reserve(ARENA_SIZE, ARENA_HUGE_PAGES);
+    Solver solver = Solver_Allocation(&arena, table_bits);
+
+    int status = 0;
+    if (run_check) {
+        status = check(&solver);
+    } else if (play_decks) {
+        status = play(&solver, seed, play_decks, decks, goal, nodes, seconds);
+    } else {
+        GameState state;
+        GameState_Reset(&state, seed);
+        if (grid_set) state.grid.game_grid = grid;
+
+        EvalMove move;
+        for (u32 m = 0; m < after && Eval_BestMove(&EVAL_DEFAULT_WEIGHTS, &state, &move); m++) {
+            ApplyMove(&state, move.slot, move.gx, move.gy, NULL);
+        }
+
+        SolverResult result;
+        if (!Solver_Solve(&solver, &state, decks, goal, NULL, nodes, seconds, &result)) {
+            printf("solve: budget ran out before the first deck was solved (%llu nodes)\n", (unsigned long long)result.nodes);
+            status = 1;
+        } else {
+            printf("solve: %s optimum over %u of %u decks: %u points in %u moves\n", result.proven ? "proven" : "partial",
+                   result.decks, decks, result.score, result.move_count);
+            printf("  %llu nodes, %llu table hits, %llu cutoffs, %.3fs (%.2f M nodes/s)\n", (unsigned long long)result.nodes,
+                   (unsigned long long)result.memo_hits, (unsigned long long)result.cutoffs, result.seconds,
+                   result.nodes / (result.seconds > 0 ? result.seconds : 1e-9) / 1e6);
+            for (u32 i = 0; i < result.move_count; i++) {
+                const SolverMove *m = &result.moves[i];
+                printf("  %2u: slot %u at %d,%d%s", i, m->slot, m->gx, m->gy, m->lines ? "" : "\n");
+                if (m->lines) printf(", %u lines\n", m->lines);
+            }
+
+            GameState replay = state;
+            u32 scored = replay_line(&replay, &result);
+            if (scored != result.score) {
+                printf("solve: replaying the line through ApplyMove scored %u\n", scored);
+                status = 1;
+            }
+        }
+    }
+
+    Arena_Release(&arena);
+    return status;
+}
@@ -0,0 +1,200 @@
+// BG64 TELEMETRY READER
+// Scans .bgtl files written by bg64_telemetry and prints a summary: event counts, a
+// placement heat map, time to place, clears and combos, abandonment. Files are mapped
+// read only and walked front to back as arrays of fixed records, so a scan runs at
+// memory bandwidth once the pages are cached.
+//
+// usage: telemetry_read [--dump N] FILE...
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bg64.h"
+#include "bg64_telemetry.h"
+
+static const char *TYPE_NAMES[TELEMETRY_TYPE_COUNT] = {
+    "session", "place", "reject", "game_start", "game_over", "abandon"
+};
+
+typedef struct
+{
+    u64 types[TELEMETRY_TYPE_COUNT];
+    u64 unknown;
+    u64 heat[64];           // accepted placements per anchor cell
+    u64 lines[17];          // placements by lines cleared
+    u64 combos[8];          // clearing placements by combo length, 7 = 7 or more
+    u64 place_ms_sum;
+    u64 place_ms_count;
+    u64 game_moves_sum;     // placements in finished or abandoned games
+    u64 abandon_score_sum;
+    u64 over_score_sum;
+    u32 max_score;
+    u8 max_combo;
+    u64 first_ns;
+    u64 last_ns;
+} Summary;
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static void scan(const TelemetryRecord *records, usize count, Summary *s)
+{
+    for (usize i = 0; i < count; i++) {
+        const TelemetryRecord *r = &records[i];
+        if (r->type >= TELEMETRY_TYPE_COUNT) {
+            s->unknown++;
+            continue;
+        }
+
+        s->types[r->type]++;
+        if (!s->first_ns || r->time_ns < s->first_ns) s->first_ns = r->time_ns;
+        if (r->time_ns > s->last_ns) s->last_ns = r->time_ns;
+        if (r->score > s->max_score) s->max_score = r->score;
+
+        switch (r->type) {
+            case TELEMETRY_PLACE:
+                if ((u8)r->gx < 8 && (u8)r->gy < 8) s->heat[r->gy * 8 + r->gx]++;
+                s->lines[r->lines < 16 ? r->lines : 16]++;
+                if (r->combo) s->combos[r->combo < 7 ? r->combo : 7]++;
+                if (r->combo > s->max_combo) s->max_combo = r->combo;
+                if (r->value) {
+                    s->place_ms_sum += r->value;
+                    s->place_ms_count++;
+                }
+                break;
+
+            case TELEMETRY_GAME_OVER:
+                s->game_moves_sum += r->value;
+                s->over_score_sum += r->score;
+                break;
+
+            case TELEMETRY_ABANDON:
+                s->game_moves_sum += r->value;
+                s->abandon_score_sum += r->score;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static void dump(const TelemetryRecord *records, usize count, u64 *remaining)
+{
+    for (usize i = 0; i < count && *remaining; i++, (*remaining)--) {
+        const TelemetryRecord *r = &records[i];
+        printf("%llu %016llx %-10s slot %u piece %3u at %2d,%2d lines %2u combo %2u score %6u value %u\n",
+               (unsigned long long)r->time_ns, (unsigned long long)r->session,
+               r->type < TELEMETRY_TYPE_COUNT ? TYPE_NAMES[r->type] : "?",
+               r->slot, r->composite, r->gx, r->gy, r->lines, r->combo, r->score, r->value);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    u64 dump_count = 0;
+    int first_file = 1;
+
+    if (argc > 2 && strcmp(argv[1], "--dump") == 0) {
+        dump_count = strtoull(argv[2], NULL, 10);
+        first_file = 3;
+    }
+    if (first_file >= argc) {
+        fprintf(stderr, "usage: %s [--dump N] FILE...\n", argv[0]);
+        return 1;
+    }
+
+    Summary s = { 0 };
+    u64 bytes = 0, records = 0;
+    u32 files = 0;
+    f64 start = now_seconds();
+
+    for (int f = first_file; f < argc; f++) {
+        i32 fd = open(argv[f], O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            perror(argv[f]);
+            if (fd >= 0) close(fd);
+            continue;
+        }
+        if ((usize)st.st_size < sizeof(TelemetryFileHeader)) {
+            fprintf(stderr, "%s: too short\n", argv[f]);
+            close(fd);
+            continue;
+        }
+
+        u8 *map = (u8 *)mmap(NULL, (usize)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            perror(argv[f]);
+            continue;
+        }
+        madvise(map, (usize)st.st_size, MADV_SEQUENTIAL);
+
+        const TelemetryFileHeader *header = (const TelemetryFileHeader *)map;
+        if (header->magic != TELEMETRY_MAGIC || header->record_size != sizeof(TelemetryRecord)) {
+            fprintf(stderr, "%s: not a version %u telemetry file\n", argv[f], TELEMETRY_VERSION);
+            munmap(map, (usize)st.st_size);
+            continue;
+        }
+
+        // A file still being written may end in a partial record, it is ignored
+        usize count = ((usize)st.st_size - sizeof(TelemetryFileHeader)) / sizeof(TelemetryRecord);
+        const TelemetryRecord *recs = (const TelemetryRecord *)(map + sizeof(TelemetryFileHeader));
+
+        if (dump_count) dump(recs, count, &dump_count);
+        scan(recs, count, &s);
+
+        bytes += (u64)st.st_size;
+        records += count;
+        files++;
+        munmap(map, (usize)st.st_size);
+    }
+
+    f64 elapsed = now_seconds() - start;
+
+    printf("telemetry_read: %u files, %llu records, %.1f MB in %.3fs (%.2f GB/s)\n", files,
+           (unsigned long long)records, (f64)bytes / 1e6, elapsed, elapsed > 0 ? (f64)bytes / elapsed / 1e9 : 0.0);
+    if (!records) return 0;
+
+    printf("  span      %.1f hours\n", (f64)(s.last_ns - s.first_ns) / 3.6e12);
+    for (u32 t = 0; t < TELEMETRY_TYPE_COUNT; t++) printf("  %-10s %llu\n", TYPE_NAMES[t], (unsigned long long)s.types[t]);
+    if (s.unknown) printf("  unknown    %llu\n", (unsigned long long)s.unknown);
+
+    u64 ended = s.types[TELEMETRY_GAME_OVER] + s.types[TELEMETRY_ABANDON];
+    if (s.place_ms_count) printf("  time to place  %.0f ms mean\n", (f64)s.place_ms_sum / s.place_ms_count);
+    if (ended) {
+        printf("  games ended    %llu, %.1f%% abandoned, %.1f placements per game\n", (unsigned long long)ended,
+               100.0 * s.types[TELEMETRY_ABANDON] / ended, (f64)s.game_moves_sum / ended);
+    }
+    if (s.types[TELEMETRY_GAME_OVER]) printf("  game over score  %.1f mean\n", (f64)s.over_score_sum / s.types[TELEMETRY_GAME_OVER]);
+    if (s.types[TELEMETRY_ABANDON]) printf("  abandon score    %.1f mean\n", (f64)s.abandon_score_sum / s.types[TELEMETRY_ABANDON]);
+    printf("  max score %u, max combo %u\n", s.max_score, s.max_combo);
+
+    printf("  lines cleared per placement:");
+    for (u32 l = 0; l <= 16; l++) if (s.lines[l]) printf(" %u:%llu", l, (unsigned long long)s.lines[l]);
+    printf("\n  combos:");
+    for (u32 c = 1; c < 8; c++) if (s.combos[c]) printf(" %u%s:%llu", c, c == 7 ? "+" : "", (unsigned long long)s.combos[c]);
+    printf("\n");
+
+    // Heat map in per mille of all accepted placements, anchored at the piece's top left
+    u64 placed = s.types[TELEMETRY_PLACE] ? s.types[TELEMETRY_PLACE] : 1;
+    printf("  placement heat map (per mille, top left anchor):\n");
+    for (u32 y = 0; y < 8; y++) {
+        printf("   ");
+        for (u32 x = 0; x < 8; x++) printf(" %4llu", (unsigned long long)(s.heat[y * 8 + x] * 1000 / placed));
+        printf("\n");
+    }
+
+    return 0;
+}
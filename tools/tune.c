@@ -0,0 +1,365 @@
+// BG64 EVALUATION WEIGHT TUNER
+// Genetic algorithm over EvalWeights. Every candidate of a generation plays the same set
+// of fixed-seed games with the greedy one ply player (Eval_BestMove), spread over all
+// cores; fitness is the mean final score. The population is checkpointed after every
+// generation so a long run picks up where it stopped, and the best weights so far are
+// always on disk in the text format EvalWeights_Load reads. A resumed run keeps the
+// checkpoint's population, games, max moves and seed; giving one of them with a different
+// value, or --init, is an error rather than silently ignored.
+//
+// usage: tune [--population P] [--games G] [--generations N] [--threads T] [--max-moves M]
+//             [--seed S] [--init FILE] [--checkpoint FILE] [--out FILE] [--fresh]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bg64.h"
+#include "bg64_eval.h"
+
+#define TUNE_MAGIC 0x54554E45 // "TUNE"
+#define TUNE_VERSION 1
+#define TUNE_MAX_POPULATION 256
+#define TUNE_ELITE 4
+#define TUNE_TOURNAMENT 3
+
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u32 generation;     // generations completed
+    u32 population;
+    u32 games;
+    u32 max_moves;
+    u64 seed;           // game seed set
+    u64 rng;            // GA random stream
+    f32 sigma;          // current mutation scale
+    f32 best_fitness;
+    EvalWeights best;
+    EvalWeights candidates[TUNE_MAX_POPULATION];
+} TuneCheckpoint;
+
+typedef struct
+{
+    const EvalWeights *candidates;
+    u32 population;
+    u32 games;
+    u32 max_moves;
+    u64 seed;
+
+    atomic_uint next_job; // candidate * games + game
+    u64 *scores;          // one final score per job
+} TuneJobs;
+
+
+static f64 now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+static u64 game_seed(u64 seed, u32 game)
+{
+    u64 s = seed ^ ((u64)(game + 1) * 0x9E3779B97F4A7C15ull);
+    return s ? s : 0xFEED;
+}
+
+static f32 uniform(u64 *rng)
+{
+    return (f32)(xorshift(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+static f32 gaussian(u64 *rng)
+{
+    // Box Muller, the second value is dropped
+    f32 u = uniform(rng);
+    f32 v = uniform(rng);
+    if (u < 1e-7f) u = 1e-7f;
+    return sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * v);
+}
+
+// The greedy player only compares scores, so weights are scale free: keep them on the
+// unit sphere so mutation sizes mean the same thing every generation. The zero vector has
+// no direction, it is left alone and reported with false.
+static bool normalize(EvalWeights *w)
+{
+    f32 norm = 0;
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) norm += w->w[i] * w->w[i];
+    norm = sqrtf(norm);
+    if (norm <= 0) return false;
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) w->w[i] /= norm;
+    return true;
+}
+
+static u64 play_game(const EvalWeights *weights, u64 seed, u32 max_moves)
+{
+    GameState state;
+    GameState_Reset(&state, seed);
+
+    EvalMove move;
+    for (u32 m = 0; m < max_moves && Eval_BestMove(weights, &state, &move); m++) {
+        ApplyMove(&state, move.slot, move.gx, move.gy, NULL);
+    }
+
+    return state.session.current_score;
+}
+
+static void *worker_run(void *arg)
+{
+    TuneJobs *jobs = (TuneJobs *)arg;
+    u32 total = jobs->population * jobs->games;
+
+    for (;;) {
+        u32 job = atomic_fetch_add_explicit(&jobs->next_job, 1, memory_order_relaxed);
+        if (job >= total) break;
+
+        u32 candidate = job / jobs->games;
+        u32 game = job % jobs->games;
+        jobs->scores[job] = play_game(&jobs->candidates[candidate], game_seed(jobs->seed, game), jobs->max_moves);
+    }
+
+    return NULL;
+}
+
+// Scores and thread handles are pushed on arena, the caller scopes them to the generation
+static void evaluate(Arena *arena, TuneCheckpoint *cp, u32 threads, f32 *fitness)
+{
+    TuneJobs jobs = {
+        .candidates = cp->candidates,
+        .population = cp->population,
+        .games = cp->games,
+        .max_moves = cp->max_moves,
+        .seed = cp->seed,
+        .scores = (u64 *)Arena_PushZero(arena, (usize)cp->population * cp->games * sizeof(u64), 64)};
+    atomic_init(&jobs.next_job, 0);
+
+    pthread_t *workers = (pthread_t *)Arena_Push(arena, threads * sizeof(pthread_t), 64);
+    for (u32 t = 0; t < threads; t++) pthread_create(&workers[t], NULL, worker_run, &jobs);
+    for (u32 t = 0; t < threads; t++) pthread_join(workers[t], NULL);
+
+    for (u32 c = 0; c < cp->population; c++) {
+        u64 sum = 0;
+        for (u32 g = 0; g < cp->games; g++) sum += jobs.scores[(usize)c * cp->games + g];
+        fitness[c] = (f32)((f64)sum / cp->games);
+    }
+}
+
+// A flag given on a resumed run that disagrees with the checkpoint, reported on stderr
+static bool resume_mismatch(const char *flag, bool given, u64 value, u64 saved, const char *path)
+{
+    if (!given || value == saved) return false;
+    fprintf(stderr, "tune: %s %llu, but %s was started with %llu\n", flag, (unsigned long long)value, path,
+            (unsigned long long)saved);
+    return true;
+}
+
+static u32 tournament(const f32 *fitness, u32 population, u64 *rng)
+{
+    u32 best = (u32)(xorshift(rng) % population);
+    for (u32 k = 1; k < TUNE_TOURNAMENT; k++) {
+        u32 c = (u32)(xorshift(rng) % population);
+        if (fitness[c] > fitness[best]) best = c;
+    }
+    return best;
+}
+
+// Elites carry over untouched, everyone else is a uniform crossover of two tournament
+// winners plus gaussian mutation
+static void next_generation(TuneCheckpoint *cp, const f32 *fitness)
+{
+    u32 order[TUNE_MAX_POPULATION];
+    for (u32 i = 0; i < cp->population; i++) order[i] = i;
+    for (u32 i = 1; i < cp->population; i++) {
+        u32 k = order[i];
+        u32 j = i;
+        for (; j > 0 && fitness[order[j - 1]] < fitness[k]; j--) order[j] = order[j - 1];
+        order[j] = k;
+    }
+
+    EvalWeights next[TUNE_MAX_POPULATION];
+    u32 elite = cp->population < TUNE_ELITE ? cp->population : TUNE_ELITE;
+    for (u32 i = 0; i < elite; i++) next[i] = cp->candidates[order[i]];
+
+    for (u32 i = elite; i < cp->population; i++) {
+        const EvalWeights *a = &cp->candidates[tournament(fitness, cp->population, &cp->rng)];
+        const EvalWeights *b = &cp->candidates[tournament(fitness, cp->population, &cp->rng)];
+
+        EvalWeights child = { 0 };
+        for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) {
+            child.w[f] = (xorshift(&cp->rng) & 1) ? a->w[f] : b->w[f];
+            child.w[f] += cp->sigma * gaussian(&cp->rng);
+        }
+        normalize(&child);
+        next[i] = child;
+    }
+
+    memcpy(cp->candidates, next, cp->population * sizeof(EvalWeights));
+    cp->sigma = fmaxf(cp->sigma * 0.95f, 0.01f);
+    cp->generation++;
+}
+
+static bool checkpoint_save(const char *path, const TuneCheckpoint *cp)
+{
+    // Write aside and rename, a crash mid write never leaves a torn checkpoint
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+    usize items = fwrite(cp, sizeof(TuneCheckpoint), 1, f);
+    if (fclose(f) != 0 || items != 1) return false;
+
+    return rename(tmp, path) == 0;
+}
+
+static bool checkpoint_load(const char *path, TuneCheckpoint *cp)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    usize items = fread(cp, sizeof(TuneCheckpoint), 1, f);
+    fclose(f);
+
+    return items == 1 && cp->magic == TUNE_MAGIC && cp->version == TUNE_VERSION &&
+           cp->population >= 2 && cp->population <= TUNE_MAX_POPULATION && cp->games > 0;
+}
+
+int main(int argc, char **argv)
+{
+    u32 population = 32;
+    u32 games = 256;
+    u32 generations = 50;
+    u32 threads = (u32)sysconf(_SC_NPROCESSORS_ONLN);
+    u32 max_moves = 2000;
+    u64 seed = 0xB664;
+    const char *init_path = NULL;
+    const char *checkpoint_path = "tune.ckpt";
+    const char *out_path = "weights.txt";
+    bool fresh = false;
+    bool population_set = false, games_set = false, max_moves_set = false, seed_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--population") == 0 && i + 1 < argc) {
+            population = (u32)strtoul(argv[++i], NULL, 10);
+            population_set = true;
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = (u32)strtoul(argv[++i], NULL, 10);
+            games_set = true;
+        } else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) generations = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = (u32)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--max-moves") == 0 && i + 1 < argc) {
+            max_moves = (u32)strtoul(argv[++i], NULL, 10);
+            max_moves_set = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+            seed_set = true;
+        } else if (strcmp(argv[i], "--init") == 0 && i + 1 < argc) init_path = argv[++i];
+        else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) checkpoint_path = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--fresh") == 0) fresh = true;
+        else {
+            fprintf(stderr, "usage: %s [--population P] [--games G] [--generations N] [--threads T] [--max-moves M]\n"
+                            "          [--seed S] [--init FILE] [--checkpoint FILE] [--out FILE] [--fresh]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (population < 2) population = 2;
+    if (population > TUNE_MAX_POPULATION) population = TUNE_MAX_POPULATION;
+    if (games == 0) games = 1;
+    if (threads == 0) threads = 1;
+
+    Arena arena = GameArena_Allocation(ARENA_SIZE);
+    TuneCheckpoint *cp = (TuneCheckpoint *)Arena_PushZero(&arena, sizeof(TuneCheckpoint), 64);
+
+    if (!fresh && checkpoint_load(checkpoint_path, cp)) {
+        // The checkpoint fixes what fitness means, flags given again must agree with it
+        bool mismatch = resume_mismatch("--population", population_set, population, cp->population, checkpoint_path);
+        mismatch |= resume_mismatch("--games", games_set, games, cp->games, checkpoint_path);
+        mismatch |= resume_mismatch("--max-moves", max_moves_set, max_moves, cp->max_moves, checkpoint_path);
+        mismatch |= resume_mismatch("--seed", seed_set, seed, cp->seed, checkpoint_path);
+        if (init_path) {
+            fprintf(stderr, "tune: --init %s only seeds a fresh run, %s already has a population\n", init_path, checkpoint_path);
+            mismatch = true;
+        }
+        if (mismatch) {
+            fprintf(stderr, "tune: drop those flags to resume, or pass --fresh to start over\n");
+            Arena_Release(&arena);
+            return 1;
+        }
+        printf("tune: resuming %s at generation %u (best %.1f)\n", checkpoint_path, cp->generation, cp->best_fitness);
+    } else {
+        EvalWeights start = EVAL_DEFAULT_WEIGHTS;
+        if (init_path && !EvalWeights_Load(init_path, &start)) {
+            fprintf(stderr, "tune: cannot read %s or it names no evaluation feature\n", init_path);
+            Arena_Release(&arena);
+            return 1;
+        }
+        if (!normalize(&start)) {
+            fprintf(stderr, "tune: %s sets every weight to zero, there is no direction to start from\n", init_path);
+            Arena_Release(&arena);
+            return 1;
+        }
+
+        *cp = (TuneCheckpoint){
+            .magic = TUNE_MAGIC,
+            .version = TUNE_VERSION,
+            .population = population,
+            .games = games,
+            .max_moves = max_moves,
+            .seed = seed,
+            .rng = seed ^ 0xA5A5A5A5A5A5A5A5ull,
+            .sigma = 0.25f,
+            .best_fitness = -1.0f,
+            .best = start};
+
+        // Candidate 0 is the starting point itself, the rest scatter around it
+        cp->candidates[0] = start;
+        for (u32 i = 1; i < population; i++) {
+            EvalWeights w = start;
+            for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) w.w[f] += 2.0f * cp->sigma * gaussian(&cp->rng);
+            normalize(&w);
+            cp->candidates[i] = w;
+        }
+    }
+
+    printf("tune: population %u, %u games per candidate, %u threads\n", cp->population, cp->games, threads);
+
+    f32 fitness[TUNE_MAX_POPULATION];
+    while (cp->generation < generations) {
+        f64 start = now_seconds();
+        ARENA_SCOPE(&arena) evaluate(&arena, cp, threads, fitness);
+
+        u32 best = 0;
+        f64 mean = 0;
+        for (u32 c = 0; c < cp->population; c++) {
+            mean += fitness[c];
+            if (fitness[c] > fitness[best]) best = c;
+        }
+        mean /= cp->population;
+
+        if (fitness[best] > cp->best_fitness) {
+            cp->best_fitness = fitness[best];
+            cp->best = cp->candidates[best];
+            if (!EvalWeights_Save(out_path, &cp->best)) fprintf(stderr, "tune: cannot write %s\n", out_path);
+        }
+
+        printf("gen %3u  best %8.1f  mean %8.1f  all time %8.1f  sigma %.3f  %.1fs\n",
+               cp->generation, fitness[best], mean, cp->best_fitness, cp->sigma, now_seconds() - start);
+        fflush(stdout);
+
+        next_generation(cp, fitness);
+        if (!checkpoint_save(checkpoint_path, cp)) fprintf(stderr, "tune: cannot write %s\n", checkpoint_path);
+    }
+
+    printf("tune: best %.1f, weights in %s\n", cp->best_fitness, out_path);
+    for (u32 f = 0; f < EVAL_FEATURE_COUNT; f++) printf("  %-10s %9.5f\n", EVAL_FEATURE_NAMES[f], cp->best.w[f]);
+
+    Arena_Release(&arena);
+    return 0;
+}